@@ -6,6 +6,7 @@
 export const state = {
   connected: false,
   chartsOn: false,
+  cpuOn: false,
   carGroupMode: false,
   mode: "solo",
   formation: {
@@ -18,6 +19,7 @@ export const state = {
   isPageVisible: true,
   joystick: { x: 0, y: 0, a: 0, isDragging: false, lastSendTime: 0 },
   pidParams: {},
+  plot: null, // 用户选择的曲线 [[key...] x 3]，null 表示固件默认
   attitudeZero: { roll: 0, yaw: 0 },
   rgb: { mode: 0, count: 5, max: 12 },
   charts: {
@@ -56,6 +58,8 @@ export const domElements = {
   carGroupSwitch: getElement("carGroupSwitch"),
   chartSwitch: getElement("chartSwitch"),
   fallDetectSwitch: getElement("fallDetectSwitch"),
+  fallRecoverSwitch: getElement("fallRecoverSwitch"),
+  yawHoldSwitch: getElement("yawHoldSwitch"),
   statusLabel: getElement("status"),
 
   // Indicators
@@ -66,18 +70,22 @@ export const domElements = {
   chart1: {
     canvas: getElement("chart1"),
     title: getElement("chartTitle1"),
+    pick: getElement("chartPick1"),
   },
   chart2: {
     canvas: getElement("chart2"),
     title: getElement("chartTitle2"),
+    pick: getElement("chartPick2"),
   },
   chart3: {
     canvas: getElement("chart3"),
     title: getElement("chartTitle3"),
+    pick: getElement("chartPick3"),
   },
 
   // PID Controls
   pidCard: getElement("pidCard"),
+  pidGrid: getElement("pidGrid"),
   btnPidSend: getElement("btnPidSend"),
   btnPidPull: getElement("btnPidPull"),
 
@@ -93,6 +101,12 @@ export const domElements = {
   // Log
   log: getElement("log"),
 
+  // CPU
+  cpuSwitch: getElement("cpuSwitch"),
+  cpuCores: getElement("cpuCores"),
+  cpuTasks: getElement("cpuTasks"),
+  cpuHead: [getElement("cpuHead0"), getElement("cpuHead1"), getElement("cpuHead2")],
+
   // RGB
   rgbCard: getElement("rgbCard"),
   rgbModeList: getElement("rgbModeList"),
@@ -128,12 +142,7 @@ export const domElements = {
  * 全局常量
  */
 export const CONSTANTS = {
-  MAX_CHART_POINTS: 300,
+  MAX_CHART_POINTS: 600, // 曲线流按控制环样本推送，每秒可达数百点
   JOYSTICK_SEND_INTERVAL: 50, // ms, 20Hz
 };
 
-// PID 参数键名列表
-export const PID_KEYS = Array.from({ length: 12 }, (_, i) => {
-    const key = `key${String(i + 1).padStart(2, "0")}`;
-    return { k: key, fix: 3 };
-});
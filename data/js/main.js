@@ -2,7 +2,7 @@
 import { state, domElements } from "./config.js";
 import { initUI, updateFallIndicator, logLine } from "./ui.js";
 import { initCharts, feedChartsData, applyChartConfig } from "./modules/charts.js";
-import { init3D, setAttitude } from "./modules/robot3D.js";
+import { init3D, setAttitude, setPose } from "./modules/robot3D.js";
 import { initPID, fillPidToUI, applySliderConfig } from "./modules/pid.js";
 import { initJoystick } from "./modules/joystick.js";
 import {
@@ -11,7 +11,9 @@ import {
   updateRgbState,
 } from "./modules/rgb.js";
 import { initFormation, handleGroupState } from "./modules/group.js";
+import { initCpu, updateCpu } from "./modules/cpu.js";
 import { connectWebSocket, syncInitialState } from "./services/websocket.js";
+import { decodeFrame } from "./services/telem_codec.js";
 
 /**
  * 主初始化函数
@@ -25,6 +27,7 @@ async function main() {
   initPID();
   initRgbControls();
   initFormation();
+  initCpu();
   initJoystick();
   init3D();
 
@@ -41,14 +44,15 @@ async function main() {
       if (typeof msg.pitch !== 'undefined') {
         setAttitude(msg.pitch, msg.roll, msg.yaw);
       }
+      // 里程计位姿与轨迹
+      if (msg.odom) {
+        setPose(msg.odom.x, msg.odom.y);
+      }
       
-      // 图表和指示灯更新 (仅在图表开启时)
+      // 指示灯更新 (仅在图表开启时)
       if (state.chartsOn) {
-        if (Array.isArray(msg.d) && msg.d.length >= 9) {
-          feedChartsData(...msg.d);
-        }
         if (typeof msg.fallen !== 'undefined') {
-          updateFallIndicator(msg.fallen);
+          updateFallIndicator(msg.fallen, msg.sup?.phase);
         }
       }
     },
@@ -62,6 +66,12 @@ async function main() {
     },
     onRgbState: (msg) => updateRgbState(msg, true),
     onGroupState: (msg) => handleGroupState(msg),
+    onDiag: (diag) => updateCpu(diag),
+    onStream: (buf) => {
+      // 解码始终进行，保持差分参考连续
+      const frame = decodeFrame(buf);
+      if (frame && state.chartsOn && frame.rows.length) feedChartsData(frame.rows, frame.split);
+    },
   });
 
   logLine('ready');
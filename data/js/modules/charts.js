@@ -1,6 +1,12 @@
 // /assets/js/modules/charts.js
 import { state, domElements, CONSTANTS } from '../config.js';
 import { appendLog } from '../ui.js';
+import { sendWebSocketMessage } from '../services/websocket.js';
+import { setFieldRes } from '../services/telem_codec.js';
+
+// 每张图的曲线数，来自 ui_config.charts[].keys；曲线流的值按此顺序拼接
+let chartSizes = [3, 3, 3];
+let currentKeys = [[], [], []];
 
 /**
  * 创建一个图表实例
@@ -17,13 +23,7 @@ function createChart(canvas, labels) {
     type: 'line',
     data: {
       labels: Array.from({ length: CONSTANTS.MAX_CHART_POINTS }, (_, i) => i),
-      datasets: labels.map(label => ({
-        label,
-        data: Array(CONSTANTS.MAX_CHART_POINTS).fill(0),
-        borderWidth: 1.5,
-        tension: 0.2,
-        pointRadius: 0,
-      }))
+      datasets: labels.map(makeDataset)
     },
     options: {
       animation: false,
@@ -57,6 +57,57 @@ function createChart(canvas, labels) {
   });
 }
 
+function makeDataset(label) {
+  return {
+    label,
+    data: Array(CONSTANTS.MAX_CHART_POINTS).fill(0),
+    borderWidth: 1.5,
+    tension: 0.2,
+    pointRadius: 0,
+  };
+}
+
+const chartDom = () => [domElements.chart1, domElements.chart2, domElements.chart3];
+
+// 可选曲线：/api/schema 中的非参数字段，按分组
+let plotGroups = [];
+
+function fillPickers() {
+  chartDom().forEach((dom, i) => {
+    const sel = dom.pick;
+    if (!sel) return;
+    sel.innerHTML = '';
+    plotGroups.forEach((g) => sel.add(new Option(g.group, g.group)));
+    sel.value = dom.title?.textContent || '';
+    sel.onchange = () => {
+      // 其余图保持当前显示的曲线
+      const plot = currentKeys.map((k) => [...k]);
+      plot[i] = plotGroups.find((g) => g.group === sel.value)?.keys ?? [];
+      state.plot = plot;
+      sendWebSocketMessage({ type: 'plot', charts: plot });
+    };
+  });
+}
+
+async function loadSchema() {
+  try {
+    const res = await fetch('/api/schema');
+    if (!res.ok) throw new Error(`HTTP ${res.status}`);
+    const schema = await res.json();
+    setFieldRes((schema.fields || []).map((f) => f.res));
+    const groups = new Map();
+    (schema.fields || []).forEach((f) => {
+      if (f.param) return;
+      if (!groups.has(f.group)) groups.set(f.group, []);
+      groups.get(f.group).push(f.key);
+    });
+    plotGroups = [...groups].map(([group, keys]) => ({ group, keys }));
+    fillPickers();
+  } catch (e) {
+    appendLog(`[INIT] /api/schema fail: ${e.message}`);
+  }
+}
+
 /**
  * 初始化所有图表
  */
@@ -64,6 +115,7 @@ export function initCharts() {
   state.charts.chart1 = createChart(domElements.chart1.canvas, ['a', 'b', 'c']);
   state.charts.chart2 = createChart(domElements.chart2.canvas, ['d', 'e', 'f']);
   state.charts.chart3 = createChart(domElements.chart3.canvas, ['g', 'h', 'i']);
+  loadSchema();
   appendLog('[INIT] charts ready');
 }
 
@@ -80,15 +132,24 @@ export function applyChartConfig(config) {
     { chart: state.charts.chart3, titleEl: domElements.chart3.title },
   ];
 
+  currentKeys = chartRefs.map((_, i) => (Array.isArray(config[i]?.keys) ? config[i].keys : []));
+  chartSizes = currentKeys.map((k) => k.length);
+
   config.forEach((c, i) => {
+    if (!chartRefs[i]) return;
     const { chart, titleEl } = chartRefs[i];
     if (titleEl && c.title) titleEl.textContent = c.title;
 
+    const pick = chartDom()[i].pick;
+    if (pick && c.title) pick.value = c.title;
+
     if (chart && Array.isArray(c.legends)) {
+      // 曲线数随选择变化：多删少补
+      const ds = chart.data.datasets;
+      ds.length = Math.min(ds.length, c.legends.length);
       c.legends.forEach((name, j) => {
-        if (chart.data.datasets[j]) {
-          chart.data.datasets[j].label = name;
-        }
+        if (ds[j]) ds[j].label = name;
+        else ds.push(makeDataset(name));
       });
       chart.update('none');
     }
@@ -96,30 +157,35 @@ export function applyChartConfig(config) {
 }
 
 /**
- * 向图表推送一组新数据
+ * 向图表推送若干组新数据，全部推入后只重绘一次
  * @param {Chart} chart 
- * @param {number[]} dataPoints 
+ * @param {number[][]} rows 
  */
-function pushDataToChart(chart, dataPoints) {
+function pushDataToChart(chart, rows) {
   if (!chart) return;
   const datasets = chart.data.datasets;
-  dataPoints.forEach((value, i) => {
-    if (datasets[i]) {
-      datasets[i].data.push(value);
-      if (datasets[i].data.length > CONSTANTS.MAX_CHART_POINTS) {
-        datasets[i].data.shift();
-      }
-    }
+  rows.forEach((dataPoints) => {
+    dataPoints.forEach((value, i) => {
+      if (datasets[i]) datasets[i].data.push(value);
+    });
+  });
+  datasets.forEach((ds) => {
+    const extra = ds.data.length - CONSTANTS.MAX_CHART_POINTS;
+    if (extra > 0) ds.data.splice(0, extra);
   });
   chart.update('none');
 }
 
 /**
  * 将遥测数据馈送到所有图表
- * @param  {...number} data - 9个数据点
+ * @param {number[][]} rows - 每行为一个样本，各图曲线按 ui_config.charts 的顺序拼接
+ * @param {number[]} [sizes] - 各图曲线数（曲线流关键帧携带），缺省用最近一次配置
  */
-export function feedChartsData(...data) {
-  pushDataToChart(state.charts.chart1, data.slice(0, 3));
-  pushDataToChart(state.charts.chart2, data.slice(3, 6));
-  pushDataToChart(state.charts.chart3, data.slice(6, 9));
-}
\ No newline at end of file
+export function feedChartsData(rows, sizes = chartSizes) {
+  const charts = [state.charts.chart1, state.charts.chart2, state.charts.chart3];
+  let at = 0;
+  charts.forEach((chart, i) => {
+    pushDataToChart(chart, rows.map((r) => r.slice(at, at + sizes[i])));
+    at += sizes[i];
+  });
+}
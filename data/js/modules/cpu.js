@@ -0,0 +1,70 @@
+import { state, domElements } from "../config.js";
+import { sendSubscription } from "../services/websocket.js";
+
+// 千分比 -> "12.3%"
+function pct(v) {
+  return `${((v ?? 0) / 10).toFixed(1)}%`;
+}
+
+function bar(v) {
+  const w = Math.min(100, Math.max(0, (v ?? 0) / 10));
+  return `<div class="cpu-bar"><span style="width:${w}%"></span><em>${pct(v)}</em></div>`;
+}
+
+function renderCores(diag) {
+  const wrap = domElements.cpuCores;
+  if (!wrap) return;
+  if (!diag.runtime || !Array.isArray(diag.cores)) {
+    wrap.textContent = "固件未开启运行时间统计";
+    return;
+  }
+  wrap.innerHTML = diag.cores
+    .map((w, i) => `<div class="cpu-core"><span>Core ${i}</span>${w.map(bar).join("")}</div>`)
+    .join("");
+}
+
+function renderTasks(diag) {
+  const body = domElements.cpuTasks;
+  if (!body) return;
+  const tasks = [...(diag.tasks || [])];
+  // 按最短窗口占用从高到低
+  tasks.sort((a, b) => (b.cpu?.[0] ?? 0) - (a.cpu?.[0] ?? 0));
+  body.innerHTML = tasks
+    .map((t) => {
+      const cpu = [0, 1, 2].map((i) => `<td>${t.cpu ? pct(t.cpu[i]) : "-"}</td>`).join("");
+      const core = t.c < 0 ? "-" : t.c;
+      return `<tr><td>${t.n}</td><td>${core}</td><td>${t.p}</td>${cpu}<td>${t.st}</td></tr>`;
+    })
+    .join("");
+}
+
+/**
+ * 收到 diag 推送时刷新面板
+ * @param {object} diag
+ */
+export function updateCpu(diag) {
+  if (!state.cpuOn || !diag) return;
+  if (Array.isArray(diag.win_s)) {
+    diag.win_s.forEach((s, i) => {
+      const th = domElements.cpuHead[i];
+      if (th) th.textContent = `${s}s`;
+    });
+  }
+  renderCores(diag);
+  renderTasks(diag);
+}
+
+export function initCpu() {
+  const sw = domElements.cpuSwitch;
+  if (!sw) return;
+  sw.checked = state.cpuOn;
+  sw.addEventListener("change", () => {
+    state.cpuOn = sw.checked;
+    if (!state.cpuOn) {
+      if (domElements.cpuCores) domElements.cpuCores.innerHTML = "";
+      if (domElements.cpuTasks) domElements.cpuTasks.innerHTML = "";
+    }
+    // 只在面板打开时订阅 diag 通道
+    sendSubscription();
+  });
+}
@@ -1,17 +1,24 @@
 // /assets/js/modules/pid.js
-import { state, domElements, PID_KEYS } from "../config.js";
+import { state, domElements } from "../config.js";
 import { sendWebSocketMessage } from "../services/websocket.js";
 
+// 参数键来自 ui_config.sliders[].keys（固件字段表），在收到配置前为空
+let pidKeys = [];
+const PID_FIX = 3;
+
+// 键里含 "."，元素 id 中替换掉
+const keyId = (k) => k.replace(/[^A-Za-z0-9_-]/g, "_");
+
 // Helper to query PID related elements by key
 const getPidElements = (k) => ({
-  sv: document.getElementById(`sv_${k}`),
-  nv: document.getElementById(`nv_${k}`),
-  rg: document.getElementById(`rg_${k}`),
+  sv: document.getElementById(`sv_${keyId(k)}`),
+  nv: document.getElementById(`nv_${keyId(k)}`),
+  rg: document.getElementById(`rg_${keyId(k)}`),
 });
 
 /**
  * Binds events for a single PID key (slider and number input)
- * @param {object} keyInfo - { k: 'key01', fix: 3 }
+ * @param {object} keyInfo - { k: 'ang_pid.p', fix: 3 }
  */
 function bindPidKey(keyInfo) {
   const { k, fix } = keyInfo;
@@ -83,10 +90,9 @@ function bindPidKey(keyInfo) {
  * Initializes all PID control interactions.
  */
 export function initPID() {
-  PID_KEYS.forEach(bindPidKey);
   domElements.btnPidSend.onclick = () => {
     const param = {};
-    PID_KEYS.forEach(({ k }) => {
+    pidKeys.forEach(({ k }) => {
       const v = state.pidParams[k];
       const num = Number.isFinite(v) ? v : 0;
       param[k] = num;
@@ -103,7 +109,7 @@ export function initPID() {
  */
 export function fillPidToUI(params) {
   Object.keys(params).forEach((k) => {
-    const keyInfo = PID_KEYS.find((item) => item.k === k);
+    const keyInfo = pidKeys.find((item) => item.k === k);
     if (!keyInfo) return; // Ignore unknown keys
 
     const v = +params[k];
@@ -119,24 +125,41 @@ export function fillPidToUI(params) {
   });
 }
 
+function sliderItem(k, name) {
+  const id = keyId(k);
+  const item = document.createElement("div");
+  item.className = "slider-item";
+  item.innerHTML =
+    `<div class="slider-head"><span>${name}</span><span class="nbox"><span id="sv_${id}">0.000</span>` +
+    `<input type="number" id="nv_${id}" step="0.001" value="0.000"></span></div>` +
+    `<input id="rg_${id}" type="range" step="0.001" value="0">`;
+  return item;
+}
+
 /**
- * 应用 slider group names 和 labels from a configuration object.
- * @param {Array<object>} config
+ * 按 ui_config.sliders 生成参数滑块
+ * @param {Array<{group: string, names: string[], keys: string[]}>} config
  */
 export function applySliderConfig(config) {
-  if (!Array.isArray(config)) return;
-  config.forEach((groupConfig, groupIndex) => {
-    // 增加对 pidGroup5 的支持
-    const titleEl = document.querySelector(`#pidGroup${groupIndex + 1}`);
-    if (titleEl && groupConfig.group) titleEl.textContent = groupConfig.group;
-
-    if (Array.isArray(groupConfig.names)) {
-      groupConfig.names.forEach((name, sliderIndex) => {
-        const labelEl = document.querySelector(
-          `#pid${groupIndex + 1}Label${sliderIndex + 1}`
-        );
-        if (labelEl) labelEl.textContent = name;
-      });
-    }
+  if (!Array.isArray(config) || !domElements.pidGrid) return;
+  const keys = config.flatMap((g) => (Array.isArray(g.keys) ? g.keys : []));
+  // 重连时字段表未变则保留当前输入
+  if (keys.join(",") === pidKeys.map(({ k }) => k).join(",")) return;
+
+  const grid = domElements.pidGrid;
+  grid.innerHTML = "";
+  state.pidParams = {};
+  pidKeys = keys.map((k) => ({ k, fix: PID_FIX }));
+
+  config.forEach((groupConfig) => {
+    const row = document.createElement("div");
+    row.className = "pid-row";
+    const title = document.createElement("div");
+    title.className = "pid-group-title";
+    title.textContent = groupConfig.group || "";
+    row.appendChild(title);
+    (groupConfig.keys || []).forEach((k, i) => row.appendChild(sliderItem(k, groupConfig.names?.[i] ?? k)));
+    grid.appendChild(row);
   });
+  pidKeys.forEach(bindPidKey);
 }
@@ -3,6 +3,12 @@ import { state } from '../config.js';
 import { domElements } from '../config.js';
 import { appendLog } from '../ui.js';
 
+// 里程计轨迹：真实米数放大到场景单位（车体约 1 个单位宽）
+const POSE_SCALE = 5;
+const TRAIL_MAX_POINTS = 600;
+const TRAIL_MIN_STEP = 0.02;  // 场景单位，移动小于该值不追加轨迹点
+const TRAIL_RESET_JUMP = 2.5; // 场景单位，位姿突变（如里程计清零）时清空轨迹
+
 // --- Private Helper Functions ---
 const createMaterial = (hex, metalness = 0.1, roughness = 0.6) => new THREE.MeshStandardMaterial({ color: hex, metalness, roughness });
 const createBox = (w, h, d, material) => new THREE.Mesh(new THREE.BoxGeometry(w, h, d), material);
@@ -97,6 +103,15 @@ export function init3D() {
   wheelR.position.set(0.42, 0.16, 0);
   robot.add(wheelR);
 
+  // Odometry trail
+  const trailGeom = new THREE.BufferGeometry();
+  trailGeom.setAttribute('position', new THREE.BufferAttribute(new Float32Array(TRAIL_MAX_POINTS * 3), 3));
+  trailGeom.setDrawRange(0, 0);
+  const trail = new THREE.Line(trailGeom, new THREE.LineBasicMaterial({ color: 0x2f80ed }));
+  trail.frustumCulled = false;
+  trail.position.y = 0.01;
+  scene.add(trail);
+
   // Orbit Controls Logic
   const orbit = { target: new THREE.Vector3(0, 0.7, 0), r: 5.0, theta: 0.8, phi: 1.0, minR: 2, maxR: 10 };
   
@@ -156,7 +171,7 @@ export function init3D() {
 
 
   // Store references in state
-  state.three = { scene, camera, renderer, robot, pcb };
+  state.three = { scene, camera, renderer, robot, pcb, trail, trailCount: 0, orbit, applyOrbit };
   
   setAttitude(0, 0, 0);
   renderer.setAnimationLoop(() => renderer.render(scene, camera));
@@ -182,4 +197,49 @@ export function setAttitude(pitchDeg, rollDeg, yawDeg) {
   t.robot.rotation.y = yawAdj * toRad;
 
   domElements.attOut.textContent = `pitch: ${pitchDeg.toFixed(1)}°  roll: ${rollAdj.toFixed(1)}°  yaw: ${yawAdj.toFixed(1)}°`;
-}
\ No newline at end of file
+}
+
+function clearTrail(t) {
+  t.trailCount = 0;
+  t.trail.geometry.setDrawRange(0, 0);
+}
+
+/**
+ * 更新里程计位置并追加轨迹（机器人坐标 x 前 y 左，映射到场景 x / -z）
+ * 朝向仍由 setAttitude 的 yaw 驱动
+ * @param {number} x 米
+ * @param {number} y 米
+ */
+export function setPose(x, y) {
+  const t = state.three;
+  if (!t.robot || !t.trail) return;
+
+  const px = x * POSE_SCALE;
+  const pz = -y * POSE_SCALE;
+  const last = t.robot.position;
+  if (Math.hypot(px - last.x, pz - last.z) > TRAIL_RESET_JUMP) clearTrail(t);
+
+  // 摄像机跟随机器人平移
+  t.orbit.target.x += px - last.x;
+  t.orbit.target.z += pz - last.z;
+  t.robot.position.set(px, 0, pz);
+  t.applyOrbit();
+
+  const attr = t.trail.geometry.getAttribute('position');
+  const arr = attr.array;
+  if (t.trailCount > 0) {
+    const i = (t.trailCount - 1) * 3;
+    if (Math.hypot(px - arr[i], pz - arr[i + 2]) < TRAIL_MIN_STEP) return;
+  }
+  if (t.trailCount >= TRAIL_MAX_POINTS) {
+    arr.copyWithin(0, 3);
+    t.trailCount = TRAIL_MAX_POINTS - 1;
+  }
+  const j = t.trailCount * 3;
+  arr[j] = px;
+  arr[j + 1] = 0;
+  arr[j + 2] = pz;
+  t.trailCount += 1;
+  attr.needsUpdate = true;
+  t.trail.geometry.setDrawRange(0, t.trailCount);
+}
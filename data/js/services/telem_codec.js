@@ -0,0 +1,76 @@
+// /assets/js/services/telem_codec.js
+// 曲线二进制流解码，帧格式见固件 include/my_telem_codec.h
+
+const FRAME_KEY = 1;
+const FRAME_DELTA = 2;
+const CHARTS = 3;
+const HEAD = 5; // type | seq | n | k | step_ms
+
+let fieldRes = []; // 字段表下标 -> 量化分辨率，来自 /api/schema
+let ref = null;    // 上一帧：{ seq, split, fields, q }
+
+/**
+ * 设置各字段分辨率（/api/schema 的 fields 顺序即字段表下标）
+ * @param {number[]} res
+ */
+export function setFieldRes(res) {
+  fieldRes = res;
+  ref = null;
+}
+
+// 变长整数 + zig-zag；值可达 32 位，用乘法避免 JS 位运算的符号问题
+function readVarint(bytes, pos) {
+  let z = 0;
+  let scale = 1;
+  for (;;) {
+    if (pos.at >= bytes.length) throw new RangeError("truncated frame");
+    const b = bytes[pos.at++];
+    z += (b & 0x7f) * scale;
+    if (b < 0x80) break;
+    scale *= 128;
+  }
+  return z % 2 ? -(z + 1) / 2 : z / 2;
+}
+
+/**
+ * 解码一帧；差分帧序号不连续或尚无参考时返回 null，等待下一个关键帧
+ * @param {ArrayBuffer} buf
+ * @returns {{ split: number[], stepMs: number, rows: number[][] } | null}
+ */
+export function decodeFrame(buf) {
+  const bytes = new Uint8Array(buf);
+  if (bytes.length < HEAD || !fieldRes.length) return null;
+  const type = bytes[0];
+  const seq = bytes[1];
+  const n = bytes[2];
+  const k = bytes[3];
+  const stepMs = bytes[4];
+  const pos = { at: HEAD };
+  try {
+    if (type === FRAME_KEY) {
+      const split = Array.from(bytes.subarray(pos.at, pos.at + CHARTS));
+      pos.at += CHARTS;
+      const fields = Array.from(bytes.subarray(pos.at, pos.at + n));
+      pos.at += n;
+      ref = { seq, split, fields, q: new Array(n).fill(0) };
+    } else if (type === FRAME_DELTA) {
+      if (!ref || seq !== ((ref.seq + 1) & 0xff) || n !== ref.q.length) {
+        ref = null;
+        return null;
+      }
+      ref.seq = seq;
+    } else {
+      return null;
+    }
+    // 每个样本相对前一个样本（跨帧连续）
+    const rows = [];
+    for (let j = 0; j < k; j++) {
+      for (let i = 0; i < n; i++) ref.q[i] += readVarint(bytes, pos);
+      rows.push(ref.q.map((q, i) => q * (fieldRes[ref.fields[i]] || 1)));
+    }
+    return { split: ref.split, stepMs, rows };
+  } catch (e) {
+    ref = null;
+    return null;
+  }
+}
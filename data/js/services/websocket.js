@@ -9,6 +9,8 @@ let uiConfigCallback = null;
 let pidParamsCallback = null;
 let rgbStateCallback = null;
 let groupStateCallback = null;
+let diagCallback = null;
+let streamCallback = null;
 
 /**
  * 发送 WebSocket 消息 (JSON)
@@ -20,11 +22,27 @@ export function sendWebSocketMessage(obj) {
   }
 }
 
+/**
+ * 按当前页面需要订阅遥测通道（图表关闭时不订阅控制环曲线，CPU 面板关闭时不订阅 diag）
+ */
+export function sendSubscription() {
+  const ch = ["att", "group", "bat", "odom"];
+  if (state.chartsOn) ch.push("loops");
+  if (state.cpuOn) ch.push("diag");
+  const hz = parseInt(domElements.rateHzInput?.value || "0", 10);
+  sendWebSocketMessage({ type: "subscribe", ch, hz: hz > 0 ? hz : 0 });
+}
+
 /**
  * 处理收到的 WebSocket 消息
  * @param {MessageEvent} event
  */
 function handleMessage(event) {
+  // 二进制帧只有曲线流一种
+  if (event.data instanceof ArrayBuffer) {
+    if (streamCallback) streamCallback(event.data);
+    return;
+  }
   let msg = null;
   try {
     msg = JSON.parse(event.data);
@@ -42,6 +60,10 @@ function handleMessage(event) {
     case "ui_config":
       if (uiConfigCallback) uiConfigCallback(msg);
       break;
+    case "plot_state":
+      // 曲线选择的应答与 ui_config.charts 同格式
+      if (uiConfigCallback) uiConfigCallback({ charts: msg.charts });
+      break;
     case "pid":
       if (pidParamsCallback) pidParamsCallback(msg);
       break;
@@ -57,6 +79,19 @@ function handleMessage(event) {
       }
       if (groupStateCallback) groupStateCallback(msg.group ?? msg);
       break;
+    case "diag":
+      if (diagCallback) diagCallback(msg.diag);
+      break;
+    case "sup_state":
+      (msg.log || []).forEach((e) => appendLog(`[SUP] ${e.ms} ms ${e.from} -> ${e.to}`));
+      break;
+    case "sub_state":
+      if (msg.sub) appendLog(`[SUB] ${msg.sub.ch.join(",")} @ ${msg.sub.hz} Hz`);
+      break;
+    case "profile_state":
+      if (msg.profile)
+        appendLog(`[PROFILE] accepted ${msg.accepted ?? 0}, queued ${msg.profile.queued}, active ${msg.profile.active}`);
+      break;
     case "info":
       if (msg.text) appendLog(`[INFO] ${msg.text}`);
       break;
@@ -81,6 +116,8 @@ function reconnect() {
  * @param {function} callbacks.onUiConfig - UI配置数据回调
  * @param {function} callbacks.onPidParams - PID参数数据回调
  * @param {function} callbacks.onRgbState - RGB状态回调
+ * @param {function} callbacks.onDiag - 诊断快照回调
+ * @param {function} callbacks.onStream - 曲线二进制帧回调
  */
 export function connectWebSocket(callbacks = {}) {
   if (callbacks.onTelemetry) telemetryCallback = callbacks.onTelemetry;
@@ -88,6 +125,8 @@ export function connectWebSocket(callbacks = {}) {
   if (callbacks.onPidParams) pidParamsCallback = callbacks.onPidParams;
   if (callbacks.onRgbState) rgbStateCallback = callbacks.onRgbState;
   if (callbacks.onGroupState) groupStateCallback = callbacks.onGroupState;
+  if (callbacks.onDiag) diagCallback = callbacks.onDiag;
+  if (callbacks.onStream) streamCallback = callbacks.onStream;
 
   const protocol = location.protocol === "http:" ? "ws://" : "wss://";
   const url = `${protocol}${location.host}/ws`;
@@ -96,12 +135,16 @@ export function connectWebSocket(callbacks = {}) {
 
   try {
     ws = new WebSocket(url);
+    ws.binaryType = "arraybuffer";
 
     ws.onopen = () => {
       state.connected = true;
       setStatus("connected");
       sendWebSocketMessage({ type: "get_pid" });
       appendLog("[SEND] get_pid");
+      sendSubscription();
+      // 重连后恢复自选曲线（固件对新连接使用默认曲线）
+      if (state.plot) sendWebSocketMessage({ type: "plot", charts: state.plot });
     };
 
     ws.onclose = () => {
@@ -140,6 +183,12 @@ export async function syncInitialState() {
       state.carGroupMode = !!s.group.enabled;
       domElements.carGroupSwitch.checked = state.carGroupMode;
     }
+    if (typeof s.fallen_enable === "boolean" && domElements.fallDetectSwitch)
+      domElements.fallDetectSwitch.checked = s.fallen_enable;
+    if (typeof s.fall_recover === "boolean" && domElements.fallRecoverSwitch)
+      domElements.fallRecoverSwitch.checked = s.fall_recover;
+    if (typeof s.yaw_hold === "boolean" && domElements.yawHoldSwitch)
+      domElements.yawHoldSwitch.checked = s.yaw_hold;
     if (typeof s.chart_enable === "boolean") {
       domElements.chartSwitch.checked = !!s.chart_enable;
       state.chartsOn = !!s.chart_enable;
@@ -32,11 +32,21 @@ export function appendLog(text) {
   }
 }
 
+const PHASE_LABELS = {
+  idle: "待机",
+  arming: "起控中",
+  balancing: "稳定",
+  falling: "倾倒",
+  fallen: "已摔倒",
+  recovering: "自恢复",
+};
+
 /**
  * 更新摔倒状态指示灯
  * @param {boolean|null} fallState - null/undefined for off, true for fallen (red), false for stable (green).
+ * @param {string} [phase] - 平衡监控状态机的当前状态，存在时作为文字显示
  */
-export function updateFallIndicator(fallState) {
+export function updateFallIndicator(fallState, phase) {
   const { fallLamp, fallLabel } = domElements;
   fallLamp.classList.remove("green", "red", "off");
 
@@ -45,10 +55,10 @@ export function updateFallIndicator(fallState) {
     fallLabel.textContent = "—";
   } else if (fallState) {
     fallLamp.classList.add("red");
-    fallLabel.textContent = "已摔倒";
+    fallLabel.textContent = PHASE_LABELS[phase] ?? "已摔倒";
   } else {
     fallLamp.classList.add("green");
-    fallLabel.textContent = "稳定";
+    fallLabel.textContent = PHASE_LABELS[phase] ?? "稳定";
   }
 }
 
@@ -104,19 +114,46 @@ function bindToolbarEvents() {
     }
   };
 
-  domElements.fallDetectSwitch.onchange = () => {
+  const sendFallCheck = () => {
     sendWebSocketMessage({
       type: "fall_check",
       enable: domElements.fallDetectSwitch.checked,
+      recover: !!domElements.fallRecoverSwitch?.checked,
     });
+  };
+
+  domElements.fallDetectSwitch.onchange = () => {
+    sendFallCheck();
     appendLog(
       `[SEND] fall_check ${domElements.fallDetectSwitch.checked ? "on" : "off"}`
     );
   };
 
+  if (domElements.fallRecoverSwitch) {
+    domElements.fallRecoverSwitch.onchange = () => {
+      sendFallCheck();
+      appendLog(
+        `[SEND] fall_recover ${domElements.fallRecoverSwitch.checked ? "on" : "off"}`
+      );
+    };
+  }
+
+  if (domElements.yawHoldSwitch) {
+    domElements.yawHoldSwitch.onchange = () => {
+      sendWebSocketMessage({
+        type: "yaw_hold",
+        enable: domElements.yawHoldSwitch.checked,
+      });
+      appendLog(
+        `[SEND] yaw_hold ${domElements.yawHoldSwitch.checked ? "on" : "off"}`
+      );
+    };
+  }
+
   domElements.btnZeroAtt.onclick = () => {
     sendWebSocketMessage({ type: "imu_restart" });
-    appendLog("[INFO] attitude zeroed (roll/yaw)");
+    sendWebSocketMessage({ type: "odom_reset" });
+    appendLog("[INFO] attitude zeroed (roll/yaw), odometry reset");
   };
 }
 
@@ -1,7 +1,29 @@
 #pragma once
 #include <Wire.h>
+#include <ArduinoJson.h>
 
 extern TwoWire Wire; 
 extern TwoWire ScreenWire;
 
+#define I2C_BUS_COUNT 2
+#define I2C_HIST_BINS 8
+
+// 单条总线的事务统计
+struct i2c_bus_stats
+{
+    uint32_t ok;                    // 成功事务数
+    uint32_t err;                   // 失败事务数
+    uint32_t recoveries;            // 总线恢复次数
+    uint32_t last_us;               // 最近一次事务耗时
+    uint32_t max_us;                // 最长事务耗时
+    uint32_t hist[I2C_HIST_BINS];   // 耗时直方图，上界见 I2C_HIST_EDGES_US
+};
+
+extern const uint32_t I2C_HIST_EDGES_US[I2C_HIST_BINS - 1];
+
 extern void my_i2c_init();
+void my_i2c_record(uint8_t bus, uint32_t us, bool ok); // 记录一次事务（0: IMU, 1: 屏幕）
+bool my_i2c_recover(uint8_t bus);                      // 手动打 SCL 脉冲释放被从机拉住的 SDA，再重新初始化
+void my_i2c_recover_async(uint8_t bus);                // IMU/屏幕读写方调用：交给恢复任务执行，不在调用方阻塞
+bool my_i2c_recovering(uint8_t bus);                   // 恢复请求未完成；期间调用方不得访问该总线
+void i2c_write_stats(JsonObject obj);
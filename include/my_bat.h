@@ -1,5 +1,8 @@
 #pragma once
+#include <ArduinoJson.h>
 
 extern float battery_voltage;
 extern void my_bat_update();
-extern void my_bat_init();
\ No newline at end of file
+extern void my_bat_init();
+float bat_soc_from_cell(float cell_v); // 单节开路电压 -> 剩余电量 0~1
+void bat_write_state(JsonObject obj);
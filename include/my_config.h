@@ -6,10 +6,21 @@
 #define I2C0_SDA 42
 #define I2C0_SCL 41
 #define I2C_FREQUENCY 400000
+#define I2C_IMU_TIMEOUT_MS 2        // IMU 总线事务超时，小于控制周期的量级
+#define I2C_SCREEN_TIMEOUT_MS 20    // 屏幕总线事务超时
+#define I2C_SCL_TIMEOUT_EXP 17      // SCL 保持超时：2^17 个 APB 周期 ≈ 1.6ms（S3 寄存器为指数形式）
+#define IMU_PREDICT_MAX 5           // IMU 读取失败后用陀螺仪外推的最大周期数
+#define IMU_RECOVER_FAILS 3         // 连续失败该次数后执行总线恢复
+#define I2C_RECOVER_CORE 1          // 总线恢复任务所在核心，不与控制任务同核
+#define I2C_RECOVER_PRIO 6          // 低于控制任务，高于遥测，尽快把总线交还
+#define I2C_RECOVER_STACK 2048
 
 /********** RGB(WS2812) **********/
 #define RGB_LED_PIN         38
 #define RGB_LED_COUNT       5
+#define RGB_RMT_CHANNEL     RMT_CHANNEL_0
+#define RGB_BRIGHTNESS      96    // 全局亮度 0-255
+#define RGB_OVERRUN_HOLD_MS 1000  // 控制超时后状态灯保持提示的时长
 
 /********** AB编码器  **********/
 /* 左轮编码器 */
@@ -37,6 +48,42 @@
 #define MIN_DUTY            0
 #define MAX_DUTY            ((1UL << PWM_RESOLUTION) - 1)
 
+/********** 安全监控 **********/
+#define SAFETY_TIMER_ID     0      // 硬件定时器编号
+#define SAFETY_TICK_US      2000   // 监控中断周期，与控制周期一致
+#define SAFETY_CTRL_MISS_MAX 10    // 控制任务连续错过的周期数，超过即切断电机
+#define SAFETY_TWDT_TIMEOUT_S 2    // ESP 任务看门狗超时（s）
+// 故障注入（让控制任务停跳）默认编译掉；台架验证时加 -DMY_SAFETY_INJECT=1
+#ifndef MY_SAFETY_INJECT
+#define MY_SAFETY_INJECT    0
+#endif
+#define SAFETY_INJECT_MAX_MS (SAFETY_TWDT_TIMEOUT_S * 1000 / 2) // 注入时长上限，须低于看门狗超时，否则直接复位
+
+/********** 诊断 **********/
+#define DIAG_SAMPLE_MS      1000   // 堆/栈/CPU 采样周期
+#define DIAG_TASK_MAX       24     // 快照中最多记录的任务数
+#define DIAG_CORE           1      // 采样任务所在核心，不得与控制任务同核
+#define DIAG_STACK          3072
+#define DIAG_CPU_WINDOWS    3      // CPU 占用窗口数：1 个采样周期 / 短窗口 / 长窗口
+#define DIAG_CPU_FINE       10     // 短窗口 = 10 个采样周期
+#define DIAG_CPU_COARSE_EVERY 10   // 长窗口每格 = 10 个采样周期
+#define DIAG_CPU_COARSE     6      // 长窗口 = 6 格（60 s）
+
+/********** 事件追踪 **********/
+// 默认编译掉；构建时加 -DMY_TRACE_ENABLE=1 打开，/api/trace 导出 Chrome Trace JSON
+#ifndef MY_TRACE_ENABLE
+#define MY_TRACE_ENABLE     0
+#endif
+#define TRACE_EVENTS        2048   // 每核环形缓冲事件数（2 的幂，每条 12 字节，内部 RAM）
+#define TRACE_SYNC_CYCLES   (1u << 24) // 每隔这么多 CPU 周期写一条 周期计数->us 对时记录
+#define TRACE_TID_MAX       24     // 导出时最多区分的任务数
+
+/********** 遥测编码 **********/
+#define TELEM_KEY_FRAMES    30     // 曲线二进制流每隔这么多帧发一个关键帧（丢帧后最迟在此时恢复）
+#define TELEM_RING_SAMPLES  128    // 控制环样本环长度（2 的幂，每条为全部字段，约 200 字节，内部 RAM）
+#define TELEM_BATCH_MAX     32     // 每帧最多打包的样本数
+#define TELEM_STREAM_BUDGET 8000   // 每个客户端曲线流的字节/秒上限，超出时加大抽样间隔
+
 /********** 屏幕配置 **********/
 #define SCREEN_SDA_PIN      46
 #define SCREEN_SCL_PIN      9
@@ -44,6 +91,9 @@
 #define SCREEN_HEIGHT       32
 #define SCREEN_REFRESH_TIME 100   // ms
 #define SCREEN_I2C_ADDRESS  0x78  // 0x78 on label; driver will shift to 7-bit (0x3C)
+#define SCREEN_I2C_CHUNK    31    // 单次 I2C 写入的最大数据字节数（不含控制字节）
+#define SCREEN_RECOVER_FAILS 3   // 连续该帧数发送失败后请求屏幕总线恢复
+#define BAT_SAMPLE_MS       100   // 电池采样周期，独立于屏幕刷新
 
 /********** 控制死区 **********/
 #define PITCH_ANG_DEADBAND 0.0f   // pitch角度死区，单位：度
@@ -59,12 +109,75 @@ static constexpr float YAW_RATE_MAX_DEG_S = 200.0f;        // 摇杆满量程对
 static constexpr float YAW_RATE_CMD_DEADBAND = 0.5f;       // 摇杆转换的角速度死区
 static constexpr float YAW_TORQUE_DEADBAND = 0.02f;        // 偏航输出死区，避免轻微抖动
 
+/********** 摔倒监控/自恢复配置 **********/
+static constexpr float ARM_PITCH_WINDOW = 8.0f;           // 相对零点倾角在该范围内才允许起控（deg）
+static constexpr float ARM_RATE_MAX = 30.0f;              // 起控时俯仰角速度上限（deg/s）
+static constexpr uint32_t ARM_HOLD_MS = 300;              // 满足起控条件需持续的时间
+static constexpr float SETTLE_RATE_MAX = 20.0f;           // 倒地静止判定：俯仰角速度上限（deg/s）
+static constexpr float SETTLE_WHEEL_MAX = 1.0f;           // 倒地静止判定：轮速上限（rad/s）
+static constexpr uint32_t SETTLE_MS = 400;                // 倒地静止持续时间
+static constexpr uint32_t RECOVER_WAIT_MS = 1000;         // 倒地后等待多久开始自恢复
+static constexpr uint32_t RECOVER_WIND_MS = 120;          // 自恢复：反向蓄势时间
+static constexpr uint32_t RECOVER_KICK_MS = 250;          // 自恢复：正向冲击时间
+static constexpr uint32_t RECOVER_TIMEOUT_MS = 1500;      // 单次自恢复超时
+static constexpr float RECOVER_KICK_DUTY = 1.0f;          // 冲击阶段归一化指令
+static constexpr float RECOVER_WIND_DUTY = 0.5f;          // 蓄势阶段归一化指令
+static constexpr float RECOVER_CATCH_PITCH = 12.0f;       // 进入该倾角范围即交还平衡控制（deg）
+#define RECOVER_MAX_ATTEMPTS 3                            // 连续自恢复失败次数上限
+#define SUPERVISOR_LOG_LEN 16                             // 状态切换日志条数
+
+/********** 前馈配置 **********/
+static constexpr float GRAVITY_MPS2 = 9.80665f;
+static constexpr float FF_ACC_TAU = 0.03f;                // 指令加速度微分低通时间常数（s）
+static constexpr float FF_ACC_LIMIT = 3.0f;               // 指令加速度限幅（m/s^2）
+static constexpr float FF_TOR_LIMIT = 3.0f;               // 力矩前馈限幅（与 base_duty 同量纲）
+
+/********** 航向保持配置 **********/
+static constexpr float HEADING_CAPTURE_RATE = 5.0f;       // 松杆后角速度低于该值（deg/s）才锁定目标航向
+static constexpr float HEADING_STILL_RATE = 2.0f;         // 静止判定：陀螺仪 Z 轴角速度上限（deg/s）
+static constexpr float HEADING_STILL_WHEEL = 0.5f;        // 静止判定：左右轮速差/平均速度上限（rad/s）
+static constexpr uint32_t HEADING_STILL_MS = 500;         // 连续静止该时长后才开始估计零偏
+static constexpr float HEADING_BIAS_TAU = 4.0f;           // 零偏估计低通时间常数（s）
+static constexpr float HEADING_BIAS_LIMIT = 3.0f;         // 零偏估计绝对值上限（deg/s）
+
+/********** 运动曲线配置 **********/
+#define PROFILE_QUEUE_LEN 16                                // 动作脚本队列长度（段）
+static constexpr float PROFILE_V_MAX = 1.0f;              // 线速度上限（m/s）
+static constexpr float PROFILE_A_MAX = 2.0f;              // 线加速度上限（m/s^2）
+static constexpr float PROFILE_J_MAX = 20.0f;             // 加加速度上限（m/s^3）
+static constexpr float PROFILE_YAW_ACC = 400.0f;          // 偏航角速度斜率（deg/s^2）
+static constexpr float PROFILE_ABORT_PITCH = 15.0f;       // 执行中直立误差超过该值（deg）即中止
+
+/********** 里程计配置 **********/
+static constexpr float ODOM_WHEEL_RADIUS_M = 0.034f;      // 轮半径（m），按实车测量修改
+static constexpr float ODOM_TRACK_WIDTH_M = 0.160f;       // 左右轮距（m）
+static constexpr float ODOM_GYRO_WEIGHT = 0.95f;          // 航向融合中陀螺仪权重，其余来自轮速差
+static constexpr float ODOM_REST_V = 0.005f;              // 线速度低于该值（m/s）且轮速差转角速度低于 ODOM_REST_W 视为静止
+static constexpr float ODOM_REST_W = 0.02f;               // 静止判定的轮速差角速度（rad/s），静止时航向只取轮速差，不积分陀螺零漂
+static constexpr float ODOM_DIST_NOISE = 0.02f;           // 行驶距离噪声系数（m^2/m）
+static constexpr float ODOM_HEADING_NOISE = 0.0005f;      // 航向噪声系数（rad^2/rad）
+static constexpr float ODOM_HEADING_DRIFT = 1e-6f;        // 航向随时间的漂移方差（rad^2/s）
+
 /********** wifi配置 **********/
 #define SSID "roderick"
 #define PASSWORD "qazwsxedcr"
 
 /********** 电池检测 **********/
 #define BAT_PIN 10
+#define BAT_DIVIDER 4.0f          // 分压比
+#define BAT_CELLS 3               // 串联节数
+#define BAT_ADC_FREQ_HZ 2000      // 连续采样频率；驱动存储区按两个 BAT_SAMPLE_MS 周期的数据量分配
+#define BAT_DMA_FRAME 256         // 每次从 DMA 取出的字节数，中值取最新一帧
+#define BAT_IIR_TAU 0.5f          // 电压低通时间常数（s）
+#define BAT_R_INT_OHM 0.15f       // 电池内阻 + 线阻
+#define BAT_I_FULL_A 3.0f         // 两电机满占空比时的估计电流
+#define BAT_NOMINAL_V 12.0f       // 参数整定时的电池电压，电压补偿以此为基准
+#define BAT_V_VALID_MIN 6.0f      // 低于此值视为未接电池或采样无效（如仅 USB 供电），不做电压补偿
+#define BAT_COMP_MIN 0.85f        // 电压补偿增益下限
+#define BAT_COMP_MAX 1.30f        // 电压补偿增益上限
+#define BAT_LOW_V 10.5f           // 低电量（开路电压）
+#define BAT_CUTOFF_V 9.9f         // 截止电压，满载压降后低于此值即有掉电风险
+#define BAT_TREND_TAU 30.0f       // 放电斜率低通时间常数（s）
 
 /********** 结构数据体 **********/
 struct imu_data
@@ -101,11 +214,26 @@ struct joy_state
     float x_coef;
     float y_coef;
 };
+// 平衡监控状态机
+enum class balance_phase : uint8_t
+{
+    idle = 0,   // 未运行
+    arming,     // 等待姿态进入起控窗口
+    balancing,  // 正常自平衡
+    falling,    // 判定倾倒，输出已切断，等待落地静止
+    fallen,     // 已倒地
+    recovering  // 自恢复起身中
+};
+
 struct fallen_state
 {
-    bool is;     // 是否摔倒
-    int count;   // 计数
-    bool enable; // 检测是否启用
+    bool is;             // 是否摔倒
+    int count;           // 计数
+    bool enable;         // 检测是否启用
+    bool recover;        // 是否允许自动起身
+    balance_phase phase; // 当前监控状态
+    uint32_t phase_ms;   // 进入当前状态的时间戳
+    uint8_t attempts;    // 本次倒地后已尝试自恢复的次数
 };
 
 
@@ -123,6 +251,20 @@ struct motor_duty
     float R_deadzone_rev;    // 右轮反向起转占空比
 };
 
+struct bat_state
+{
+    float v_raw;     // 单块中值电压（未滤波）
+    float v;         // 滤波后的端电压
+    float ocv;       // 负载补偿后的开路电压估计
+    float current;   // 由占空比估计的电流（A）
+    float soc;       // 剩余电量 0~1
+    float slope;     // 开路电压变化率（V/s）
+    float t_empty_s; // 预计到达截止电压的时间，< 0 表示无法估计
+    float comp;      // 控制侧电压补偿增益
+    bool low;        // 低电量
+    bool brownout;   // 满载时预计跌破截止电压
+};
+
 struct wel_data
 {
     float spd1;
@@ -131,6 +273,69 @@ struct wel_data
     float pos2;
 };
 
+enum class profile_shape : uint8_t
+{
+    trapezoid = 0, // 梯形：加速度阶跃
+    scurve = 1     // S 型：加加速度受限
+};
+
+// 一段动作：d != 0 为直线/弧线行驶，d == 0 时按 t_ms 原地转向或停顿
+struct profile_segment
+{
+    float d;        // 行驶距离（m），负值后退
+    float v;        // 巡航速度（m/s）
+    float a;        // 加速度上限（m/s^2）
+    float j;        // 加加速度上限（m/s^3），仅 S 型使用
+    float w;        // 同时执行的偏航角速度（deg/s）
+    uint32_t t_ms;  // 定时段时长（d == 0 时有效）
+    profile_shape shape;
+};
+
+struct profile_state
+{
+    bool active;      // 是否正在执行脚本
+    int index;        // 已执行完成的段数
+    int queued;       // 队列中剩余段数
+    float s;          // 当前段已行驶距离（m）
+    float v;          // 当前速度设定（m/s）
+    float a;          // 当前加速度设定（m/s^2）
+    float yaw_rate;   // 偏航角速度设定（deg/s）
+    float pos_tar;    // 输出给位置环的目标（轮子转角 rad）
+    float spd_tar;    // 输出给速度环的目标（轮子角速度 rad/s）
+    uint8_t abort_reason; // 最近一次中止原因，见 my_profile.h
+};
+
+struct ff_state
+{
+    bool enable;  // 前馈开关
+    float k_ang;  // 倾角前馈增益（1 为理论值）
+    float k_tor;  // 力矩前馈增益（每 m/s^2 对应的 base_duty）
+    float acc;    // 指令线加速度（m/s^2）
+    float ang;    // 倾角前馈项（deg），叠加到 ang.tar
+    float tor;    // 力矩前馈项，叠加到 motor.base_duty
+};
+
+struct heading_state
+{
+    bool enable;       // 航向保持开关
+    bool holding;      // 当前是否已锁定目标航向
+    float angle;       // 去零偏后的积分航向（deg）
+    float tar;         // 锁定的目标航向（deg）
+    float err;         // 航向误差（deg）
+    float bias;        // 在线估计的 Z 轴零偏（deg/s）
+    uint32_t still_ms; // 连续静止时长
+};
+
+struct odom_state
+{
+    float x;      // 平面位置（m），上电/复位时的朝向为 +x
+    float y;
+    float theta;  // 航向角（rad），逆时针为正
+    float v;      // 线速度（m/s）
+    float w;      // 角速度（rad/s）
+    float cov[6]; // 位姿协方差上三角：xx, xy, xt, yy, yt, tt
+};
+
 struct rgb_state
 {
     int rgb_count; // 灯珠数量
@@ -175,7 +380,9 @@ struct robot_state
     float pitch_zero;
     group_state group_cfg;
     wel_data wel;
+    odom_state odom;
     motor_duty motor;
+    bat_state bat;
 
     imu_data imu_zero;
     imu_data imu_l;
@@ -192,9 +399,13 @@ struct robot_state
     motion_state spd;
     motion_state pos;
     motion_state yaw;
+    heading_state heading;
+    profile_state profile;
+    ff_state ff;
 
     pid_config ang_pid;
     pid_config spd_pid;
     pid_config pos_pid;
     pid_config yaw_pid;
+    pid_config head_pid;
 };
@@ -6,6 +6,9 @@
 #define COUNT_FALL_MAX 3 // 连续3次采样超限才算倒地
 #define FALL_MAX_PITCH +30.0f
 #define FALL_MIN_PITCH -30.0f
+#define FALL_RATE_PITCH 20.0f   // 倾角超过该值且仍在加速倾倒时提前判定
+#define FALL_RATE_MAX 150.0f    // 倾倒方向角速度阈值（deg/s）
+#define FALL_WHEEL_MAX 50.0f    // 轮速饱和阈值（rad/s），配合倾角判定失控
 #define DUTY_SUM_LIM 10.0f
 
 extern void pid_state_update();
@@ -14,6 +17,5 @@ extern void robot_pos_control();
 extern void pitch_control();
 extern void yaw_control();
 extern void pitch_zero_adapt();
-extern void fall_check();
 extern void control_idle_reset();
 extern void duty_add();
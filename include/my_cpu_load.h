@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// 滑动窗口 CPU 占用
+// 每个采样点记录各槽位（任务）的累计运行时间和同一时刻的时间基准，
+// 窗口占用 = 两个采样点之间的运行时间差 / 时间基准差。
+// 纯计算，不依赖 FreeRTOS：主机上可以用模拟的调度记录驱动 push() 得到同样的报表。
+template <uint8_t SLOTS, uint8_t DEPTH>
+class cpu_window
+{
+    static_assert(DEPTH >= 2, "need at least two samples for one interval");
+
+public:
+    // 写入一个采样点；rt[i] 为槽位 i 的累计运行时间
+    void push(uint32_t total, const uint32_t *rt)
+    {
+        head_ = (head_ + 1) % DEPTH;
+        total_[head_] = total;
+        memcpy(rt_[head_], rt, sizeof(rt_[head_]));
+        if (count_ < DEPTH)
+            count_++;
+        for (uint8_t i = 0; i < SLOTS; ++i)
+            if (age_[i] < DEPTH)
+                age_[i]++;
+    }
+
+    // 槽位换了任务，之前的历史作废
+    void reset_slot(uint8_t slot)
+    {
+        if (slot < SLOTS)
+            age_[slot] = 0;
+    }
+
+    // 最近 span 个采样间隔内的占用千分比；历史不够时用现有的最长区间，没有区间时返回 0
+    uint16_t load(uint8_t slot, uint8_t span) const
+    {
+        if (slot >= SLOTS)
+            return 0;
+        int n = intervals(span);
+        if (n > age_[slot] - 1)
+            n = age_[slot] - 1;
+        if (n <= 0)
+            return 0;
+        const uint8_t then = (head_ + DEPTH - n) % DEPTH;
+        const uint32_t dt = total_[head_] - total_[then];
+        if (dt == 0)
+            return 0;
+        const uint64_t d = (uint64_t)(rt_[head_][slot] - rt_[then][slot]) * 1000 / dt;
+        return d > 1000 ? 1000 : static_cast<uint16_t>(d);
+    }
+
+    // 最近 span 个采样间隔实际覆盖的时间基准
+    uint32_t span_total(uint8_t span) const
+    {
+        const int n = intervals(span);
+        if (n <= 0)
+            return 0;
+        return total_[head_] - total_[(head_ + DEPTH - n) % DEPTH];
+    }
+
+private:
+    int intervals(uint8_t span) const
+    {
+        const int avail = count_ - 1;
+        return span < avail ? span : avail;
+    }
+
+    uint32_t total_[DEPTH] = {};
+    uint32_t rt_[DEPTH][SLOTS] = {};
+    uint8_t age_[SLOTS] = {}; // 槽位连续有效的采样点数
+    uint8_t head_ = 0;
+    uint8_t count_ = 0;
+};
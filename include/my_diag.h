@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "my_config.h"
+
+// 单个堆区域（内部 RAM / PSRAM）
+struct diag_heap
+{
+    uint32_t total;
+    uint32_t free;
+    uint32_t min_free; // 开机以来的最低空闲
+    uint32_t largest;  // 最大连续空闲块
+    uint8_t frag;      // 碎片率 % = 100 - largest / free
+};
+
+struct diag_task
+{
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stack_free; // 栈历史最低余量（字节）
+    uint32_t runtime;    // 累计运行时间计数，不支持时为 0
+    uint16_t cpu[DIAG_CPU_WINDOWS]; // 各滑动窗口内占用单核的千分比（1 s / 10 s / 60 s）
+    uint8_t prio;
+    int8_t core;         // -1 表示未绑定
+};
+
+struct diag_snapshot
+{
+    uint32_t seq; // 每次采样 +1
+    uint32_t ms;
+    bool runtime_ok; // 固件是否开启 FreeRTOS 运行时统计
+    diag_heap internal;
+    diag_heap psram;
+    uint16_t core_load[portNUM_PROCESSORS][DIAG_CPU_WINDOWS]; // 各核占用千分比 = 1 - IDLE 占比
+    uint8_t task_count;
+    diag_task tasks[DIAG_TASK_MAX];
+};
+
+void my_diag_init();                     // 在 DIAG_CORE 上创建采样任务
+void diag_register_task(TaskHandle_t t); // 未开启 trace facility 时只能采样登记过的任务
+uint32_t diag_seq();                     // 最新快照序号，用于判断是否需要推送
+void diag_get(diag_snapshot &out);       // 复制最新快照
+
+// 将最新快照写入 Json
+void diag_write_state(JsonObject obj);
+// 紧凑二进制格式（小端）：
+// u8 ver=2 | u8 task_count | u8 runtime_ok | u8 0 | u32 seq | u32 ms
+// heap internal, heap psram: u32 total | u32 free | u32 min_free | u32 largest | u8 frag | u8 0 0 0
+// 各核: u16 load[DIAG_CPU_WINDOWS]
+// 每个任务: char name[16] | u32 stack_free | u32 runtime | u16 cpu[DIAG_CPU_WINDOWS] | u8 prio | i8 core
+// 返回写入字节数，cap 不足时返回 0
+#define DIAG_BIN_HEAD (12 + 2 * 20 + portNUM_PROCESSORS * DIAG_CPU_WINDOWS * 2)
+#define DIAG_BIN_TASK (16 + 8 + DIAG_CPU_WINDOWS * 2 + 2)
+#define DIAG_BIN_MAX (DIAG_BIN_HEAD + DIAG_TASK_MAX * DIAG_BIN_TASK)
+size_t diag_encode_bin(uint8_t *buf, size_t cap);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+
+void feedforward_update(float spd_tar); // 输入本周期速度指令（轮子 rad/s），更新 robot.ff
+void feedforward_reset();
+
+// 将前馈各项写入 Json，方便遥测对比
+void feedforward_write_state(JsonObject obj);
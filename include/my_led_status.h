@@ -0,0 +1,23 @@
+#pragma once
+
+#include "my_rgb.h"
+
+// 状态灯所需的机器人状态快照，由灯效任务每帧采集一次，合成过程不再访问 robot
+struct led_status_snapshot
+{
+    bool tripped;    // 安全监控已切断电机
+    bool imu_fault;  // IMU 连续读取失败
+    bool fallen;     // 已倒地
+    bool recovering; // 正在自动起身
+    bool failsafe;   // 编队指令超时
+    bool overrun;    // 近期控制周期超时
+    bool brownout;   // 满载时可能掉电
+    bool bat_low;    // 低电量
+};
+
+led_status_snapshot led_status_capture(uint32_t now_ms);
+
+// 纯函数：按优先级把状态层叠加到装饰灯效 px 上
+// 整帧覆盖层：切断 > IMU 故障 > 倒地/起身 > 编队超时
+// 单灯提示层：首灯提示控制超时，末灯提示电量
+void led_status_compose(const led_status_snapshot &s, uint32_t now_ms, rgb_px *px, uint16_t count);
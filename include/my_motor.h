@@ -7,3 +7,5 @@ extern volatile float motor_right_u;  // 右轮归一化指令（-1~1）
 
 void my_motor_init();                               // 初始化电机引脚、PWM通道以及死区校准流程
 void my_motor_update();    
+void my_motor_kill();                               // 任务上下文：PWM 清零并短接制动
+void my_motor_kill_isr();                           // 中断上下文：仅通过寄存器拉高方向脚短接制动（IRAM 安全）
@@ -5,4 +5,5 @@ extern MPU6050 mpu6050;
 // MPU6050实例
 extern void my_mpu6050_init();
 extern void my_mpu6050_setzero();
-extern void my_mpu6050_update();
\ No newline at end of file
+extern void my_mpu6050_update();
+extern bool my_mpu6050_ok(); // IMU 数据是否可信（连续失败超过外推上限即为 false）
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+
+void my_odom_init();   // 清零位姿与协方差
+void my_odom_update(); // 每个控制周期调用：编码器增量 + 陀螺仪航向融合
+void my_odom_reset(float x = 0.0f, float y = 0.0f, float theta = 0.0f); // 任意任务可调用：请求清零，控制任务下一周期开头生效
+
+// 将当前位姿写入 Json，方便遥测和应答
+void odom_write_state(JsonObject obj);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+
+// 中止原因（robot.profile.abort_reason）
+#define PROFILE_ABORT_NONE 0
+#define PROFILE_ABORT_USER 1   // 网页下发 stop
+#define PROFILE_ABORT_RUN 2    // 运行开关关闭
+#define PROFILE_ABORT_FALL 3   // 摔倒
+#define PROFILE_ABORT_MODE 4   // 切入车组模式
+#define PROFILE_ABORT_JOY 5    // 摇杆接管
+#define PROFILE_ABORT_PITCH 6  // 直立误差过大
+
+void my_profile_init();
+bool profile_push(const profile_segment &seg); // 网页任务调用：追加一段，队列满返回 false
+void profile_start();                          // 请求开始执行（下个控制周期生效）
+void profile_stop();                           // 请求中止并清空队列（下个控制周期生效）
+void profile_tick();                           // 控制任务调用：每周期 O(1) 生成设定值
+void profile_abort(uint8_t reason);            // 控制任务内部中止
+float profile_dir();                           // 当前段行驶方向（±1），段首周期速度仍为 0 时也有效
+
+profile_shape profile_shape_from_string(const char *shape);
+
+// 将当前脚本执行状态写入 Json，方便遥测和应答
+void profile_write_state(JsonObject obj);
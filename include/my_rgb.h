@@ -11,5 +11,17 @@ enum rgb_mode
     RGB_MODE_HEARTBEAT = 3 // 心跳
 };
 
+struct rgb_px
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
 void my_rgb_init();
 void my_rgb_update();
+
+// 查找表初始化（只在启动时调用一次）
+void rgb_lut_init();
+// 纯函数：给定模式与时间生成一帧像素，不访问硬件与 robot，便于主机测试
+void rgb_render(int mode, uint32_t now_ms, rgb_px *px, uint16_t count);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// 受监控的任务
+enum safety_task
+{
+    SAFETY_TASK_CTRL = 0,
+    SAFETY_TASK_TELEM,
+    SAFETY_TASK_SCREEN,
+    SAFETY_TASK_RGB,
+    SAFETY_TASK_COUNT
+};
+
+void my_safety_init();                       // 启动监控定时器（在任务创建前调用）
+void safety_register_ctrl(TaskHandle_t task); // 将控制任务加入 ESP 任务看门狗
+void safety_beat(safety_task task);          // 各任务每轮循环调用一次
+void safety_log_poll();                      // 低优先级任务调用：打印控制任务留下的切断记录
+bool safety_tripped();                       // 监控是否已切断电机
+uint32_t safety_ctrl_missed();               // 控制任务累计错过的周期数
+void safety_inject_stall(uint32_t ms);       // 故障注入：让控制任务停跳指定时长（仅 MY_SAFETY_INJECT，上限 SAFETY_INJECT_MAX_MS）
+
+// 将心跳与故障计数写入 Json
+void safety_write_state(JsonObject obj);
@@ -1,4 +1,22 @@
 #pragma once
+#include <stdint.h>
+#include <ArduinoJson.h>
 
 void my_screen_init();
-void my_screen_update();
\ No newline at end of file
+void my_screen_update();
+void screen_write_stats(JsonObject obj);
+
+// 比较一页（8 行 x width 列）新旧帧缓冲，返回是否有变化，并给出变化的列区间 [first, last]
+// 纯函数，不依赖硬件，便于在主机上对帧缓冲做测试
+inline bool screen_diff_page(const uint8_t *cur, const uint8_t *prev, int width, int &first, int &last)
+{
+    first = 0;
+    while (first < width && cur[first] == prev[first])
+        ++first;
+    if (first == width)
+        return false;
+    last = width - 1;
+    while (last > first && cur[last] == prev[last])
+        --last;
+    return true;
+}
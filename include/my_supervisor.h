@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+
+struct supervisor_event
+{
+    uint32_t ms;        // 切换时间戳
+    balance_phase from;
+    balance_phase to;
+};
+
+void supervisor_tick(); // 控制任务调用：在控制律之后、电机输出之前运行
+void supervisor_log_poll(); // 低优先级任务调用：把新增的切换日志打印到串口
+
+const char *balance_phase_to_string(balance_phase phase);
+
+// 写入当前状态 / 最近的切换日志（按时间先后）
+void supervisor_write_state(JsonObject obj);
+void supervisor_write_log(JsonArray arr);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+#include "my_telem_schema.h"
+
+// 曲线数据的紧凑二进制编码（WebSocket 二进制帧）
+// 每个值按字段表的 res 量化成整数 q = round(v / res)，与前一个样本的 q 做差，
+// 差值 zig-zag 后写成变长整数（LEB128，每字节 7 位）。静止或缓变的曲线每个值只占 1 字节。
+// 一帧打包 k 个控制环样本（见 my_telem_ring.h），样本间隔 step_ms。
+//
+// 帧格式：
+// 关键帧：u8 TELEM_FRAME_KEY   | u8 seq | u8 n | u8 k | u8 step_ms | u8 split[TELEM_PLOT_CHARTS] | u8 field[n] | 样本 x k
+// 差分帧：u8 TELEM_FRAME_DELTA | u8 seq | u8 n | u8 k | u8 step_ms | 样本 x k
+// 样本：varint zz(q[i] - q_prev[i]) x n；q_prev 为前一个样本（跨帧连续），关键帧的第一个样本 q_prev 取 0。
+// field 为字段表下标（即 /api/schema 中 fields 的下标），解码端据此取 res；split 为各图曲线数。
+// seq 每帧 +1（回绕）。解码端收到的差分帧 seq 不连续时丢弃，直到下一个关键帧。
+// 关键帧每 TELEM_KEY_FRAMES 帧一个；曲线选择变化、新连接或发送端已知丢帧后立即补发。
+
+enum telem_frame_type : uint8_t
+{
+    TELEM_FRAME_KEY = 1,
+    TELEM_FRAME_DELTA = 2,
+};
+
+constexpr size_t TELEM_FRAME_HEAD = 5;
+constexpr size_t TELEM_FRAME_MAX = TELEM_FRAME_HEAD + TELEM_PLOT_CHARTS + TELEM_PLOT_MAX + 5 * TELEM_PLOT_MAX * TELEM_BATCH_MAX;
+
+// 每条编码流的参考状态；发送给同一客户端的帧必须依次经过同一个状态
+struct telem_codec
+{
+    bool valid;        // false 时下一帧强制为关键帧
+    uint8_t seq;       // 下一帧的序号
+    uint8_t since_key; // 距上个关键帧的帧数
+    uint8_t n;
+    uint8_t field[TELEM_PLOT_MAX];
+    int32_t q[TELEM_PLOT_MAX];
+};
+
+// 两个状态相同时，编码结果相同，可共用一份缓冲
+bool telem_codec_same(const telem_codec &a, const telem_codec &b);
+// rows 为按 plot 取出的 k 个样本（k <= TELEM_BATCH_MAX）；out 至少 TELEM_FRAME_MAX 字节，返回帧长度
+size_t telem_codec_encode(telem_codec &c, const telem_plot &p, const float (*rows)[TELEM_PLOT_MAX], uint8_t k,
+                          uint8_t step_ms, uint8_t *out);
+// 帧数、关键帧数、样本数、字节数、编码耗时
+void telem_codec_write_state(JsonObject obj);
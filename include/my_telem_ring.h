@@ -0,0 +1,27 @@
+#pragma once
+
+#include "my_config.h"
+#include "my_telem_schema.h"
+
+// 控制环样本环：控制任务每个周期末尾存一份全部字段，telem 任务按各客户端的曲线选择取出打包，
+// 这样曲线流能以控制频率还原波形，而不是只有推送时刻的快照。
+// 单生产者（控制任务，核 0）单消费者（telem 任务，核 1），不加锁；消费端读完后复查写指针，
+// 期间被覆盖的样本丢弃。没有客户端订阅 loops 时不采样。
+
+// 每个客户端的打包状态
+struct telem_batch
+{
+    uint32_t cursor;  // 下一个要取的样本序号（累计）
+    uint8_t stride;   // 抽样间隔（样本数），由字节预算决定
+    uint16_t est_x16; // 每个样本编码后的平均字节数 x16
+};
+
+void telem_ring_enable(bool on); // telem 任务按订阅情况开关采样
+void telem_ring_push();          // 控制任务每周期调用
+
+// 按 stride 从 cursor 取到最新样本，最多 TELEM_BATCH_MAX 个，写入 rows 并推进 cursor；返回样本数
+// step_ms 返回样本间隔
+uint8_t telem_ring_take(telem_batch &b, const telem_plot &p, float (*rows)[TELEM_PLOT_MAX], uint8_t &step_ms);
+// 编码后记录帧长，更新每样本字节数估计，供下一帧选择 stride
+void telem_batch_account(telem_batch &b, size_t frame_len, uint8_t k);
+bool telem_batch_same(const telem_batch &a, const telem_batch &b);
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+#include "my_config.h"
+#include "my_motion.h"
+
+// 遥测字段表：唯一的字段定义来源
+// 默认图表曲线、ui_config 中的标题/图例/滑块、PID 参数的读写、/api/schema 都由这张表生成，
+// 前端按表里的 key 取值，不再依赖下标约定。新增字段只需在表中加一行。
+
+enum class telem_type : uint8_t
+{
+    F32,
+    I32,
+    BOOL,
+};
+
+enum telem_flag : uint8_t
+{
+    TELEM_F_CHART = 1 << 0, // 默认图表曲线，同一 group 的连续字段画在同一张图上（网页可改选任意字段）
+    TELEM_F_PARAM = 1 << 1, // 可由网页写入的参数（控制参数滑块）
+};
+
+struct telem_field
+{
+    const char *key;   // 唯一键，JSON 与前端共用
+    const char *group; // 所属分组：图表标题 / 滑块分组
+    const char *label; // 图例 / 滑块名称
+    const char *unit;
+    uint16_t offset;   // 在 robot_state 中的偏移
+    telem_type type;
+    uint8_t flags;
+    float res;         // 显示 / 量化分辨率
+};
+
+template <typename T>
+struct telem_type_of;
+template <>
+struct telem_type_of<float>
+{
+    static constexpr telem_type value = telem_type::F32;
+};
+template <>
+struct telem_type_of<int>
+{
+    static constexpr telem_type value = telem_type::I32;
+};
+template <>
+struct telem_type_of<bool>
+{
+    static constexpr telem_type value = telem_type::BOOL;
+};
+
+// 类型由成员声明推导，成员改类型时表会跟着变；不支持的类型编译报错
+#define TELEM_FIELD(key, group, label, unit, member, flags, res)                                        \
+    telem_field                                                                                          \
+    {                                                                                                    \
+        key, group, label, unit, static_cast<uint16_t>(offsetof(robot_state, member)),                   \
+            telem_type_of<decltype(std::declval<robot_state &>().member)>::value, flags, res             \
+    }
+
+constexpr telem_field TELEM_FIELDS[] = {
+    // 控制环（默认图表）
+    TELEM_FIELD("ang.now", "直立环", "now", "deg", ang.now, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("ang.duty", "直立环", "tor", "", ang.duty, TELEM_F_CHART, 0.001f),
+    TELEM_FIELD("ang.err", "直立环", "err", "deg", ang.err, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("spd.now", "速度环", "now", "rad/s", spd.now, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("spd.duty", "速度环", "tor", "deg", spd.duty, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("spd.err", "速度环", "err", "rad/s", spd.err, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("pos.now", "位置环", "now", "rad", pos.now, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("pos.duty", "位置环", "tor", "rad/s", pos.duty, TELEM_F_CHART, 0.01f),
+    TELEM_FIELD("pos.err", "位置环", "err", "rad", pos.err, TELEM_F_CHART, 0.01f),
+    // 其余可观测状态
+    TELEM_FIELD("ang.tar", "直立环", "tar", "deg", ang.tar, 0, 0.01f),
+    TELEM_FIELD("spd.tar", "速度环", "tar", "rad/s", spd.tar, 0, 0.01f),
+    TELEM_FIELD("pos.tar", "位置环", "tar", "rad", pos.tar, 0, 0.01f),
+    TELEM_FIELD("yaw.now", "偏航环", "now", "deg/s", yaw.now, 0, 0.1f),
+    TELEM_FIELD("yaw.tar", "偏航环", "tar", "deg/s", yaw.tar, 0, 0.1f),
+    TELEM_FIELD("yaw.duty", "偏航环", "tor", "", yaw.duty, 0, 0.001f),
+    TELEM_FIELD("imu.pitch", "姿态", "pitch", "deg", imu.angley, 0, 0.01f),
+    TELEM_FIELD("imu.roll", "姿态", "roll", "deg", imu.anglex, 0, 0.01f),
+    TELEM_FIELD("imu.yaw", "姿态", "yaw", "deg", imu.anglez, 0, 0.01f),
+    TELEM_FIELD("imu.gx", "姿态", "gx", "deg/s", imu.gyrox, 0, 0.1f),
+    TELEM_FIELD("imu.gy", "姿态", "gy", "deg/s", imu.gyroy, 0, 0.1f),
+    TELEM_FIELD("imu.gz", "姿态", "gz", "deg/s", imu.gyroz, 0, 0.1f),
+    TELEM_FIELD("motor.L", "电机", "L", "", motor.L_cmd, 0, 0.001f),
+    TELEM_FIELD("motor.R", "电机", "R", "", motor.R_cmd, 0, 0.001f),
+    TELEM_FIELD("motor.Ld", "电机", "L duty", "", motor.L_duty, 0, 0.001f),
+    TELEM_FIELD("motor.Rd", "电机", "R duty", "", motor.R_duty, 0, 0.001f),
+    TELEM_FIELD("wel.spd1", "轮子", "spd L", "rad/s", wel.spd1, 0, 0.01f),
+    TELEM_FIELD("wel.spd2", "轮子", "spd R", "rad/s", wel.spd2, 0, 0.01f),
+    TELEM_FIELD("wel.pos1", "轮子", "pos L", "rad", wel.pos1, 0, 0.01f),
+    TELEM_FIELD("wel.pos2", "轮子", "pos R", "rad", wel.pos2, 0, 0.01f),
+    TELEM_FIELD("ff.acc", "前馈", "acc", "m/s^2", ff.acc, 0, 0.01f),
+    TELEM_FIELD("ff.ang", "前馈", "ang", "deg", ff.ang, 0, 0.01f),
+    TELEM_FIELD("ff.tor", "前馈", "tor", "", ff.tor, 0, 0.001f),
+    TELEM_FIELD("heading.err", "航向", "err", "deg", heading.err, 0, 0.01f),
+    TELEM_FIELD("heading.bias", "航向", "bias", "deg/s", heading.bias, 0, 0.001f),
+    TELEM_FIELD("odom.v", "里程计", "v", "m/s", odom.v, 0, 0.001f),
+    TELEM_FIELD("odom.w", "里程计", "w", "rad/s", odom.w, 0, 0.001f),
+    TELEM_FIELD("bat.v", "电池", "v", "V", bat.v, 0, 0.01f),
+    // 控制参数（滑块），顺序即网页上的顺序
+    TELEM_FIELD("ang_pid.p", "直立环", "P", "", ang_pid.p, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("ang_pid.i", "直立环", "I", "", ang_pid.i, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("ang_pid.d", "直立环", "D", "", ang_pid.d, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("spd_pid.p", "速度环", "P", "", spd_pid.p, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("spd_pid.i", "速度环", "I", "", spd_pid.i, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("spd_pid.d", "速度环", "D", "", spd_pid.d, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("pos_pid.p", "位置环", "P", "", pos_pid.p, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("pos_pid.i", "位置环", "I", "", pos_pid.i, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("pos_pid.d", "位置环", "D", "", pos_pid.d, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("yaw_pid.p", "偏航环", "P", "", yaw_pid.p, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("yaw_pid.i", "偏航环", "I", "", yaw_pid.i, TELEM_F_PARAM, 0.001f),
+    TELEM_FIELD("yaw_pid.d", "偏航环", "D", "", yaw_pid.d, TELEM_F_PARAM, 0.001f),
+};
+
+constexpr size_t TELEM_FIELD_COUNT = sizeof(TELEM_FIELDS) / sizeof(TELEM_FIELDS[0]);
+
+// ---- 编译期检查 ----
+namespace telem_schema_detail
+{
+    constexpr bool str_eq(const char *a, const char *b)
+    {
+        return *a == *b && (*a == '\0' || str_eq(a + 1, b + 1));
+    }
+    constexpr bool key_unique_from(size_t i, size_t j)
+    {
+        return j >= TELEM_FIELD_COUNT ||
+               (!str_eq(TELEM_FIELDS[i].key, TELEM_FIELDS[j].key) && key_unique_from(i, j + 1));
+    }
+    constexpr bool keys_unique(size_t i = 0)
+    {
+        return i >= TELEM_FIELD_COUNT || (key_unique_from(i, i + 1) && keys_unique(i + 1));
+    }
+    constexpr size_t count_flag(uint8_t flag, size_t i = 0)
+    {
+        return i >= TELEM_FIELD_COUNT ? 0 : ((TELEM_FIELDS[i].flags & flag) ? 1 : 0) + count_flag(flag, i + 1);
+    }
+    constexpr bool params_are_f32(size_t i = 0)
+    {
+        return i >= TELEM_FIELD_COUNT ||
+               ((!(TELEM_FIELDS[i].flags & TELEM_F_PARAM) || TELEM_FIELDS[i].type == telem_type::F32) && params_are_f32(i + 1));
+    }
+} // namespace telem_schema_detail
+
+static_assert(TELEM_FIELD_COUNT < 256, "field index must fit in uint8_t");
+static_assert(telem_schema_detail::keys_unique(), "duplicate telemetry key");
+static_assert(telem_schema_detail::params_are_f32(), "writable parameters must be float");
+
+constexpr size_t TELEM_CHART_FIELDS = telem_schema_detail::count_flag(TELEM_F_CHART);
+constexpr size_t TELEM_PARAM_FIELDS = telem_schema_detail::count_flag(TELEM_F_PARAM);
+
+// ---- 取值 / 写入 ----
+inline float telem_read(const telem_field &f)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&robot) + f.offset;
+    switch (f.type)
+    {
+    case telem_type::F32:
+    {
+        float v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    case telem_type::I32:
+    {
+        int v;
+        memcpy(&v, p, sizeof(v));
+        return static_cast<float>(v);
+    }
+    case telem_type::BOOL:
+        return *p ? 1.0f : 0.0f;
+    }
+    return 0.0f;
+}
+
+inline void telem_write(const telem_field &f, float v)
+{
+    uint8_t *p = reinterpret_cast<uint8_t *>(&robot) + f.offset;
+    switch (f.type)
+    {
+    case telem_type::F32:
+        memcpy(p, &v, sizeof(v));
+        break;
+    case telem_type::I32:
+    {
+        const int i = static_cast<int>(v);
+        memcpy(p, &i, sizeof(i));
+        break;
+    }
+    case telem_type::BOOL:
+        *p = v != 0.0f;
+        break;
+    }
+}
+
+inline const char *telem_type_name(telem_type t)
+{
+    return t == telem_type::F32 ? "f32" : (t == telem_type::I32 ? "i32" : "bool");
+}
+
+// ---- 图表曲线选择 ----
+// 网页按字段键选择要画的曲线，固件解析一次成字段下标表，打包时按下标从样本环取值
+constexpr uint8_t TELEM_PLOT_CHARTS = 3;    // 图表数
+constexpr uint8_t TELEM_PLOT_PER_CHART = 6; // 每张图最多曲线数
+constexpr uint8_t TELEM_PLOT_MAX = TELEM_PLOT_CHARTS * TELEM_PLOT_PER_CHART;
+
+struct telem_plot
+{
+    uint8_t n;                        // 曲线总数，各图依次拼接
+    uint8_t split[TELEM_PLOT_CHARTS]; // 各图曲线数
+    uint8_t field[TELEM_PLOT_MAX];    // 字段表下标，取值时从样本环按下标读
+};
+
+inline bool telem_plot_same(const telem_plot &a, const telem_plot &b)
+{
+    return a.n == b.n && memcmp(a.split, b.split, sizeof(a.split)) == 0 && memcmp(a.field, b.field, a.n) == 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include "my_config.h"
+
+// 事件追踪：控制环各阶段、网络回调、屏幕/灯效任务打 begin/end 点，
+// 每核一个环形缓冲，导出为 Chrome Trace Event JSON（chrome://tracing、ui.perfetto.dev 均可打开）。
+// MY_TRACE_ENABLE 为 0 时所有宏展开为空，不占用 RAM 也不产生代码。
+
+// 追踪点：X(枚举名, 导出名)
+#define TRACE_IDS(X)               \
+    X(CTRL, "ctrl")                \
+    X(IMU, "imu_i2c")              \
+    X(STATE, "state")              \
+    X(ODOM, "odom")                \
+    X(GROUP, "group")              \
+    X(BALANCE, "balance")          \
+    X(SUP, "supervisor")           \
+    X(MOTOR, "motor")              \
+    X(TELEM, "telem")              \
+    X(WS_DATA, "ws_evt_data")      \
+    X(WS_BCAST, "wsBroadcast")     \
+    X(WS_PUMP, "ws_fanout_pump")   \
+    X(FS_READ, "fs_read")          \
+    X(SCREEN, "screen")            \
+    X(OLED_I2C, "oled_i2c")        \
+    X(RGB_SHOW, "rgb_show")        \
+    X(BAT, "bat")                  \
+    X(SAFETY_TRIP, "safety_trip")
+
+enum trace_id : uint16_t
+{
+#define TRACE_ENUM(id, name) TRACE_##id,
+    TRACE_IDS(TRACE_ENUM)
+#undef TRACE_ENUM
+    TRACE_ID_COUNT
+};
+
+enum trace_phase : uint8_t
+{
+    TRACE_PH_BEGIN,
+    TRACE_PH_END,
+    TRACE_PH_INSTANT,
+    TRACE_PH_SYNC, // 内部：周期计数与 esp_timer 对时
+};
+
+#if MY_TRACE_ENABLE
+
+void trace_rec(uint16_t id, uint8_t ph); // 任务和中断中均可调用
+void trace_arm();                        // 清空缓冲并开始记录（开机默认已开始）
+void trace_freeze(uint16_t reason = TRACE_ID_COUNT); // 停止记录并保留现场，reason 记为一条瞬时事件；中断中可调用
+bool trace_armed();
+void trace_write_state(JsonObject obj);
+
+// 导出：打开读者期间暂停记录，关闭时恢复打开前的状态；同一时刻只允许一个读者
+struct trace_reader;
+trace_reader *trace_reader_open();                                  // 已有读者时返回 nullptr
+size_t trace_reader_fill(trace_reader *r, uint8_t *buf, size_t cap); // 输出下一段 JSON，返回 0 表示结束
+void trace_reader_close(trace_reader *r);
+
+class trace_scope
+{
+public:
+    explicit trace_scope(uint16_t id) : id_(id) { trace_rec(id_, TRACE_PH_BEGIN); }
+    ~trace_scope() { trace_rec(id_, TRACE_PH_END); }
+    trace_scope(const trace_scope &) = delete;
+    trace_scope &operator=(const trace_scope &) = delete;
+
+private:
+    uint16_t id_;
+};
+
+#define TRACE_CAT2(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT2(a, b)
+#define TRACE_BEGIN(id) trace_rec(TRACE_##id, TRACE_PH_BEGIN)
+#define TRACE_END(id) trace_rec(TRACE_##id, TRACE_PH_END)
+#define TRACE_INSTANT(id) trace_rec(TRACE_##id, TRACE_PH_INSTANT)
+#define TRACE_SCOPE(id) trace_scope TRACE_CAT(trace_scope_, __LINE__)(TRACE_##id)
+#define TRACE_FREEZE(id) trace_freeze(TRACE_##id)
+
+#else
+
+#define TRACE_BEGIN(id) ((void)0)
+#define TRACE_END(id) ((void)0)
+#define TRACE_INSTANT(id) ((void)0)
+#define TRACE_SCOPE(id) ((void)0)
+#define TRACE_FREEZE(id) ((void)0)
+
+#endif
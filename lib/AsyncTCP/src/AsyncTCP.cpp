@@ -2,10 +2,11 @@
 // Copyright 2016-2025 Hristo Gochkov, Mathieu Carbou, Emil Muratov
 
 #include "AsyncTCP.h"
-#include "AsyncTCPSimpleIntrusiveList.h"
+#include "AsyncTCPBoundedQueue.h"
 
 #ifndef LIBRETINY
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #ifdef ARDUINO
 #include <esp32-hal.h>
@@ -110,9 +111,10 @@ typedef enum {
 } lwip_tcp_event_t;
 
 struct lwip_tcp_event_packet_t {
-  lwip_tcp_event_packet_t *next;
   lwip_tcp_event_t event;
   AsyncClient *client;
+  std::atomic<uint32_t> tag;  // (generation << 8) | state, see event_state_t
+  uint32_t queued_us;
   union {
     struct {
       tcp_pcb *pcb;
@@ -146,7 +148,7 @@ struct lwip_tcp_event_packet_t {
     } dns;
   };
 
-  inline lwip_tcp_event_packet_t(lwip_tcp_event_t _event, AsyncClient *_client) : next(nullptr), event(_event), client(_client){};
+  inline lwip_tcp_event_packet_t() : event(LWIP_TCP_POLL), client(nullptr), tag(0), queued_us(0){};
 };
 
 // Detail class for interacting with AsyncClient internals, but without exposing the API
@@ -154,6 +156,7 @@ class AsyncTCP_detail {
 public:
   // Helper functions
   static void __attribute__((visibility("internal"))) handle_async_event(lwip_tcp_event_packet_t *event);
+  static __attribute__((visibility("internal"))) lwip_tcp_event_packet_t *get_async_event();
 
   // LwIP TCP event callbacks that (will) require privileged access
   static int8_t __attribute__((visibility("internal"))) tcp_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *pb, int8_t err);
@@ -163,115 +166,207 @@ public:
   static int8_t __attribute__((visibility("internal"))) tcp_accept(void *arg, tcp_pcb *pcb, int8_t err);
 };
 
-// Guard class for the global queue
+/*
+  Event queue
+
+  LwIP callbacks (producers) and the async_tcp task (single consumer) share a bounded lock-free ring.
+  Packets come from a fixed pool whose free list is a second ring, so no callback allocates or takes a lock.
+  Closing/erroring a client does not unlink its queued packets: they are flagged cancelled and the consumer
+  recycles them. The tag generation stops a recycled packet from being cancelled by a stale scan.
+
+  Shedding is deterministic and by priority:
+  - POLL: coalesced per client (at most one queued), shed at CONFIG_ASYNC_TCP_POLL_SHED_DEPTH
+  - RECV: refused with ERR_MEM once only the control reserve is left; LwIP keeps the data and retries
+  - SENT/ERROR/FIN/ACCEPT/CONNECTED/DNS: may use the whole ring, lost (and counted) only when it is full
+*/
 namespace {
 
-static SemaphoreHandle_t _async_queue_mutex = nullptr;
+constexpr size_t _pow2_at_least(size_t n, size_t p = 2) {
+  return (p >= n) ? p : _pow2_at_least(n, p * 2);
+}
 
-class queue_mutex_guard {
-  bool holds_mutex;
+constexpr size_t ASYNC_TCP_RING_SIZE = _pow2_at_least(CONFIG_ASYNC_TCP_QUEUE_SIZE);
+// one packet in dispatch plus a few in flight between pool and ring
+constexpr size_t ASYNC_TCP_POOL_SIZE = ASYNC_TCP_RING_SIZE + 4;
+constexpr size_t ASYNC_TCP_DATA_LIMIT = (ASYNC_TCP_RING_SIZE > CONFIG_ASYNC_TCP_CTRL_RESERVE) ? ASYNC_TCP_RING_SIZE - CONFIG_ASYNC_TCP_CTRL_RESERVE : 1;
 
-public:
-  inline queue_mutex_guard() : holds_mutex(xSemaphoreTake(_async_queue_mutex, portMAX_DELAY)){};
-  inline ~queue_mutex_guard() {
-    if (holds_mutex) {
-      xSemaphoreGive(_async_queue_mutex);
-    }
-  };
-  inline explicit operator bool() const {
-    return holds_mutex;
-  };
+enum event_state_t : uint32_t {
+  EVENT_FREE = 0,
+  EVENT_QUEUED = 1,
+  EVENT_TAKEN = 2,
+  EVENT_CANCELLED = 3,
 };
+
+inline uint32_t _event_state(uint32_t tag) {
+  return tag & 0xFF;
+}
+
+inline uint32_t _event_retag(uint32_t tag, event_state_t state) {
+  return (tag & ~0xFFu) | state;
+}
+
+struct queue_counters_t {
+  std::atomic<uint32_t> high_water{0};
+  std::atomic<uint32_t> enqueued{0};
+  std::atomic<uint32_t> poll_coalesced{0};
+  std::atomic<uint32_t> poll_shed{0};
+  std::atomic<uint32_t> recv_deferred{0};
+  std::atomic<uint32_t> dropped{0};
+  std::atomic<uint32_t> cancelled{0};
+  std::atomic<uint32_t> wait_avg_us{0};
+  std::atomic<uint32_t> wait_max_us{0};
+  std::atomic<uint32_t> pool_high_water{0};
+};
+
+static lwip_tcp_event_packet_t _event_pool[ASYNC_TCP_POOL_SIZE];
+static AsyncTCPBoundedQueue<lwip_tcp_event_packet_t *, ASYNC_TCP_RING_SIZE * 2> _event_free;
+static AsyncTCPBoundedQueue<lwip_tcp_event_packet_t *, ASYNC_TCP_RING_SIZE> _async_queue;
+static queue_counters_t _queue_counters;
+static bool _event_pool_ready = false;
+
+inline uint32_t _event_now_us() {
+#ifdef LIBRETINY
+  return micros();
+#else
+  return (uint32_t)esp_timer_get_time();
+#endif
+}
+
+inline void _counter_max(std::atomic<uint32_t> &counter, uint32_t value) {
+  uint32_t cur = counter.load(std::memory_order_relaxed);
+  while (value > cur && !counter.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+inline void _counter_inc(std::atomic<uint32_t> &counter) {
+  counter.fetch_add(1, std::memory_order_relaxed);
+}
 }  // anonymous namespace
 
-static SimpleIntrusiveList<lwip_tcp_event_packet_t> _async_queue;
 static TaskHandle_t _async_service_task_handle = NULL;
 
+static void _init_event_pool() {
+  if (_event_pool_ready) {
+    return;
+  }
+  for (auto &pkt : _event_pool) {
+    _event_free.push(&pkt);
+  }
+  _event_pool_ready = true;
+}
+
+static lwip_tcp_event_packet_t *_alloc_event(lwip_tcp_event_t event, AsyncClient *client) {
+  lwip_tcp_event_packet_t *e = nullptr;
+  if (!_event_free.pop(e)) {
+    return nullptr;
+  }
+  _counter_max(_queue_counters.pool_high_water, ASYNC_TCP_POOL_SIZE - _event_free.size());
+  // bump the generation so stale cancel scans can not match the recycled packet
+  e->tag.store(e->tag.load(std::memory_order_relaxed) + 0x100, std::memory_order_relaxed);
+  e->event = event;
+  e->client = client;
+  return e;
+}
+
 static void _free_event(lwip_tcp_event_packet_t *evpkt) {
   if ((evpkt->event == LWIP_TCP_RECV) && (evpkt->recv.pb != nullptr)) {
     pbuf_free(evpkt->recv.pb);
+    evpkt->recv.pb = nullptr;
   }
-  delete evpkt;
+  evpkt->client = nullptr;
+  evpkt->tag.store(_event_retag(evpkt->tag.load(std::memory_order_relaxed), EVENT_FREE), std::memory_order_release);
+  _event_free.push(evpkt);
 }
 
-static inline void _send_async_event(lwip_tcp_event_packet_t *e) {
+// Takes ownership of e; returns false if it had to be dropped
+static bool _send_async_event(lwip_tcp_event_packet_t *e) {
   if (e == nullptr) {
-    return;
+    return false;
   }
-  _async_queue.push_back(e);
-  xTaskNotifyGive(_async_service_task_handle);
-}
-
-static inline void _prepend_async_event(lwip_tcp_event_packet_t *e) {
-  if (e == nullptr) {
-    return;
+  e->queued_us = _event_now_us();
+  e->tag.store(_event_retag(e->tag.load(std::memory_order_relaxed), EVENT_QUEUED), std::memory_order_release);
+  if (!_async_queue.push(e)) {
+    if (e->event == LWIP_TCP_RECV) {
+      e->recv.pb = nullptr;  // refused: LwIP keeps ownership of the pbuf
+    }
+    _free_event(e);
+    return false;
   }
-  _async_queue.push_front(e);
+  _counter_inc(_queue_counters.enqueued);
+  _counter_max(_queue_counters.high_water, _async_queue.size());
   xTaskNotifyGive(_async_service_task_handle);
+  return true;
 }
 
-static inline lwip_tcp_event_packet_t *_get_async_event() {
-  queue_mutex_guard guard;
-  while (1) {
-    lwip_tcp_event_packet_t *e = _async_queue.pop_front();
-
-    if ((!e) || (e->event != LWIP_TCP_POLL)) {
-      return e;
-    }
-
-    /*
-      Let's try to coalesce two (or more) consecutive poll events into one
-      this usually happens with poor implemented user-callbacks that are runs too long and makes poll events to stack in the queue
-      if consecutive user callback for a same connection runs longer that poll time then it will fill the queue with events until it deadlocks.
-      This is a workaround to mitigate such poor designs and won't let other events/connections to starve the task time.
-      It won't be effective if user would run multiple simultaneous long running callbacks due to message interleaving.
-      todo: implement some kind of fair dequeuing or (better) simply punish user for a bad designed callbacks by resetting hog connections
-    */
-    for (lwip_tcp_event_packet_t *next_pkt = _async_queue.begin(); next_pkt && (next_pkt->client == e->client) && (next_pkt->event == LWIP_TCP_POLL);
-         next_pkt = _async_queue.begin()) {
-      // if the next event that will come is a poll event for the same connection, we can discard it and continue
-      _free_event(_async_queue.pop_front());
-      log_d("coalescing polls, network congestion or async callbacks might be too slow!");
-    }
+static inline void _drop_event(lwip_tcp_event_t event) {
+  _counter_inc(_queue_counters.dropped);
+  log_e("event queue full, dropped event %d", (int)event);
+}
 
-    /*
-      now we have to decide if to proceed with poll callback handler or discard it?
-      poor designed apps using asynctcp without proper dataflow control could flood the queue with interleaved pool/ack events.
-      I.e. on each poll app would try to generate more data to send, which in turn results in additional ack event triggering chain effect
-      for long connections. Or poll callback could take long time starving other connections. Anyway our goal is to keep the queue length
-      grows under control (if possible) and poll events are the safest to discard.
-      Let's discard poll events processing using linear-increasing probability curve when queue size grows over 3/4
-      Poll events are periodic and connection could get another chance next time
-    */
-    if (_async_queue.size() > (rand() % CONFIG_ASYNC_TCP_QUEUE_SIZE / 4 + CONFIG_ASYNC_TCP_QUEUE_SIZE * 3 / 4)) {
+lwip_tcp_event_packet_t *AsyncTCP_detail::get_async_event() {
+  lwip_tcp_event_packet_t *e = nullptr;
+  while (_async_queue.pop(e)) {
+    uint32_t tag = e->tag.load(std::memory_order_acquire);
+    if (_event_state(tag) != EVENT_QUEUED || !e->tag.compare_exchange_strong(tag, _event_retag(tag, EVENT_TAKEN), std::memory_order_acq_rel)) {
+      // cancelled by _remove_events_for_client(), the client may already be gone
       _free_event(e);
-      log_d("discarding poll due to queue congestion");
       continue;
     }
 
+    uint32_t wait = _event_now_us() - e->queued_us;
+    uint32_t avg = _queue_counters.wait_avg_us.load(std::memory_order_relaxed);
+    _queue_counters.wait_avg_us.store(avg + ((int32_t)(wait - avg) >> 4), std::memory_order_relaxed);
+    _counter_max(_queue_counters.wait_max_us, wait);
+
+    if (e->event == LWIP_TCP_POLL) {
+      if (e->client) {
+        e->client->_poll_queued = false;
+      }
+      // the queue grew while this poll waited; polls are periodic, the connection gets another chance
+      if (_async_queue.size() >= CONFIG_ASYNC_TCP_POLL_SHED_DEPTH) {
+        _counter_inc(_queue_counters.poll_shed);
+        _free_event(e);
+        continue;
+      }
+    }
     return e;
   }
+  return nullptr;
 }
 
+// Runs on the LwIP thread
 static size_t _remove_events_for_client(AsyncClient *client) {
-  lwip_tcp_event_packet_t *removed_event_chain;
-  {
-    queue_mutex_guard guard;
-    removed_event_chain = _async_queue.remove_if([=](lwip_tcp_event_packet_t &pkt) {
-      return pkt.client == client;
-    });
-  }
-
   size_t count = 0;
-  while (removed_event_chain) {
-    ++count;
-    auto t = removed_event_chain;
-    removed_event_chain = t->next;
-    _free_event(t);
-  }
+  _async_queue.for_each([&](lwip_tcp_event_packet_t *e) {
+    uint32_t tag = e->tag.load(std::memory_order_acquire);
+    if (_event_state(tag) == EVENT_QUEUED && e->client == client
+        && e->tag.compare_exchange_strong(tag, _event_retag(tag, EVENT_CANCELLED), std::memory_order_acq_rel)) {
+      ++count;
+    }
+  });
+  _queue_counters.cancelled.fetch_add(count, std::memory_order_relaxed);
   return count;
 };
 
+void asyncTcpQueueStats(async_tcp_queue_stats_t *stats) {
+  if (!stats) {
+    return;
+  }
+  stats->depth = _async_queue.size();
+  stats->high_water = _queue_counters.high_water.load(std::memory_order_relaxed);
+  stats->capacity = ASYNC_TCP_RING_SIZE;
+  stats->enqueued = _queue_counters.enqueued.load(std::memory_order_relaxed);
+  stats->poll_coalesced = _queue_counters.poll_coalesced.load(std::memory_order_relaxed);
+  stats->poll_shed = _queue_counters.poll_shed.load(std::memory_order_relaxed);
+  stats->recv_deferred = _queue_counters.recv_deferred.load(std::memory_order_relaxed);
+  stats->dropped = _queue_counters.dropped.load(std::memory_order_relaxed);
+  stats->cancelled = _queue_counters.cancelled.load(std::memory_order_relaxed);
+  stats->wait_avg_us = _queue_counters.wait_avg_us.load(std::memory_order_relaxed);
+  stats->wait_max_us = _queue_counters.wait_max_us.load(std::memory_order_relaxed);
+  stats->pool_size = ASYNC_TCP_POOL_SIZE;
+  stats->pool_used = _event_pool_ready ? ASYNC_TCP_POOL_SIZE - _event_free.size() : 0;
+  stats->pool_high_water = _queue_counters.pool_high_water.load(std::memory_order_relaxed);
+}
+
 void AsyncTCP_detail::handle_async_event(lwip_tcp_event_packet_t *e) {
   if (e->client == NULL) {
     // do nothing when arg is NULL
@@ -312,7 +407,7 @@ static void _async_service_task(void *pvParameters) {
   }
 #endif
   for (;;) {
-    while (auto packet = _get_async_event()) {
+    while (auto packet = AsyncTCP_detail::get_async_event()) {
       AsyncTCP_detail::handle_async_event(packet);
 #if CONFIG_ASYNC_TCP_USE_WDT
       esp_task_wdt_reset();
@@ -358,12 +453,7 @@ static bool customTaskCreateUniversal(
 }
 
 static bool _start_async_task() {
-  if (!_async_queue_mutex) {
-    _async_queue_mutex = xSemaphoreCreateMutex();
-    if (!_async_queue_mutex) {
-      return false;
-    }
-  }
+  _init_event_pool();
 
   if (!_async_service_task_handle) {
     customTaskCreateUniversal(
@@ -402,48 +492,63 @@ static void _reset_tcp_callbacks(tcp_pcb *pcb, AsyncClient *client) {
 static int8_t _tcp_connected(void *arg, tcp_pcb *pcb, int8_t err) {
   // ets_printf("+C: 0x%08x\n", pcb);
   AsyncClient *client = reinterpret_cast<AsyncClient *>(arg);
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_CONNECTED, client};
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_CONNECTED, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
+    _drop_event(LWIP_TCP_CONNECTED);
     return ERR_MEM;
   }
   e->connected.pcb = pcb;
   e->connected.err = err;
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (!_send_async_event(e)) {
+    _drop_event(LWIP_TCP_CONNECTED);
+    return ERR_MEM;
+  }
   return ERR_OK;
 }
 
 int8_t AsyncTCP_detail::tcp_poll(void *arg, struct tcp_pcb *pcb) {
+  // ets_printf("+P: 0x%08x\n", pcb);
+  AsyncClient *client = reinterpret_cast<AsyncClient *>(arg);
+  if (client && client->_poll_queued) {
+    // the previous poll for this connection has not run yet, one is enough
+    _counter_inc(_queue_counters.poll_coalesced);
+    return ERR_OK;
+  }
   // throttle polling events queueing when event queue is getting filled up, let it handle _onack's
-  {
-    queue_mutex_guard guard;
-    // log_d("qs:%u", _async_queue.size());
-    if (_async_queue.size() > (rand() % CONFIG_ASYNC_TCP_QUEUE_SIZE / 2 + CONFIG_ASYNC_TCP_QUEUE_SIZE / 4)) {
-      log_d("throttling");
-      return ERR_OK;
-    }
+  if (_async_queue.size() >= CONFIG_ASYNC_TCP_POLL_SHED_DEPTH) {
+    _counter_inc(_queue_counters.poll_shed);
+    return ERR_OK;
   }
 
-  // ets_printf("+P: 0x%08x\n", pcb);
-  AsyncClient *client = reinterpret_cast<AsyncClient *>(arg);
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_POLL, client};
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_POLL, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
-    return ERR_MEM;
+    _counter_inc(_queue_counters.poll_shed);
+    return ERR_OK;
   }
   e->poll.pcb = pcb;
-
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (client) {
+    client->_poll_queued = true;
+  }
+  if (!_send_async_event(e)) {
+    if (client) {
+      client->_poll_queued = false;
+    }
+    _counter_inc(_queue_counters.poll_shed);
+  }
   return ERR_OK;
 }
 
 int8_t AsyncTCP_detail::tcp_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *pb, int8_t err) {
   AsyncClient *client = reinterpret_cast<AsyncClient *>(arg);
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_RECV, client};
+  // data may only use the ring up to the control reserve; a FIN may take any free slot
+  if (_async_queue.size() >= (pb ? ASYNC_TCP_DATA_LIMIT : ASYNC_TCP_RING_SIZE)) {
+    // LwIP holds on to refused data (and FIN) and delivers it again from its timer
+    _counter_inc(_queue_counters.recv_deferred);
+    return ERR_MEM;
+  }
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_RECV, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
+    _counter_inc(_queue_counters.recv_deferred);
     return ERR_MEM;
   }
   if (pb) {
@@ -460,24 +565,32 @@ int8_t AsyncTCP_detail::tcp_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *pb
     client->_lwip_fin(e->fin.pcb, e->fin.err);
   }
 
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (!_send_async_event(e)) {
+    if (pb) {
+      _counter_inc(_queue_counters.recv_deferred);
+      return ERR_MEM;
+    }
+    // the PCB is already closed, the FIN can not be refused any more
+    _drop_event(LWIP_TCP_FIN);
+  }
   return ERR_OK;
 }
 
 int8_t AsyncTCP_detail::tcp_sent(void *arg, struct tcp_pcb *pcb, uint16_t len) {
   // ets_printf("+S: 0x%08x\n", pcb);
   AsyncClient *client = reinterpret_cast<AsyncClient *>(arg);
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_SENT, client};
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_SENT, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
+    _drop_event(LWIP_TCP_SENT);
     return ERR_MEM;
   }
   e->sent.pcb = pcb;
   e->sent.len = len;
 
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (!_send_async_event(e)) {
+    _drop_event(LWIP_TCP_SENT);
+    return ERR_MEM;
+  }
   return ERR_OK;
 }
 
@@ -491,24 +604,25 @@ void AsyncTCP_detail::tcp_error(void *arg, int8_t err) {
   }
 
   // enqueue event to be processed in the async task for the user callback
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_ERROR, client};
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_ERROR, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
+    _drop_event(LWIP_TCP_ERROR);
     return;
   }
   e->error.err = err;
 
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (!_send_async_event(e)) {
+    _drop_event(LWIP_TCP_ERROR);
+  }
 }
 
 static void _tcp_dns_found(const char *name, ip_addr_t *ipaddr, void *arg) {
   // ets_printf("+DNS: name=%s ipaddr=0x%08x arg=%x\n", name, ipaddr, arg);
   auto client = reinterpret_cast<AsyncClient *>(arg);
 
-  lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_DNS, client};
+  lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_DNS, client);
   if (!e) {
-    log_e("Failed to allocate event packet");
+    _drop_event(LWIP_TCP_DNS);
     return;
   }
 
@@ -519,8 +633,9 @@ static void _tcp_dns_found(const char *name, ip_addr_t *ipaddr, void *arg) {
     memset(&e->dns.addr, 0, sizeof(e->dns.addr));
   }
 
-  queue_mutex_guard guard;
-  _send_async_event(e);
+  if (!_send_async_event(e)) {
+    _drop_event(LWIP_TCP_DNS);
+  }
 }
 
 /*
@@ -747,7 +862,8 @@ static tcp_pcb *_tcp_listen_with_backlog(tcp_pcb *pcb, uint8_t backlog) {
 AsyncClient::AsyncClient(tcp_pcb *pcb)
   : _connect_cb(0), _connect_cb_arg(0), _discard_cb(0), _discard_cb_arg(0), _sent_cb(0), _sent_cb_arg(0), _error_cb(0), _error_cb_arg(0), _recv_cb(0),
     _recv_cb_arg(0), _pb_cb(0), _pb_cb_arg(0), _timeout_cb(0), _timeout_cb_arg(0), _poll_cb(0), _poll_cb_arg(0), _ack_pcb(true), _tx_last_packet(0),
-    _rx_timeout(0), _rx_last_ack(0), _ack_timeout(CONFIG_ASYNC_TCP_MAX_ACK_TIME), _connect_port(0) {
+    _rx_timeout(0), _rx_last_ack(0), _ack_timeout(CONFIG_ASYNC_TCP_MAX_ACK_TIME), _connect_port(0),
+    _poll_queued(false) {
   _pcb = pcb;
   if (_pcb) {
     _rx_last_packet = millis();
@@ -1545,16 +1661,18 @@ int8_t AsyncTCP_detail::tcp_accept(void *arg, tcp_pcb *pcb, int8_t err) {
     if (c && c->pcb()) {
       c->setNoDelay(server->_noDelay);
 
-      lwip_tcp_event_packet_t *e = new (std::nothrow) lwip_tcp_event_packet_t{LWIP_TCP_ACCEPT, c};
+      lwip_tcp_event_packet_t *e = _alloc_event(LWIP_TCP_ACCEPT, c);
       if (e) {
         e->accept.server = server;
 
-        queue_mutex_guard guard;
-        _prepend_async_event(e);
-        return ERR_OK;  // success
+        // FIFO ring: the accept is handled after the events already queued
+        if (_send_async_event(e)) {
+          return ERR_OK;  // success
+        }
       }
 
-      // Couldn't allocate accept event
+      // Couldn't queue accept event
+      _drop_event(LWIP_TCP_ACCEPT);
       // We can't let the client object call in to close, as we're on the LWIP thread; it could deadlock trying to RPC to itself
       c->_pcb = nullptr;
       tcp_abort(pcb);
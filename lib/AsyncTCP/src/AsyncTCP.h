@@ -62,6 +62,36 @@ extern "C" {
 #define CONFIG_ASYNC_TCP_MAX_ACK_TIME 5000
 #endif
 
+// POLL events are shed once the event queue holds this many entries
+#ifndef CONFIG_ASYNC_TCP_POLL_SHED_DEPTH
+#define CONFIG_ASYNC_TCP_POLL_SHED_DEPTH (CONFIG_ASYNC_TCP_QUEUE_SIZE / 2)
+#endif
+
+// Slots kept free for SENT/ERROR/FIN/ACCEPT/CONNECTED/DNS; RECV is deferred back to LwIP beyond that
+#ifndef CONFIG_ASYNC_TCP_CTRL_RESERVE
+#define CONFIG_ASYNC_TCP_CTRL_RESERVE 8
+#endif
+
+// Event queue counters, read with asyncTcpQueueStats()
+struct async_tcp_queue_stats_t {
+  uint32_t depth;           // events currently queued
+  uint32_t high_water;      // max depth since boot
+  uint32_t capacity;        // ring slots
+  uint32_t enqueued;        // events accepted into the queue
+  uint32_t poll_coalesced;  // POLL skipped because one was already queued for the client
+  uint32_t poll_shed;       // POLL skipped because depth >= CONFIG_ASYNC_TCP_POLL_SHED_DEPTH
+  uint32_t recv_deferred;   // RECV refused with ERR_MEM; LwIP keeps the pbuf and retries
+  uint32_t dropped;         // SENT/control events lost because the queue or pool was exhausted
+  uint32_t cancelled;       // events dropped by a client close/error before dispatch
+  uint32_t wait_avg_us;     // enqueue -> dispatch latency, exponential average
+  uint32_t wait_max_us;     // enqueue -> dispatch latency, max since boot
+  uint32_t pool_size;       // event packets in the static pool (never heap allocated)
+  uint32_t pool_used;       // packets currently queued or being dispatched
+  uint32_t pool_high_water; // max pool_used since boot
+};
+
+void asyncTcpQueueStats(async_tcp_queue_stats_t *stats);
+
 class AsyncClient;
 
 #define ASYNC_WRITE_FLAG_COPY 0x01  // will allocate new buffer to hold the data while sending (else will hold reference to the data given)
@@ -293,6 +323,7 @@ protected:
   uint32_t _rx_last_ack;
   uint32_t _ack_timeout;
   uint16_t _connect_port;
+  volatile bool _poll_queued;  // a POLL event for this client is already in the queue
 
   int8_t _close();
   int8_t _connected(tcp_pcb *pcb, int8_t err);
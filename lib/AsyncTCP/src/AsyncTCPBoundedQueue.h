@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+// Copyright 2016-2025 Hristo Gochkov, Mathieu Carbou, Emil Muratov
+
+// Bounded lock-free queue (Vyukov's sequence-numbered ring)
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+template<typename T, size_t N> class AsyncTCPBoundedQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "Queue capacity must be a power of two");
+
+public:
+  AsyncTCPBoundedQueue() : _enqueue_pos(0), _dequeue_pos(0) {
+    for (size_t i = 0; i < N; ++i) {
+      _cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  AsyncTCPBoundedQueue(const AsyncTCPBoundedQueue &) = delete;
+  AsyncTCPBoundedQueue &operator=(const AsyncTCPBoundedQueue &) = delete;
+
+  static constexpr size_t capacity() {
+    return N;
+  }
+
+  // Safe from any number of producers; returns false when full
+  bool push(const T &value) {
+    size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell_t &cell = _cells[pos & (N - 1)];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0) {
+        if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.value.store(value, std::memory_order_relaxed);
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = _enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Safe from any number of consumers; returns false when empty
+  bool pop(T &value) {
+    size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell_t &cell = _cells[pos & (N - 1)];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (dif == 0) {
+        if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          value = cell.value.load(std::memory_order_relaxed);
+          cell.seq.store(pos + N, std::memory_order_release);
+          return true;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = _dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Approximate while producers/consumers are running
+  size_t size() const {
+    size_t enq = _enqueue_pos.load(std::memory_order_acquire);
+    size_t deq = _dequeue_pos.load(std::memory_order_acquire);
+    return (enq > deq) ? (enq - deq) : 0;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // Visit published entries that have not been dequeued yet.
+  // Entries may be consumed while being visited; the callback must only flag them, never free them.
+  template<typename F> void for_each(F &&fn) const {
+    size_t deq = _dequeue_pos.load(std::memory_order_acquire);
+    size_t enq = _enqueue_pos.load(std::memory_order_acquire);
+    for (size_t pos = deq; pos != enq; ++pos) {
+      const cell_t &cell = _cells[pos & (N - 1)];
+      if (cell.seq.load(std::memory_order_acquire) != pos + 1) {
+        continue;
+      }
+      // seqlock read: the cell may be recycled by a producer meanwhile, keep the copy only if seq is unchanged
+      T value = cell.value.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (cell.seq.load(std::memory_order_relaxed) == pos + 1) {
+        fn(value);
+      }
+    }
+  }
+
+private:
+  struct cell_t {
+    std::atomic<size_t> seq;
+    std::atomic<T> value;  // relaxed; ordered by seq. Lets for_each() read it while a producer rewrites the cell
+  };
+
+  cell_t _cells[N];
+  std::atomic<size_t> _enqueue_pos;
+  std::atomic<size_t> _dequeue_pos;
+};
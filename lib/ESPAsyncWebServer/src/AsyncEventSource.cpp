@@ -357,8 +357,10 @@ void AsyncEventSource::_handleDisconnect(AsyncEventSourceClient* client) {
   std::lock_guard<std::mutex> lock(_client_queue_lock);
 #endif
   for (auto i = _clients.begin(); i != _clients.end(); ++i) {
-    if (i->get() == client)
+    if (i->get() == client) {
       _clients.erase(i);
+      break;
+    }
   }
   _adjust_inflight_window();
 }
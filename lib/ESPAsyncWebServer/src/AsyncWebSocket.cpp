@@ -77,12 +77,8 @@ size_t webSocketSendFrame(AsyncClient* client, bool final, uint8_t opcode, bool
   if (len > space)
     len = space;
 
-  uint8_t* buf = (uint8_t*)malloc(headLen);
-  if (buf == NULL) {
-    // os_printf("could not malloc %u bytes for frame header\n", headLen);
-    //  Serial.println("SF 3");
-    return 0;
-  }
+  // header is copied by AsyncClient::add(), no need for a heap allocation per frame
+  uint8_t buf[8];
 
   buf[0] = opcode & 0x0F;
   if (final)
@@ -100,11 +96,9 @@ size_t webSocketSendFrame(AsyncClient* client, bool final, uint8_t opcode, bool
   }
   if (client->add((const char*)buf, headLen) != headLen) {
     // os_printf("error adding %lu header bytes\n", headLen);
-    free(buf);
     // Serial.println("SF 4");
     return 0;
   }
-  free(buf);
 
   if (len) {
     if (len && mask) {
@@ -132,7 +126,7 @@ size_t webSocketSendFrame(AsyncClient* client, bool final, uint8_t opcode, bool
  */
 
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(const uint8_t* data, size_t size)
-    : _buffer(std::make_shared<std::vector<uint8_t>>(size)) {
+    : _buffer(makeWebSocketSharedBuffer(size)) {
   if (_buffer->capacity() < size) {
     _buffer->reserve(size);
   } else {
@@ -141,7 +135,7 @@ AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(const uint8_t* data, si
 }
 
 AsyncWebSocketMessageBuffer::AsyncWebSocketMessageBuffer(size_t size)
-    : _buffer(std::make_shared<std::vector<uint8_t>>(size)) {
+    : _buffer(makeWebSocketSharedBuffer(size)) {
   if (_buffer->capacity() < size) {
     _buffer->reserve(size);
   }
@@ -161,7 +155,7 @@ bool AsyncWebSocketMessageBuffer::reserve(size_t size) {
 class AsyncWebSocketControl {
   private:
     uint8_t _opcode;
-    uint8_t* _data;
+    uint8_t _data[125]; // control frame payloads are capped at 125 bytes (RFC 6455 5.5), keep them inline
     size_t _len;
     bool _mask;
     bool _finished;
@@ -171,23 +165,10 @@ class AsyncWebSocketControl {
         : _opcode(opcode), _len(len), _mask(len && mask), _finished(false) {
       if (data == NULL)
         _len = 0;
-      if (_len) {
-        if (_len > 125)
-          _len = 125;
-
-        _data = (uint8_t*)malloc(_len);
-
-        if (_data == NULL)
-          _len = 0;
-        else
-          memcpy(_data, data, len);
-      } else
-        _data = NULL;
-    }
-
-    ~AsyncWebSocketControl() {
-      if (_data != NULL)
-        free(_data);
+      if (_len > sizeof(_data))
+        _len = sizeof(_data);
+      if (_len)
+        memcpy(_data, data, _len);
     }
 
     bool finished() const { return _finished; }
@@ -195,7 +176,7 @@ class AsyncWebSocketControl {
     uint8_t len() { return _len + 2; }
     size_t send(AsyncClient* client) {
       _finished = true;
-      return webSocketSendFrame(client, true, _opcode & 0x0F, _mask, _data, _len);
+      return webSocketSendFrame(client, true, _opcode & 0x0F, _mask, _len ? _data : NULL, _len);
     }
 };
 
@@ -653,7 +634,7 @@ size_t AsyncWebSocketClient::printf_P(PGM_P formatP, ...) {
 
 namespace {
   AsyncWebSocketSharedBuffer makeSharedBuffer(const uint8_t* message, size_t len) {
-    auto buffer = std::make_shared<std::vector<uint8_t>>(len);
+    auto buffer = makeWebSocketSharedBuffer(len);
     std::memcpy(buffer->data(), message, len);
     return buffer;
   }
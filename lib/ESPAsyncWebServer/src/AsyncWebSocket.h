@@ -42,6 +42,8 @@
 
 #include <ESPAsyncWebServer.h>
 
+#include "AsyncWebSocketPool.h"
+
 #include <memory>
 
 #ifdef ESP8266
@@ -59,7 +61,13 @@
   #endif
 #endif
 
-using AsyncWebSocketSharedBuffer = std::shared_ptr<std::vector<uint8_t>>;
+using AsyncWebSocketBufferVector = std::vector<uint8_t, AsyncWebSocketPoolAllocator<uint8_t>>;
+using AsyncWebSocketSharedBuffer = std::shared_ptr<AsyncWebSocketBufferVector>;
+
+// buffer, vector header and shared_ptr control block all come from the slab pool
+inline AsyncWebSocketSharedBuffer makeWebSocketSharedBuffer(size_t len) {
+  return std::allocate_shared<AsyncWebSocketBufferVector>(AsyncWebSocketPoolAllocator<AsyncWebSocketBufferVector>(), len);
+}
 
 class AsyncWebSocket;
 class AsyncWebSocketResponse;
@@ -155,8 +163,8 @@ class AsyncWebSocketClient {
 #ifdef ESP32
     mutable std::mutex _lock;
 #endif
-    std::deque<AsyncWebSocketControl> _controlQueue;
-    std::deque<AsyncWebSocketMessage> _messageQueue;
+    std::deque<AsyncWebSocketControl, AsyncWebSocketPoolAllocator<AsyncWebSocketControl>> _controlQueue;
+    std::deque<AsyncWebSocketMessage, AsyncWebSocketPoolAllocator<AsyncWebSocketMessage>> _messageQueue;
     bool closeWhenFull = true;
 
     uint8_t _pstate;
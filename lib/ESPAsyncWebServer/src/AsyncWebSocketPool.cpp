@@ -0,0 +1,194 @@
+/*
+  Asynchronous WebServer library for Espressif MCUs
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "AsyncWebSocketPool.h"
+#include "Arduino.h"
+
+#include <cstdlib>
+
+#ifdef ESP32
+  #include <esp_heap_caps.h>
+  #include <freertos/FreeRTOS.h>
+#endif
+
+namespace {
+  constexpr size_t kClassBlock[] = {32, 128, 512, 2048, 4096};
+  constexpr uint16_t kClassSlots[] = WS_POOL_SLOTS;
+  constexpr size_t kClasses = sizeof(kClassBlock) / sizeof(kClassBlock[0]);
+  static_assert(sizeof(kClassSlots) / sizeof(kClassSlots[0]) == kClasses, "WS_POOL_SLOTS needs one count per size class");
+
+  struct FreeSlot {
+      FreeSlot* next;
+  };
+
+  struct SlabClass {
+      uint8_t* base;
+      FreeSlot* free;
+      size_t block;
+      uint16_t slots;
+      uint16_t used;
+      uint16_t highWater;
+      uint32_t fallback;
+      bool psram;
+  };
+
+  SlabClass slabs[kClasses];
+  uint32_t oversizeCount = 0;
+
+#ifdef ESP32
+  portMUX_TYPE slabMux = portMUX_INITIALIZER_UNLOCKED;
+  #define WS_POOL_LOCK()   portENTER_CRITICAL(&slabMux)
+  #define WS_POOL_UNLOCK() portEXIT_CRITICAL(&slabMux)
+#else
+  #define WS_POOL_LOCK()
+  #define WS_POOL_UNLOCK()
+#endif
+
+  void* storageAlloc(size_t bytes, bool& psram) {
+#ifdef ESP32
+    // only tasks touch these buffers (never ISRs or DMA: AsyncClient::add copies into lwIP pbufs), so PSRAM is safe
+    void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) {
+      psram = true;
+      return p;
+    }
+#endif
+    psram = false;
+    return malloc(bytes);
+  }
+
+  bool hasPsram() {
+#ifdef ESP32
+    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+#else
+    return false;
+#endif
+  }
+
+  bool init() {
+    const bool psram = hasPsram();
+    for (size_t i = 0; i < kClasses; i++) {
+      SlabClass& c = slabs[i];
+      c.block = kClassBlock[i];
+      c.slots = psram ? kClassSlots[i] : kClassSlots[i] / WS_POOL_INTERNAL_DIV;
+      c.free = nullptr;
+      c.base = c.slots ? static_cast<uint8_t*>(storageAlloc(c.block * c.slots, c.psram)) : nullptr;
+      if (!c.base) {
+        c.slots = 0;
+        continue;
+      }
+      for (size_t s = c.slots; s-- > 0;) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(c.base + s * c.block);
+        slot->next = c.free;
+        c.free = slot;
+      }
+    }
+    return true;
+  }
+
+  void ensureInit() {
+    static bool ready = init();
+    (void)ready;
+  }
+
+  SlabClass* classFor(size_t size) {
+    for (SlabClass& c : slabs) {
+      if (size <= c.block)
+        return &c;
+    }
+    return nullptr;
+  }
+
+  SlabClass* owner(void* ptr) {
+    uint8_t* p = static_cast<uint8_t*>(ptr);
+    for (SlabClass& c : slabs) {
+      if (c.base && p >= c.base && p < c.base + c.block * c.slots)
+        return &c;
+    }
+    return nullptr;
+  }
+} // namespace
+
+namespace AsyncWebSocketPool {
+  void* allocate(size_t size) {
+    ensureInit();
+    SlabClass* c = classFor(size ? size : 1);
+    if (c) {
+      WS_POOL_LOCK();
+      FreeSlot* slot = c->free;
+      if (slot) {
+        c->free = slot->next;
+        if (++c->used > c->highWater)
+          c->highWater = c->used;
+      } else {
+        c->fallback++;
+      }
+      WS_POOL_UNLOCK();
+      if (slot)
+        return slot;
+    } else {
+      WS_POOL_LOCK();
+      oversizeCount++;
+      WS_POOL_UNLOCK();
+    }
+    return malloc(size ? size : 1);
+  }
+
+  void deallocate(void* ptr, size_t size) {
+    (void)size;
+    if (!ptr)
+      return;
+    SlabClass* c = owner(ptr);
+    if (!c) {
+      free(ptr);
+      return;
+    }
+    FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+    WS_POOL_LOCK();
+    slot->next = c->free;
+    c->free = slot;
+    c->used--;
+    WS_POOL_UNLOCK();
+  }
+
+  size_t classCount() {
+    return kClasses;
+  }
+
+  bool stats(size_t index, AsyncWebSocketPoolStats* out) {
+    if (index >= kClasses || !out)
+      return false;
+    ensureInit();
+    WS_POOL_LOCK();
+    const SlabClass& c = slabs[index];
+    out->block = c.block;
+    out->slots = c.slots;
+    out->used = c.used;
+    out->highWater = c.highWater;
+    out->fallback = c.fallback;
+    out->psram = c.psram;
+    WS_POOL_UNLOCK();
+    return true;
+  }
+
+  uint32_t oversize() {
+    return oversizeCount;
+  }
+} // namespace AsyncWebSocketPool
@@ -0,0 +1,91 @@
+/*
+  Asynchronous WebServer library for Espressif MCUs
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#ifndef ASYNCWEBSOCKETPOOL_H_
+#define ASYNCWEBSOCKETPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <new>
+
+/*
+ * Fixed-size slab pools for WebSocket message buffers, their shared_ptr control
+ * blocks and the per-client message/control queues.
+ *
+ * Each size class is one contiguous block carved out once at first use (PSRAM when
+ * the board has it, internal RAM with fewer slots otherwise), so steady-state
+ * traffic does not fragment the heap. Requests larger than the biggest class, or
+ * made while a class is exhausted, fall back to the heap and are counted.
+ */
+
+// slots per class when PSRAM is available: 32, 128, 512, 2048, 4096 bytes
+#ifndef WS_POOL_SLOTS
+  #define WS_POOL_SLOTS {128, 64, 48, 32, 16}
+#endif
+
+// without PSRAM the slot counts are divided by this
+#ifndef WS_POOL_INTERNAL_DIV
+  #define WS_POOL_INTERNAL_DIV 8
+#endif
+
+struct AsyncWebSocketPoolStats {
+    size_t block;        // slot size in bytes
+    uint16_t slots;      // slot count
+    uint16_t used;       // slots in use
+    uint16_t highWater;  // max slots in use since boot
+    uint32_t fallback;   // requests of this class served by the heap
+    bool psram;          // class storage lives in PSRAM
+};
+
+namespace AsyncWebSocketPool {
+  void* allocate(size_t size);
+  void deallocate(void* ptr, size_t size);
+
+  size_t classCount();
+  bool stats(size_t index, AsyncWebSocketPoolStats* out);
+  // heap fallbacks for requests larger than every class
+  uint32_t oversize();
+} // namespace AsyncWebSocketPool
+
+template <typename T>
+class AsyncWebSocketPoolAllocator {
+  public:
+    using value_type = T;
+
+    AsyncWebSocketPoolAllocator() noexcept = default;
+    template <typename U>
+    AsyncWebSocketPoolAllocator(const AsyncWebSocketPoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+      void* p = AsyncWebSocketPool::allocate(n * sizeof(T));
+      if (!p)
+        throw std::bad_alloc();
+      return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t n) noexcept { AsyncWebSocketPool::deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const AsyncWebSocketPoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AsyncWebSocketPoolAllocator<U>&) const noexcept { return false; }
+};
+
+#endif /* ASYNCWEBSOCKETPOOL_H_ */
@@ -24,7 +24,7 @@ void MPU6050::begin(){
   angleGyroY = 0;
   angleX = this->getAccAngleX();
   angleY = this->getAccAngleY();
-  preInterval = millis();
+  preInterval = micros();
 }
 
 void MPU6050::writeMPU6050(byte reg, byte data){
@@ -93,11 +93,18 @@ void MPU6050::calcGyroOffsets(bool console, uint16_t delayBefore, uint16_t delay
 	}
 }
 
-void MPU6050::update(){
+bool MPU6050::update(){
 	wire->beginTransmission(MPU6050_ADDR);
 	wire->write(0x3B);
-	wire->endTransmission(false);
-	wire->requestFrom((int)MPU6050_ADDR, 14);
+	if (wire->endTransmission(false) != 0) {
+		return false;
+	}
+	if (wire->requestFrom((int)MPU6050_ADDR, 14) != 14) {
+		while (wire->available()) {
+			wire->read();
+		}
+		return false;
+	}
 
   rawAccX = wire->read() << 8 | wire->read();
   rawAccY = wire->read() << 8 | wire->read();
@@ -124,7 +131,8 @@ void MPU6050::update(){
   gyroY -= gyroYoffset;
   gyroZ -= gyroZoffset;
 
-  interval = (millis() - preInterval) * 0.001;
+  const uint32_t nowInterval = micros();
+  interval = (nowInterval - preInterval) * 1e-6f;
 
   angleGyroX += gyroX * interval;
   angleGyroY += gyroY * interval;
@@ -134,6 +142,6 @@ void MPU6050::update(){
   angleY = (gyroCoef * (angleY + gyroY * interval)) + (accCoef * angleAccY);
   angleZ = angleGyroZ;
 
-  preInterval = millis();
-
+  preInterval = nowInterval;
+  return true;
 }
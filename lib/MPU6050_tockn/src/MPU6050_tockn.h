@@ -53,7 +53,7 @@ class MPU6050{
   float getGyroYoffset(){ return gyroYoffset; };
   float getGyroZoffset(){ return gyroZoffset; };
 
-  void update();
+  bool update(); // 返回 false 表示本次 I2C 读取失败，内部状态保持上一帧
 
   float getAccAngleX(){ return angleAccX; };
   float getAccAngleY(){ return angleAccY; };
@@ -83,7 +83,7 @@ class MPU6050{
   float angleX, angleY, angleZ;
 
   float interval;
-  long preInterval;
+  uint32_t preInterval;
 
   float accCoef, gyroCoef;
 };
@@ -6,16 +6,22 @@
 #include "my_config.h"
 #include "my_rgb.h"
 #include "my_bat.h"
+#include "my_safety.h"
+#include "my_supervisor.h"
+#include "my_diag.h"
+#include "my_trace.h"
 
 static TaskHandle_t control_TaskHandle = nullptr;   // 运动控制
 static TaskHandle_t data_send_TaskHandle = nullptr; // 网页任务
 static TaskHandle_t screen_TaskHandle = nullptr; // 屏幕刷新任务
 static TaskHandle_t rgb_TaskHandle = nullptr; // RGB任务
+static TaskHandle_t bat_TaskHandle = nullptr; // 电池采样任务
 // put function declarations here:
 void robot_control_Task(void *)
 {
     for (;;)
     {
+        safety_beat(SAFETY_TASK_CTRL);
         my_motion_update();
         vTaskDelay(pdMS_TO_TICKS(robot.dt_ms));
     }
@@ -25,8 +31,9 @@ void data_send_Task(void *)
 {
     for (;;)
     {
+        safety_beat(SAFETY_TASK_TELEM);
         my_web_data_update();
-        vTaskDelay(pdMS_TO_TICKS(robot.data_ms));
+        vTaskDelay(pdMS_TO_TICKS(TELEM_TICK_MS));
     }
 }
 
@@ -34,15 +41,26 @@ void screen_Task(void *)
 {
     for (;;)
     {
+        safety_beat(SAFETY_TASK_SCREEN);
         my_screen_update();
         vTaskDelay(pdMS_TO_TICKS(SCREEN_REFRESH_TIME));
     }
 }
 
+void bat_Task(void *)
+{
+    for (;;)
+    {
+        my_bat_update();
+        vTaskDelay(pdMS_TO_TICKS(BAT_SAMPLE_MS));
+    }
+}
+
 void rgb_Task(void *)
 {
     for (;;)
     {
+        safety_beat(SAFETY_TASK_RGB);
         my_rgb_update();
         vTaskDelay(pdMS_TO_TICKS(20));
     }
@@ -51,6 +69,10 @@ void rgb_Task(void *)
 void setup() {
   //串口初始化
   Serial.begin(115200);
+#if MY_TRACE_ENABLE
+  //事件追踪（构建时开启才存在）
+  trace_arm();
+#endif
   //I2C初始化
   my_i2c_init();
   //wifi初始化
@@ -65,16 +87,30 @@ void setup() {
   my_screen_init();
   //RGB初始化
   my_rgb_init();
+  //安全监控（心跳 + 硬件定时器切断 + 任务看门狗）
+  my_safety_init();
 
 
   xTaskCreatePinnedToCore(robot_control_Task, "ctrl_2ms", 8192, nullptr, 15, &control_TaskHandle, 0); // 初始化运动任务
+  safety_register_ctrl(control_TaskHandle);
   xTaskCreatePinnedToCore(data_send_Task, "telem", 8192, nullptr, 5, &data_send_TaskHandle, 1);
   // 屏幕刷新放低优先级，避免阻塞网络/灯效任务
   xTaskCreatePinnedToCore(screen_Task, "screen", 8192, nullptr, 3, &screen_TaskHandle, 1);
   xTaskCreatePinnedToCore(rgb_Task, "rgb", 2048, nullptr, 4, &rgb_TaskHandle, 1);
+  xTaskCreatePinnedToCore(bat_Task, "bat", 2048, nullptr, 2, &bat_TaskHandle, 1);
+  // 诊断采样（core 1）；登记的句柄在未开启 trace facility 时作为采样名单
+  diag_register_task(control_TaskHandle);
+  diag_register_task(data_send_TaskHandle);
+  diag_register_task(screen_TaskHandle);
+  diag_register_task(rgb_TaskHandle);
+  diag_register_task(bat_TaskHandle);
+  my_diag_init();
 
 }
 
 void loop() {
-  // put your main code here, to run repeatedly:
+  // loopTask 在 core 1 且优先级最低：控制路径只置标志/写环形日志，串口输出集中在这里
+  safety_log_poll();
+  supervisor_log_poll();
+  delay(50);
 }
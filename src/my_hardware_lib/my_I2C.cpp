@@ -5,17 +5,143 @@
 
 TwoWire ScreenWire = TwoWire(1);
 
-void my_i2c_init()
+const uint32_t I2C_HIST_EDGES_US[I2C_HIST_BINS - 1] = {250, 500, 1000, 2000, 5000, 10000, 50000};
+
+namespace
 {
-    Wire.begin(I2C0_SDA, I2C0_SCL, I2C_FREQUENCY);
-    ScreenWire.begin(SCREEN_SDA_PIN, SCREEN_SCL_PIN, I2C_FREQUENCY);
+    struct bus_cfg
+    {
+        TwoWire *wire;
+        i2c_port_t port;
+        int sda;
+        int scl;
+        uint16_t timeout_ms;
+    };
+
+    const bus_cfg BUS[I2C_BUS_COUNT] = {
+        {&Wire, I2C_NUM_0, I2C0_SDA, I2C0_SCL, I2C_IMU_TIMEOUT_MS},
+        {&ScreenWire, I2C_NUM_1, SCREEN_SDA_PIN, SCREEN_SCL_PIN, I2C_SCREEN_TIMEOUT_MS},
+    };
+
+    i2c_bus_stats stats[I2C_BUS_COUNT] = {};
 
-    const int scl_timeout = 1 << 19;
-    i2c_set_timeout(I2C_NUM_0, scl_timeout);
-    i2c_set_timeout(I2C_NUM_1, scl_timeout);
+    // 恢复要 end/begin 驱动并软件打时钟，耗时不定，不能放在 2ms 控制任务里
+    TaskHandle_t recover_handle = nullptr;
+    uint32_t recover_pending = 0; // 按总线的位掩码；请求方置位，恢复完成后清除
 
-    Wire.setTimeOut(100);
-    ScreenWire.setTimeOut(100);
+    void recover_Task(void *)
+    {
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            const uint32_t pending = __atomic_load_n(&recover_pending, __ATOMIC_ACQUIRE);
+            for (uint8_t bus = 0; bus < I2C_BUS_COUNT; ++bus)
+            {
+                if (!(pending & (1u << bus)))
+                    continue;
+                my_i2c_recover(bus);
+                __atomic_fetch_and(&recover_pending, ~(1u << bus), __ATOMIC_RELEASE);
+            }
+        }
+    }
+
+    void bus_begin(const bus_cfg &b)
+    {
+        b.wire->begin(b.sda, b.scl, I2C_FREQUENCY);
+        i2c_set_timeout(b.port, I2C_SCL_TIMEOUT_EXP);
+        b.wire->setTimeOut(b.timeout_ms);
+    }
+}
+
+void my_i2c_init()
+{
+    for (const bus_cfg &b : BUS)
+        bus_begin(b);
+    static_assert(I2C_RECOVER_CORE != 0, "bus recovery must not run on the control core");
+    xTaskCreatePinnedToCore(recover_Task, "i2c_recover", I2C_RECOVER_STACK, nullptr, I2C_RECOVER_PRIO, &recover_handle, I2C_RECOVER_CORE);
 
     Serial.println("I2C初始化完成 (总线0: IMU等, 总线1: OLED)");
 }
+
+void my_i2c_record(uint8_t bus, uint32_t us, bool ok)
+{
+    if (bus >= I2C_BUS_COUNT)
+        return;
+    i2c_bus_stats &s = stats[bus];
+    if (ok)
+        s.ok++;
+    else
+        s.err++;
+    s.last_us = us;
+    if (us > s.max_us)
+        s.max_us = us;
+    uint8_t bin = 0;
+    while (bin < I2C_HIST_BINS - 1 && us >= I2C_HIST_EDGES_US[bin])
+        bin++;
+    s.hist[bin]++;
+}
+
+bool my_i2c_recover(uint8_t bus)
+{
+    if (bus >= I2C_BUS_COUNT)
+        return false;
+    const bus_cfg &b = BUS[bus];
+    b.wire->end();
+
+    // 最多 9 个 SCL 脉冲，让卡在字节中间的从机把 SDA 放开
+    pinMode(b.sda, INPUT_PULLUP);
+    pinMode(b.scl, OUTPUT_OPEN_DRAIN);
+    for (int i = 0; i < 9 && digitalRead(b.sda) == LOW; ++i)
+    {
+        digitalWrite(b.scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(b.scl, HIGH);
+        delayMicroseconds(5);
+    }
+    // 手动产生 STOP：SCL 高时 SDA 由低变高
+    pinMode(b.sda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(b.sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(b.scl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(b.sda, HIGH);
+    delayMicroseconds(5);
+    const bool released = digitalRead(b.sda) == HIGH;
+
+    bus_begin(b);
+    stats[bus].recoveries++;
+    return released;
+}
+
+void my_i2c_recover_async(uint8_t bus)
+{
+    if (bus >= I2C_BUS_COUNT || !recover_handle)
+        return;
+    const uint32_t bit = 1u << bus;
+    if (__atomic_fetch_or(&recover_pending, bit, __ATOMIC_ACQ_REL) & bit)
+        return; // 已在排队
+    xTaskNotifyGive(recover_handle);
+}
+
+bool my_i2c_recovering(uint8_t bus)
+{
+    return bus < I2C_BUS_COUNT && (__atomic_load_n(&recover_pending, __ATOMIC_ACQUIRE) & (1u << bus));
+}
+
+void i2c_write_stats(JsonObject obj)
+{
+    static const char *const NAMES[I2C_BUS_COUNT] = {"imu", "screen"};
+    for (int i = 0; i < I2C_BUS_COUNT; ++i)
+    {
+        const i2c_bus_stats &s = stats[i];
+        JsonObject o = obj[NAMES[i]].to<JsonObject>();
+        o["ok"] = s.ok;
+        o["err"] = s.err;
+        o["recover"] = s.recoveries;
+        o["last_us"] = s.last_us;
+        o["max_us"] = s.max_us;
+        JsonArray h = o["hist"].to<JsonArray>();
+        for (uint32_t n : s.hist)
+            h.add(n);
+    }
+}
@@ -1,7 +1,12 @@
 #include <Arduino.h>
+#include <algorithm>
 #include "esp_adc_cal.h"
+#include "driver/adc.h"
 #include "my_bat.h"
 #include "my_config.h"
+#include "my_motion.h"
+#include "my_pid.h"
+#include "my_trace.h"
 
 // 电压检测相关变量定义
 static esp_adc_cal_characteristics_t adc_chars; 
@@ -11,6 +16,143 @@ static const adc_atten_t atten = ADC_ATTEN_DB_12;
 static const adc_unit_t unit = ADC_UNIT_1;              
 float battery_voltage = 12.0; 
 
+namespace
+{
+    constexpr size_t MAX_SAMPLES = BAT_DMA_FRAME / SOC_ADC_DIGI_RESULT_BYTES;
+    // 驱动存储区容纳两个读取周期的数据，任务偶尔被推迟也不会溢出
+    constexpr size_t DMA_STORE = BAT_ADC_FREQ_HZ * SOC_ADC_DIGI_RESULT_BYTES * BAT_SAMPLE_MS * 2 / 1000;
+    constexpr size_t DMA_MAX_READS = DMA_STORE / BAT_DMA_FRAME + 2; // 单次读取的帧数上限，防止追着生产者读不停
+    static_assert(DMA_STORE >= BAT_DMA_FRAME * 2, "battery ADC store must hold at least two frames");
+
+    // 锂电池单节开路电压-电量曲线
+    constexpr float SOC_CURVE_V[] = {3.27f, 3.61f, 3.69f, 3.71f, 3.73f, 3.77f, 3.79f, 3.82f, 3.87f, 3.93f, 4.03f, 4.20f};
+    constexpr float SOC_CURVE_P[] = {0.00f, 0.05f, 0.10f, 0.20f, 0.30f, 0.40f, 0.50f, 0.60f, 0.70f, 0.80f, 0.90f, 1.00f};
+    constexpr int SOC_POINTS = sizeof(SOC_CURVE_V) / sizeof(SOC_CURVE_V[0]);
+
+    bool dma_ready = false;
+    uint8_t dma_buf[BAT_DMA_FRAME];
+    uint16_t samples[MAX_SAMPLES];
+
+    LowPassFilter v_filter(BAT_IIR_TAU);
+    LowPassFilter slope_filter(BAT_TREND_TAU);
+    uint32_t last_us = 0;
+    uint32_t trend_ms = 0;
+    float trend_ocv = 0.0f;
+
+    bool dma_init()
+    {
+        adc_digi_init_config_t init_cfg = {};
+        init_cfg.max_store_buf_size = DMA_STORE;
+        init_cfg.conv_num_each_intr = BAT_DMA_FRAME;
+        init_cfg.adc1_chan_mask = BIT(channel);
+        init_cfg.adc2_chan_mask = 0;
+        if (adc_digi_initialize(&init_cfg) != ESP_OK)
+            return false;
+
+        adc_digi_pattern_config_t pattern = {};
+        pattern.atten = atten;
+        pattern.channel = channel;
+        pattern.unit = 0; // ADC1
+        pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+        adc_digi_configuration_t dig_cfg = {};
+        dig_cfg.conv_limit_en = false;
+        dig_cfg.conv_limit_num = 250;
+        dig_cfg.pattern_num = 1;
+        dig_cfg.adc_pattern = &pattern;
+        dig_cfg.sample_freq_hz = BAT_ADC_FREQ_HZ;
+        dig_cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        dig_cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+        if (adc_digi_controller_configure(&dig_cfg) != ESP_OK)
+        {
+            adc_digi_deinitialize();
+            return false;
+        }
+        return adc_digi_start() == ESP_OK;
+    }
+
+    // 读空 DMA 中积累的采样，只保留最新的 MAX_SAMPLES 个，返回样本数
+    size_t dma_collect()
+    {
+        size_t total = 0;
+        uint32_t got = 0;
+        for (size_t r = 0; r < DMA_MAX_READS; ++r)
+        {
+            // ESP_ERR_INVALID_STATE 表示存储区曾溢出，本次仍读出了数据，继续读到最新
+            const esp_err_t err = adc_digi_read_bytes(dma_buf, sizeof(dma_buf), &got, 0);
+            if ((err != ESP_OK && err != ESP_ERR_INVALID_STATE) || got == 0)
+                break;
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES)
+            {
+                const adc_digi_output_data_t *p = reinterpret_cast<const adc_digi_output_data_t *>(&dma_buf[i]);
+                if (p->type2.channel == channel)
+                    samples[total++ % MAX_SAMPLES] = p->type2.data; // 中值与顺序无关，环形覆盖即可
+            }
+        }
+        return std::min(total, MAX_SAMPLES);
+    }
+
+    // DMA 不可用时退化为单次采样的过采样
+    size_t oneshot_collect()
+    {
+        constexpr size_t N = 16;
+        for (size_t i = 0; i < N; ++i)
+            samples[i] = static_cast<uint16_t>(adc1_get_raw(channel));
+        return N;
+    }
+
+    void update_model(float v_raw, float dt_s)
+    {
+        bat_state &b = robot.bat;
+        b.v_raw = v_raw;
+        b.v = v_filter.apply(v_raw, dt_s);
+
+        // 负载补偿：端电压 + 估计电流 x 内阻
+        const float duty = 0.5f * (fabsf(robot.motor.L_cmd) + fabsf(robot.motor.R_cmd));
+        b.current = BAT_I_FULL_A * duty;
+        b.ocv = b.v + b.current * BAT_R_INT_OHM;
+        b.soc = bat_soc_from_cell(b.ocv / BAT_CELLS);
+
+        // 放电趋势：每秒取一次开路电压差分，再做长时间常数低通
+        const uint32_t now_ms = millis();
+        if (trend_ms == 0)
+        {
+            trend_ms = now_ms;
+            trend_ocv = b.ocv;
+        }
+        else if (now_ms - trend_ms >= 1000)
+        {
+            const float span_s = (now_ms - trend_ms) * 0.001f;
+            b.slope = slope_filter.apply((b.ocv - trend_ocv) / span_s, span_s);
+            trend_ms = now_ms;
+            trend_ocv = b.ocv;
+        }
+        b.t_empty_s = b.slope < -1e-4f ? (b.ocv - BAT_CUTOFF_V) / -b.slope : -1.0f;
+
+        b.low = b.ocv < BAT_LOW_V;
+        b.brownout = b.ocv - BAT_I_FULL_A * BAT_R_INT_OHM < BAT_CUTOFF_V;
+        // 电压不可信时（未接电池、滤波器刚由异常值初始化）补偿保持 1，避免按 0 V 放大到上限
+        const bool plausible = b.v_raw >= BAT_V_VALID_MIN && b.v >= BAT_V_VALID_MIN;
+        b.comp = plausible ? constrain(BAT_NOMINAL_V / b.v, BAT_COMP_MIN, BAT_COMP_MAX) : 1.0f;
+        battery_voltage = b.v;
+    }
+}
+
+float bat_soc_from_cell(float cell_v)
+{
+    if (cell_v <= SOC_CURVE_V[0])
+        return 0.0f;
+    for (int i = 1; i < SOC_POINTS; ++i)
+    {
+        if (cell_v < SOC_CURVE_V[i])
+        {
+            const float t = (cell_v - SOC_CURVE_V[i - 1]) / (SOC_CURVE_V[i] - SOC_CURVE_V[i - 1]);
+            return SOC_CURVE_P[i - 1] + t * (SOC_CURVE_P[i] - SOC_CURVE_P[i - 1]);
+        }
+    }
+    return 1.0f;
+}
+
 void my_bat_init() 
 {
     // 检查eFuse中是否支持两点校准电压
@@ -25,20 +167,45 @@ void my_bat_init()
     else
         Serial.println("eFuse Vref: NOT supported\n");
     
-    // 配置ADC1的采样宽度为12位
-    adc1_config_width(width);
-    // 配置ADC1通道的衰减级别为12dB
-    adc1_config_channel_atten(channel, atten);
     // 根据硬件参数对ADC进行校准，存储校准参数到adc_chars
     esp_adc_cal_characterize(unit, atten, width, 0, &adc_chars);
+
+    // 优先使用连续采样（DMA），失败时退化为单次采样
+    dma_ready = dma_init();
+    if (!dma_ready)
+    {
+        adc1_config_width(width);
+        adc1_config_channel_atten(channel, atten);
+        Serial.println("电池ADC连续采样初始化失败，使用单次采样");
+    }
 }
 
 void my_bat_update() 
 {
-    uint32_t sum = 0;
-    sum = analogRead(BAT_PIN);   // 从BAT_PIN(GPIO3)读取ADC原始值
-    uint32_t voltage = esp_adc_cal_raw_to_voltage(sum, &adc_chars); // 将ADC原始值转换为毫伏(mV)电压值
-    battery_voltage = voltage * 4 / 1000.0;
-}
+    TRACE_SCOPE(BAT);
+    const size_t n = dma_ready ? dma_collect() : oneshot_collect();
+    if (n == 0)
+        return;
+
+    // 中值滤除电机 PWM 带来的尖峰
+    std::nth_element(samples, samples + n / 2, samples + n);
+    const uint32_t mv = esp_adc_cal_raw_to_voltage(samples[n / 2], &adc_chars); // 将ADC原始值转换为毫伏(mV)电压值
 
+    const uint32_t now_us = micros();
+    const float dt_s = last_us ? (now_us - last_us) * 1e-6f : 0.0f;
+    last_us = now_us;
+    update_model(mv * BAT_DIVIDER / 1000.0f, dt_s);
+}
 
+void bat_write_state(JsonObject obj)
+{
+    const bat_state &b = robot.bat;
+    obj["v"] = b.v;
+    obj["ocv"] = b.ocv;
+    obj["i"] = b.current;
+    obj["soc"] = b.soc;
+    obj["t_empty"] = b.t_empty_s;
+    obj["comp"] = b.comp;
+    obj["low"] = b.low;
+    obj["bo"] = b.brownout;
+}
@@ -0,0 +1,307 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include "my_diag.h"
+#include "my_config.h"
+#include "my_cpu_load.h"
+
+namespace
+{
+    constexpr uint8_t DIAG_BIN_VER = 2;
+    constexpr size_t DIAG_BIN_NAME = 16;
+    static_assert(DIAG_BIN_TASK == DIAG_BIN_NAME + 4 + 4 + DIAG_CPU_WINDOWS * 2 + 2, "DIAG_BIN_TASK out of date");
+
+    diag_snapshot snap = {};        // 最新快照（读写均持有 snap_lock）
+    SemaphoreHandle_t snap_lock = nullptr;
+    TaskHandle_t diag_handle = nullptr;
+
+    TaskHandle_t registered[DIAG_TASK_MAX] = {};
+    uint8_t registered_count = 0;
+
+#if configUSE_TRACE_FACILITY
+    TaskStatus_t status_buf[DIAG_TASK_MAX]; // 只在采样任务中使用
+#endif
+
+    // 任务 -> 窗口槽位；任务消失后槽位在下一个新任务出现时复用
+    TaskHandle_t slot_task[DIAG_TASK_MAX] = {};
+    uint32_t slot_rt[DIAG_TASK_MAX] = {};
+    cpu_window<DIAG_TASK_MAX, DIAG_CPU_FINE + 1> fine;     // 1 个采样周期一格
+    cpu_window<DIAG_TASK_MAX, DIAG_CPU_COARSE + 1> coarse; // DIAG_CPU_COARSE_EVERY 个采样周期一格
+    uint32_t sample_count = 0;
+    diag_snapshot work = {}; // 采样任务的工作副本
+
+    void sample_heap(uint32_t caps, diag_heap &h)
+    {
+        multi_heap_info_t info;
+        heap_caps_get_info(&info, caps);
+        h.total = heap_caps_get_total_size(caps);
+        h.free = info.total_free_bytes;
+        h.min_free = info.minimum_free_bytes;
+        h.largest = info.largest_free_block;
+        h.frag = h.free ? static_cast<uint8_t>(100 - (uint64_t)h.largest * 100 / h.free) : 0;
+    }
+
+    int8_t task_core(TaskHandle_t t)
+    {
+        const BaseType_t core = xTaskGetAffinity(t);
+        return (core == tskNO_AFFINITY) ? -1 : static_cast<int8_t>(core);
+    }
+
+    uint8_t slot_of(TaskHandle_t t, const TaskStatus_t *all, UBaseType_t n)
+    {
+        for (uint8_t i = 0; i < DIAG_TASK_MAX; ++i)
+            if (slot_task[i] == t)
+                return i;
+        for (uint8_t i = 0; i < DIAG_TASK_MAX; ++i)
+        {
+            bool alive = false;
+            for (UBaseType_t k = 0; k < n && slot_task[i]; ++k)
+                alive |= (all[k].xHandle == slot_task[i]);
+            if (alive)
+                continue;
+            slot_task[i] = t;
+            slot_rt[i] = 0;
+            fine.reset_slot(i);
+            coarse.reset_slot(i);
+            return i;
+        }
+        return DIAG_TASK_MAX;
+    }
+
+    bool is_idle(const diag_task &d)
+    {
+        return strncmp(d.name, "IDLE", 4) == 0;
+    }
+
+    void fill_task(diag_task &d, TaskHandle_t t, const char *name, UBaseType_t prio, uint32_t stack_free)
+    {
+        strncpy(d.name, name ? name : "?", sizeof(d.name) - 1);
+        d.name[sizeof(d.name) - 1] = '\0';
+        d.stack_free = stack_free; // ESP-IDF 的高水位以字节为单位
+        d.prio = static_cast<uint8_t>(prio);
+        d.core = task_core(t);
+        d.runtime = 0;
+        memset(d.cpu, 0, sizeof(d.cpu));
+    }
+
+    void sample(diag_snapshot &s)
+    {
+        s.ms = millis();
+        sample_heap(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, s.internal);
+        sample_heap(MALLOC_CAP_SPIRAM, s.psram);
+        s.task_count = 0;
+        s.runtime_ok = false;
+
+#if configUSE_TRACE_FACILITY
+        uint32_t total = 0;
+        // 任务数超过 DIAG_TASK_MAX 时返回 0，退回到只采样登记过的任务
+        const UBaseType_t n = uxTaskGetSystemState(status_buf, DIAG_TASK_MAX, &total);
+        uint8_t slots[DIAG_TASK_MAX];
+        for (UBaseType_t i = 0; i < n; ++i)
+        {
+            const TaskStatus_t &ts = status_buf[i];
+            fill_task(s.tasks[s.task_count++], ts.xHandle, ts.pcTaskName, ts.uxCurrentPriority, ts.usStackHighWaterMark);
+#if configGENERATE_RUN_TIME_STATS
+            slots[i] = slot_of(ts.xHandle, status_buf, n);
+            if (slots[i] < DIAG_TASK_MAX)
+                slot_rt[slots[i]] = ts.ulRunTimeCounter;
+#endif
+        }
+#if configGENERATE_RUN_TIME_STATS
+        if (n)
+        {
+            s.runtime_ok = true;
+            fine.push(total, slot_rt);
+            if (sample_count++ % DIAG_CPU_COARSE_EVERY == 0)
+                coarse.push(total, slot_rt);
+
+            // 各核占用 = 1 - 该核 IDLE 任务占比
+            for (uint8_t c = 0; c < portNUM_PROCESSORS; ++c)
+                for (uint8_t w = 0; w < DIAG_CPU_WINDOWS; ++w)
+                    s.core_load[c][w] = 0;
+            const bool have[DIAG_CPU_WINDOWS] = {fine.span_total(1) > 0, fine.span_total(DIAG_CPU_FINE) > 0,
+                                                 coarse.span_total(DIAG_CPU_COARSE) > 0};
+            for (UBaseType_t i = 0; i < n; ++i)
+            {
+                diag_task &d = s.tasks[i];
+                if (slots[i] >= DIAG_TASK_MAX)
+                    continue;
+                d.runtime = status_buf[i].ulRunTimeCounter;
+                d.cpu[0] = fine.load(slots[i], 1);
+                d.cpu[1] = fine.load(slots[i], DIAG_CPU_FINE);
+                d.cpu[2] = coarse.load(slots[i], DIAG_CPU_COARSE);
+                if (is_idle(d) && d.core >= 0 && d.core < portNUM_PROCESSORS)
+                    for (uint8_t w = 0; w < DIAG_CPU_WINDOWS; ++w)
+                        s.core_load[d.core][w] = have[w] ? 1000 - d.cpu[w] : 0;
+            }
+        }
+#endif
+#endif
+        if (s.task_count)
+            return;
+        for (uint8_t i = 0; i < registered_count; ++i)
+        {
+            TaskHandle_t t = registered[i];
+            fill_task(s.tasks[s.task_count++], t, pcTaskGetName(t), uxTaskPriorityGet(t), uxTaskGetStackHighWaterMark(t));
+        }
+    }
+
+    void diag_Task(void *)
+    {
+        for (;;)
+        {
+            sample(work);
+            xSemaphoreTake(snap_lock, portMAX_DELAY);
+            work.seq = snap.seq + 1;
+            snap = work;
+            xSemaphoreGive(snap_lock);
+            vTaskDelay(pdMS_TO_TICKS(DIAG_SAMPLE_MS));
+        }
+    }
+
+    void put_u8(uint8_t *&p, uint8_t v) { *p++ = v; }
+    void put_u16(uint8_t *&p, uint16_t v)
+    {
+        put_u8(p, v & 0xFF);
+        put_u8(p, v >> 8);
+    }
+    void put_u32(uint8_t *&p, uint32_t v)
+    {
+        put_u16(p, v & 0xFFFF);
+        put_u16(p, v >> 16);
+    }
+    void put_heap(uint8_t *&p, const diag_heap &h)
+    {
+        put_u32(p, h.total);
+        put_u32(p, h.free);
+        put_u32(p, h.min_free);
+        put_u32(p, h.largest);
+        put_u8(p, h.frag);
+        put_u8(p, 0);
+        put_u16(p, 0);
+    }
+    void write_heap(JsonObject o, const diag_heap &h)
+    {
+        o["total"] = h.total;
+        o["free"] = h.free;
+        o["min"] = h.min_free;
+        o["big"] = h.largest;
+        o["frag"] = h.frag;
+    }
+}
+
+void my_diag_init()
+{
+    snap_lock = xSemaphoreCreateMutex();
+    // 采样会短暂挂起本核调度器，因此只能放在非控制核心
+    static_assert(DIAG_CORE != 0, "diag sampling must not run on the control core");
+    xTaskCreatePinnedToCore(diag_Task, "diag", DIAG_STACK, nullptr, 1, &diag_handle, DIAG_CORE);
+    diag_register_task(diag_handle);
+}
+
+void diag_register_task(TaskHandle_t t)
+{
+    if (!t || registered_count >= DIAG_TASK_MAX)
+        return;
+    registered[registered_count++] = t;
+}
+
+uint32_t diag_seq()
+{
+    if (!snap_lock)
+        return 0;
+    xSemaphoreTake(snap_lock, portMAX_DELAY);
+    const uint32_t seq = snap.seq;
+    xSemaphoreGive(snap_lock);
+    return seq;
+}
+
+void diag_get(diag_snapshot &out)
+{
+    if (!snap_lock)
+    {
+        out = {};
+        return;
+    }
+    xSemaphoreTake(snap_lock, portMAX_DELAY);
+    out = snap;
+    xSemaphoreGive(snap_lock);
+}
+
+void diag_write_state(JsonObject obj)
+{
+    diag_snapshot s;
+    diag_get(s);
+    obj["seq"] = s.seq;
+    obj["ms"] = s.ms;
+    obj["runtime"] = s.runtime_ok;
+    write_heap(obj["int"].to<JsonObject>(), s.internal);
+    write_heap(obj["psram"].to<JsonObject>(), s.psram);
+    if (s.runtime_ok)
+    {
+        // 窗口长度（s）与各核占用千分比
+        JsonArray win = obj["win_s"].to<JsonArray>();
+        win.add(DIAG_SAMPLE_MS / 1000);
+        win.add(DIAG_SAMPLE_MS * DIAG_CPU_FINE / 1000);
+        win.add(DIAG_SAMPLE_MS * DIAG_CPU_COARSE_EVERY * DIAG_CPU_COARSE / 1000);
+        JsonArray cores = obj["cores"].to<JsonArray>();
+        for (uint8_t c = 0; c < portNUM_PROCESSORS; ++c)
+        {
+            JsonArray core = cores.add<JsonArray>();
+            for (uint16_t v : s.core_load[c])
+                core.add(v);
+        }
+    }
+    JsonArray tasks = obj["tasks"].to<JsonArray>();
+    for (uint8_t i = 0; i < s.task_count; ++i)
+    {
+        const diag_task &t = s.tasks[i];
+        JsonObject o = tasks.add<JsonObject>();
+        o["n"] = t.name;
+        o["st"] = t.stack_free;
+        o["p"] = t.prio;
+        o["c"] = t.core;
+        if (s.runtime_ok)
+        {
+            o["rt"] = t.runtime;
+            JsonArray cpu = o["cpu"].to<JsonArray>();
+            for (uint16_t v : t.cpu)
+                cpu.add(v);
+        }
+    }
+}
+
+size_t diag_encode_bin(uint8_t *buf, size_t cap)
+{
+    diag_snapshot s;
+    diag_get(s);
+    const size_t need = DIAG_BIN_HEAD + s.task_count * DIAG_BIN_TASK;
+    if (cap < need)
+        return 0;
+    uint8_t *p = buf;
+    put_u8(p, DIAG_BIN_VER);
+    put_u8(p, s.task_count);
+    put_u8(p, s.runtime_ok);
+    put_u8(p, 0);
+    put_u32(p, s.seq);
+    put_u32(p, s.ms);
+    put_heap(p, s.internal);
+    put_heap(p, s.psram);
+    for (uint8_t c = 0; c < portNUM_PROCESSORS; ++c)
+        for (uint16_t v : s.core_load[c])
+            put_u16(p, v);
+    for (uint8_t i = 0; i < s.task_count; ++i)
+    {
+        const diag_task &t = s.tasks[i];
+        memset(p, 0, DIAG_BIN_NAME);
+        memcpy(p, t.name, strnlen(t.name, DIAG_BIN_NAME));
+        p += DIAG_BIN_NAME;
+        put_u32(p, t.stack_free);
+        put_u32(p, t.runtime);
+        for (uint16_t v : t.cpu)
+            put_u16(p, v);
+        put_u8(p, t.prio);
+        put_u8(p, static_cast<uint8_t>(t.core));
+    }
+    return p - buf;
+}
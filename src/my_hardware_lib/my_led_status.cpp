@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include "my_led_status.h"
+#include "my_motion.h"
+#include "my_mpu6050.h"
+#include "my_safety.h"
+
+namespace
+{
+    constexpr rgb_px RED = {255, 0, 0};
+    constexpr rgb_px ORANGE = {255, 80, 0};
+    constexpr rgb_px AMBER = {255, 160, 0};
+    constexpr rgb_px MAGENTA = {255, 0, 255};
+    constexpr rgb_px WHITE = {255, 255, 255};
+
+    uint32_t last_missed = 0;
+    uint32_t overrun_ms = 0;
+
+    bool blink(uint32_t now_ms, uint32_t period_ms)
+    {
+        return (now_ms % period_ms) < period_ms / 2;
+    }
+
+    // 三角波 0-255
+    uint8_t pulse(uint32_t now_ms, uint32_t period_ms)
+    {
+        const uint32_t t = (now_ms % period_ms) * 510 / period_ms;
+        return static_cast<uint8_t>(t < 256 ? t : 510 - t);
+    }
+
+    rgb_px scale(rgb_px c, uint8_t a)
+    {
+        return {static_cast<uint8_t>(c.r * (a + 1) >> 8),
+                static_cast<uint8_t>(c.g * (a + 1) >> 8),
+                static_cast<uint8_t>(c.b * (a + 1) >> 8)};
+    }
+
+    void fill(rgb_px *px, uint16_t count, rgb_px c)
+    {
+        for (uint16_t i = 0; i < count; i++)
+            px[i] = c;
+    }
+}
+
+led_status_snapshot led_status_capture(uint32_t now_ms)
+{
+    const uint32_t missed = safety_ctrl_missed();
+    if (missed != last_missed)
+    {
+        last_missed = missed;
+        overrun_ms = now_ms;
+    }
+
+    led_status_snapshot s = {};
+    s.tripped = safety_tripped();
+    s.imu_fault = !my_mpu6050_ok();
+    s.fallen = robot.fallen.phase == balance_phase::fallen || robot.fallen.phase == balance_phase::falling;
+    s.recovering = robot.fallen.phase == balance_phase::recovering;
+    s.failsafe = robot.group_cfg.enabled && robot.group_cfg.failsafe;
+    s.overrun = overrun_ms != 0 && now_ms - overrun_ms < RGB_OVERRUN_HOLD_MS;
+    s.brownout = robot.bat.brownout;
+    s.bat_low = robot.bat.low;
+    return s;
+}
+
+void led_status_compose(const led_status_snapshot &s, uint32_t now_ms, rgb_px *px, uint16_t count)
+{
+    if (count == 0)
+        return;
+
+    if (s.tripped)
+    {
+        fill(px, count, blink(now_ms, 200) ? RED : rgb_px{0, 0, 0});
+        return;
+    }
+    if (s.imu_fault)
+    {
+        fill(px, count, blink(now_ms, 500) ? MAGENTA : rgb_px{0, 0, 0});
+        return;
+    }
+    if (s.recovering)
+    {
+        // 橙色追逐：一颗亮点绕行
+        fill(px, count, scale(ORANGE, 32));
+        px[(now_ms / 120) % count] = ORANGE;
+        return;
+    }
+    if (s.fallen)
+    {
+        fill(px, count, scale(RED, pulse(now_ms, 1200)));
+        return;
+    }
+    if (s.failsafe)
+    {
+        fill(px, count, blink(now_ms, 600) ? AMBER : rgb_px{0, 0, 0});
+        return;
+    }
+
+    if (s.overrun)
+        px[0] = blink(now_ms, 160) ? WHITE : rgb_px{0, 0, 0};
+    if (s.brownout)
+        px[count - 1] = blink(now_ms, 300) ? RED : rgb_px{0, 0, 0};
+    else if (s.bat_low)
+        px[count - 1] = ORANGE;
+}
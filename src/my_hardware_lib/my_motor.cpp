@@ -3,6 +3,8 @@
 #include "my_config.h"
 #include "my_encoder.h"
 #include "my_motion.h"
+#include "my_safety.h"
+#include "soc/gpio_struct.h"
 
 volatile float motor_left_u = 0.0f;
 volatile float motor_right_u = 0.0f;
@@ -19,7 +21,8 @@ namespace
     {
         Brake = 0,
         Forward,
-        Reverse
+        Reverse,
+        ShortBrake // 两端短接制动，仅用于切断
     };
 
     // LEDC 通道分配
@@ -54,6 +57,10 @@ namespace
             digitalWrite(in1, LOW);
             digitalWrite(in2, HIGH);
             break;
+        case MotorState::ShortBrake:
+            digitalWrite(in1, HIGH);
+            digitalWrite(in2, HIGH);
+            break;
         case MotorState::Brake:
         default:
             digitalWrite(in1, LOW);
@@ -176,8 +183,36 @@ void my_motor_init()
     robot.motor.R_cmd = 0.0f;
 }
 
+void my_motor_kill()
+{
+    write_pwm(MotorSide::Left, 0.0f);
+    write_pwm(MotorSide::Right, 0.0f);
+    set_dir(MotorSide::Left, MotorState::ShortBrake);
+    set_dir(MotorSide::Right, MotorState::ShortBrake);
+    motor_left_u = 0.0f;
+    motor_right_u = 0.0f;
+}
+
+void IRAM_ATTR my_motor_kill_isr()
+{
+    // TB6612 的 IN1/IN2 同为高电平即短接制动，与 PWM 通道状态无关；同为低电平只是滑行，倒下的车会继续滚
+    static_assert(MOTOR_A_IN1_PIN < 32 && MOTOR_A_IN2_PIN < 32 && MOTOR_B_IN1_PIN < 32 && MOTOR_B_IN2_PIN < 32,
+                  "direction pins must live in GPIO bank 0");
+    GPIO.out_w1ts = (1UL << MOTOR_A_IN1_PIN) | (1UL << MOTOR_A_IN2_PIN) |
+                    (1UL << MOTOR_B_IN1_PIN) | (1UL << MOTOR_B_IN2_PIN);
+}
+
 void my_motor_update()
 {
+    // 安全监控已切断：保持停止，直到控制任务恢复后解除
+    if (safety_tripped())
+    {
+        my_motor_kill();
+        robot.motor.L_duty = 0.0f;
+        robot.motor.R_duty = 0.0f;
+        return;
+    }
+
     // 读取指令并驱动，两侧互不干扰
     robot.motor.L_cmd = motor_left_u;
     robot.motor.R_cmd = motor_right_u;
@@ -1,9 +1,72 @@
 #include "my_motion.h"
 #include "my_mpu6050.h"
 #include "Arduino.h"
+#include <math.h>
+#include "my_I2C.h"
 
 
 MPU6050 mpu6050 = MPU6050(Wire);
+
+namespace
+{
+    uint32_t last_update_us = 0;
+    uint32_t last_read_us = 0;
+    uint8_t read_fails = 0;    // 连续读取失败次数，封顶 255
+    uint8_t recover_fails = 0; // 上次请求恢复以来真正访问总线失败的次数，与 read_fails 分开计数，不受封顶影响
+
+    // 读取失败时用上一帧角速度外推姿态，保持控制环连续
+    void imu_predict()
+    {
+        const uint32_t now_us = micros();
+        const float dt_s = last_read_us ? static_cast<float>(now_us - last_read_us) * 1e-6f : 0.0f;
+        last_read_us = now_us;
+        robot.imu.anglex += robot.imu.gyrox * dt_s;
+        robot.imu.angley += robot.imu.gyroy * dt_s;
+        robot.imu.anglez += robot.imu.gyroz * dt_s;
+    }
+
+    // 静止判定：无转向指令、轮子基本不动且陀螺仪读数很小
+    bool is_still(float gyroz_raw)
+    {
+        const float wheel_diff = fabsf(robot.wel.spd1 - robot.wel.spd2);
+        const float wheel_mean = fabsf(robot.wel.spd1 + robot.wel.spd2) * 0.5f;
+        return robot.joy.x == 0.0f &&
+               wheel_diff < HEADING_STILL_WHEEL &&
+               wheel_mean < HEADING_STILL_WHEEL &&
+               fabsf(gyroz_raw - robot.heading.bias) < HEADING_STILL_RATE;
+    }
+
+    // 在线估计 Z 轴零偏并积分航向（微秒计时）
+    void heading_update(float gyroz_raw)
+    {
+        const uint32_t now_us = micros();
+        float dt_s = last_update_us ? static_cast<float>(now_us - last_update_us) * 1e-6f : 0.0f;
+        last_update_us = now_us;
+        if (dt_s <= 0.0f || dt_s > 0.5f)
+            dt_s = 0.0f; // 首帧或异常间隔不积分
+
+        if (is_still(gyroz_raw))
+        {
+            robot.heading.still_ms += static_cast<uint32_t>(dt_s * 1000.0f + 0.5f);
+            if (robot.heading.still_ms >= HEADING_STILL_MS)
+            {
+                const float alpha = dt_s / (HEADING_BIAS_TAU + dt_s);
+                robot.heading.bias += alpha * (gyroz_raw - robot.heading.bias);
+                if (robot.heading.bias > HEADING_BIAS_LIMIT)
+                    robot.heading.bias = HEADING_BIAS_LIMIT;
+                else if (robot.heading.bias < -HEADING_BIAS_LIMIT)
+                    robot.heading.bias = -HEADING_BIAS_LIMIT;
+            }
+        }
+        else
+        {
+            robot.heading.still_ms = 0;
+        }
+
+        robot.imu.gyroz = gyroz_raw - robot.heading.bias;
+        robot.heading.angle += robot.imu.gyroz * dt_s;
+    }
+}
 void my_mpu6050_setzero()
 {
     my_mpu6050_update();
@@ -25,6 +88,11 @@ void my_mpu6050_init()
     Serial.println("MPU6050初始状态设置完毕");
 }
 
+bool my_mpu6050_ok()
+{
+    return read_fails <= IMU_PREDICT_MAX;
+}
+
 void my_mpu6050_update()
 {
     robot.imu_l.anglex = robot.imu.anglex;
@@ -33,11 +101,37 @@ void my_mpu6050_update()
     robot.imu_l.gyrox = robot.imu.gyrox;
     robot.imu_l.gyroy = robot.imu.gyroy;
     robot.imu_l.gyroz = robot.imu.gyroz;
-    mpu6050.update();
+
+    // 总线恢复在其他任务进行，期间不碰总线，按失败处理继续外推
+    const bool recovering = my_i2c_recovering(0);
+    bool ok = false;
+    if (!recovering)
+    {
+        const uint32_t t0 = micros();
+        ok = mpu6050.update();
+        my_i2c_record(0, micros() - t0, ok);
+    }
+    if (!ok)
+    {
+        if (read_fails < 255)
+            read_fails++;
+        if (read_fails <= IMU_PREDICT_MAX)
+            imu_predict();
+        if (!recovering && ++recover_fails >= IMU_RECOVER_FAILS)
+        {
+            recover_fails = 0;
+            my_i2c_recover_async(0);
+        }
+        return;
+    }
+    read_fails = 0;
+    recover_fails = 0;
+    last_read_us = micros();
+
     robot.imu.anglex = mpu6050.getAngleX();
     robot.imu.angley = mpu6050.getAngleY();
     robot.imu.anglez = mpu6050.getAngleZ();
     robot.imu.gyrox = mpu6050.getGyroX();
     robot.imu.gyroy = mpu6050.getGyroY();
-    robot.imu.gyroz = mpu6050.getGyroZ();
+    heading_update(mpu6050.getGyroZ());
 }
@@ -1,243 +1,273 @@
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
+#include <driver/rmt.h>
 #include <math.h>
 #include <string.h>
 #include "my_rgb.h"
+#include "my_led_status.h"
 #include "my_motion.h"
+#include "my_trace.h"
 
-static Adafruit_NeoPixel rgb_strip = Adafruit_NeoPixel(RGB_LED_COUNT, RGB_LED_PIN, NEO_GRB + NEO_KHZ800);
-
-struct rgb_anim_state
-{
-    // 霓虹
-    uint32_t neon_ms;
-    uint16_t neon_offset;
-    // 呼吸
-    uint32_t breath_ms;
-    uint16_t breath_phase;
-    // 流星
-    uint32_t meteor_ms;
-    float meteor_pos_f;
-    float meteor_trail[RGB_LED_COUNT];
-    // 心跳
-    uint32_t beat_ms;
-    uint8_t beat_stage;
-    uint32_t beat_stage_start;
-};
-
-static rgb_anim_state anim_state = {};
-
-static inline uint16_t pixel_count()
-{
-    const uint16_t max_count = rgb_strip.numPixels();
-    if (robot.rgb.rgb_count <= 0)
-        return max_count;
-    return robot.rgb.rgb_count > max_count ? max_count : robot.rgb.rgb_count;
-}
-
-static uint32_t color_wheel(uint8_t pos)
+namespace
 {
-    pos = 255 - pos;
-    if (pos < 85)
+    // RMT 时钟 80MHz / 2 = 40MHz，每 tick 25ns
+    constexpr uint8_t RMT_CLK_DIV = 2;
+    constexpr uint16_t T0H = 16; // 0.4us
+    constexpr uint16_t T0L = 34; // 0.85us
+    constexpr uint16_t T1H = 32; // 0.8us
+    constexpr uint16_t T1L = 18; // 0.45us
+
+    // 流星尾迹查找表：按距离头部的 1/16 像素索引
+    constexpr int METEOR_SUB = 16;
+    constexpr int METEOR_TAIL_PX = 8;
+    constexpr int METEOR_LUT = METEOR_SUB * METEOR_TAIL_PX;
+    constexpr uint32_t METEOR_SPEED_Q8 = 6 * 256; // 6 像素/秒，Q8
+
+    uint8_t meteor_decay[METEOR_LUT]; // 能量 0-255
+    uint8_t meteor_r[256];            // 各通道伽马曲线，偏暖色
+    uint8_t meteor_g[256];
+    uint8_t meteor_b[256];
+
+    // 心跳：分段线性包络
+    struct beat_stage_cfg
     {
-        return rgb_strip.Color(255 - pos * 3, 0, pos * 3);
-    }
-    if (pos < 170)
+        uint16_t duration_ms;
+        uint8_t start_level;
+        uint8_t end_level;
+    };
+
+    const beat_stage_cfg HEART_STAGES[] = {
+        {70, 0, 255},  // 快速上升
+        {120, 255, 40}, // 瞬间回落
+        {90, 40, 0},    // 间隙
+        {160, 0, 200}, // 第二下
+        {180, 200, 0}, // 回落
+        {520, 0, 0}    // 长间隔
+    };
+    constexpr uint8_t HEART_STAGE_COUNT = sizeof(HEART_STAGES) / sizeof(HEART_STAGES[0]);
+
+    rgb_px frame[RGB_LED_COUNT];
+    uint8_t tx_buf[RGB_LED_COUNT * 3]; // GRB 线序，发送期间 RMT 中断仍在读取，不可修改
+    bool tx_valid = false;
+    bool rmt_ready = false;
+
+    rgb_px color_wheel(uint8_t pos)
     {
-        pos -= 85;
-        return rgb_strip.Color(0, pos * 3, 255 - pos * 3);
+        pos = 255 - pos;
+        if (pos < 85)
+            return {static_cast<uint8_t>(255 - pos * 3), 0, static_cast<uint8_t>(pos * 3)};
+        if (pos < 170)
+        {
+            pos -= 85;
+            return {0, static_cast<uint8_t>(pos * 3), static_cast<uint8_t>(255 - pos * 3)};
+        }
+        pos -= 170;
+        return {static_cast<uint8_t>(pos * 3), static_cast<uint8_t>(255 - pos * 3), 0};
     }
-    pos -= 170;
-    return rgb_strip.Color(pos * 3, 255 - pos * 3, 0);
-}
 
-// 霓虹灯
-static void effect_neon(uint32_t now_ms)
-{
-    const uint16_t interval_ms = 20;
-    if (now_ms - anim_state.neon_ms < interval_ms)
-        return;
-    anim_state.neon_ms = now_ms;
-    anim_state.neon_offset = (anim_state.neon_offset + 1) & 0xFF;
-
-    const uint16_t count = pixel_count();
-    if (count == 0)
-        return;
-
-    for (uint16_t i = 0; i < count; i++)
+    // 霓虹灯
+    void effect_neon(uint32_t now_ms, rgb_px *px, uint16_t count)
     {
-        const uint8_t wheel_pos = (uint8_t)((i * 256 / count + anim_state.neon_offset) & 0xFF);
-        rgb_strip.setPixelColor(i, color_wheel(wheel_pos));
+        const uint8_t offset = static_cast<uint8_t>(now_ms / 20);
+        for (uint16_t i = 0; i < count; i++)
+            px[i] = color_wheel(static_cast<uint8_t>(i * 256 / count + offset));
     }
-    rgb_strip.show();
-}
-
-// 呼吸灯
-static void effect_breath(uint32_t now_ms)
-{
-    const uint16_t interval_ms = 8;
-    if (now_ms - anim_state.breath_ms < interval_ms)
-        return;
-    anim_state.breath_ms = now_ms;
-    anim_state.breath_phase = (anim_state.breath_phase + 1) % 512; // 0-511三角波
 
-    const uint16_t count = pixel_count();
-    if (count == 0)
-        return;
-
-    const uint8_t level = anim_state.breath_phase < 256 ? anim_state.breath_phase : 511 - anim_state.breath_phase;
-    // 偏蓝绿色的呼吸色
-    const uint8_t r = level / 10;
-    const uint8_t g = level;
-    const uint8_t b = (uint8_t)(level * 0.8f);
-
-    for (uint16_t i = 0; i < count; i++)
+    // 呼吸灯
+    void effect_breath(uint32_t now_ms, rgb_px *px, uint16_t count)
     {
-        rgb_strip.setPixelColor(i, rgb_strip.Color(r, g, b));
+        const uint16_t phase = (now_ms / 8) % 512; // 0-511三角波
+        const uint8_t level = phase < 256 ? phase : 511 - phase;
+        // 偏蓝绿色的呼吸色
+        const rgb_px c = {static_cast<uint8_t>(level / 10), level, static_cast<uint8_t>(level * 205 >> 8)};
+        for (uint16_t i = 0; i < count; i++)
+            px[i] = c;
     }
-    rgb_strip.show();
-}
-
-// 流星灯
-static void effect_meteor(uint32_t now_ms)
-{
-    const uint32_t dt_ms = now_ms - anim_state.meteor_ms;
-    if (dt_ms < 12)
-        return;
-    anim_state.meteor_ms = now_ms;
 
-    const uint16_t count = pixel_count();
-    if (count == 0)
-        return;
-
-    const float dt = dt_ms / 1000.0f;
-    const float speed_px_per_s = 6.0f; // 平滑移动的速度（像素/秒）
-    anim_state.meteor_pos_f += dt * speed_px_per_s;
-    while (anim_state.meteor_pos_f >= count)
-        anim_state.meteor_pos_f -= count;
-
-    const int head_idx = (int)anim_state.meteor_pos_f;
-    const float frac = anim_state.meteor_pos_f - (float)head_idx;
-
-    const float decay_factor = expf(-dt * 7.5f); // 平滑尾迹衰减
-    for (uint16_t i = 0; i < count; i++)
+    // 流星灯：头部位置由时间直接决定，尾迹能量按距离查表
+    void effect_meteor(uint32_t now_ms, rgb_px *px, uint16_t count)
     {
-        anim_state.meteor_trail[i] *= decay_factor;
-        if (anim_state.meteor_trail[i] < 0.01f)
-            anim_state.meteor_trail[i] = 0.0f;
+        const uint32_t span = static_cast<uint32_t>(count) * 256;
+        const uint32_t head = static_cast<uint32_t>((static_cast<uint64_t>(now_ms) * METEOR_SPEED_Q8 / 1000) % span);
+        for (uint16_t i = 0; i < count; i++)
+        {
+            const uint32_t pos = static_cast<uint32_t>(i) * 256;
+            const uint32_t behind = (head + span - pos) % span; // 像素落后头部的距离（Q8）
+            const uint32_t ahead = span - behind;               // 像素领先头部的距离（Q8）
+            uint8_t e = 0;
+            if (behind / (256 / METEOR_SUB) < METEOR_LUT)
+                e = meteor_decay[behind / (256 / METEOR_SUB)];
+            if (ahead < 256)
+            {
+                // 头部能量插值到下一个像素
+                const uint8_t next = static_cast<uint8_t>(153 + (102 * (256 - ahead) >> 8));
+                if (next > e)
+                    e = next;
+            }
+            px[i] = {meteor_r[e], meteor_g[e], meteor_b[e]};
+        }
     }
 
-    // 头部能量双线性插值到相邻像素，尾部再补柔和衰减
-    const uint8_t tail = count > 5 ? 5 : 3;
-    const int idx_next = (head_idx + 1) % count;
-    const float head_energy = 1.0f;
-    const float next_energy = head_energy * (0.6f + 0.4f * frac);
+    // 心跳灯
+    void effect_heartbeat(uint32_t now_ms, rgb_px *px, uint16_t count)
+    {
+        uint32_t period = 0;
+        for (const beat_stage_cfg &s : HEART_STAGES)
+            period += s.duration_ms;
+
+        uint32_t t = now_ms % period;
+        uint8_t level = 0;
+        for (const beat_stage_cfg &s : HEART_STAGES)
+        {
+            if (t < s.duration_ms)
+            {
+                level = static_cast<uint8_t>(s.start_level + (static_cast<int32_t>(s.end_level) - s.start_level) * static_cast<int32_t>(t) / s.duration_ms);
+                break;
+            }
+            t -= s.duration_ms;
+        }
+        for (uint16_t i = 0; i < count; i++)
+            px[i] = {level, 0, 0};
+    }
 
-    if (head_energy > anim_state.meteor_trail[head_idx])
-        anim_state.meteor_trail[head_idx] = head_energy;
-    if (next_energy > anim_state.meteor_trail[idx_next])
-        anim_state.meteor_trail[idx_next] = next_energy;
+    // 字节 -> RMT 脉冲，运行在 RMT 中断中
+    void IRAM_ATTR ws2812_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
+                                  size_t wanted_num, size_t *translated_size, size_t *item_num)
+    {
+        if (src == nullptr || dest == nullptr)
+        {
+            *translated_size = 0;
+            *item_num = 0;
+            return;
+        }
+        rmt_item32_t bit0 = {};
+        bit0.duration0 = T0H;
+        bit0.level0 = 1;
+        bit0.duration1 = T0L;
+        bit0.level1 = 0;
+        rmt_item32_t bit1 = {};
+        bit1.duration0 = T1H;
+        bit1.level0 = 1;
+        bit1.duration1 = T1L;
+        bit1.level1 = 0;
+
+        const uint8_t *psrc = static_cast<const uint8_t *>(src);
+        size_t size = 0;
+        size_t num = 0;
+        while (size < src_size && num + 8 <= wanted_num)
+        {
+            for (int i = 7; i >= 0; i--)
+            {
+                dest->val = (*psrc & (1 << i)) ? bit1.val : bit0.val;
+                dest++;
+            }
+            num += 8;
+            size++;
+            psrc++;
+        }
+        *translated_size = size;
+        *item_num = num;
+    }
 
-    for (uint8_t j = 1; j <= tail; j++)
+    bool rmt_init()
     {
-        const int idx = (head_idx - j + count) % count;
-        const float decay = expf(-(float)j * 0.55f);
-        if (decay > anim_state.meteor_trail[idx])
-            anim_state.meteor_trail[idx] = decay;
+        rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX(static_cast<gpio_num_t>(RGB_LED_PIN), RGB_RMT_CHANNEL);
+        cfg.clk_div = RMT_CLK_DIV;
+        if (rmt_config(&cfg) != ESP_OK)
+            return false;
+        if (rmt_driver_install(cfg.channel, 0, 0) != ESP_OK)
+            return false;
+        return rmt_translator_init(cfg.channel, ws2812_adapter) == ESP_OK;
     }
 
-    for (uint16_t i = 0; i < count; i++)
+    // 上一帧仍在发送则跳过；内容未变化不发送
+    void rgb_show(const rgb_px *px, uint16_t count)
     {
-        const float v = anim_state.meteor_trail[i];
-        // 稍微加暖色和伽马以获得更丝滑的视觉
-        const float gamma = powf(v, 0.85f);
-        const uint8_t r = (uint8_t)(gamma * 255.0f);
-        const uint8_t g = (uint8_t)(powf(v, 1.05f) * 180.0f);
-        const uint8_t b = (uint8_t)(powf(v, 1.2f) * 120.0f);
-        rgb_strip.setPixelColor(i, rgb_strip.Color(r, g, b));
+        if (!rmt_ready || rmt_wait_tx_done(RGB_RMT_CHANNEL, 0) != ESP_OK)
+            return;
+
+        uint8_t next[sizeof(tx_buf)] = {};
+        for (uint16_t i = 0; i < count; i++)
+        {
+            next[i * 3 + 0] = static_cast<uint8_t>((px[i].g * (RGB_BRIGHTNESS + 1)) >> 8);
+            next[i * 3 + 1] = static_cast<uint8_t>((px[i].r * (RGB_BRIGHTNESS + 1)) >> 8);
+            next[i * 3 + 2] = static_cast<uint8_t>((px[i].b * (RGB_BRIGHTNESS + 1)) >> 8);
+        }
+        if (tx_valid && memcmp(next, tx_buf, sizeof(tx_buf)) == 0)
+            return;
+
+        memcpy(tx_buf, next, sizeof(tx_buf));
+        tx_valid = rmt_write_sample(RGB_RMT_CHANNEL, tx_buf, sizeof(tx_buf), false) == ESP_OK;
     }
-    rgb_strip.show();
 }
 
-// 心跳灯
-struct beat_stage_cfg
-{
-    uint16_t duration_ms;
-    uint8_t start_level;
-    uint8_t end_level;
-};
-
-static const beat_stage_cfg HEART_STAGES[] = {
-    {70, 0, 255},  // 快速上升
-    {120, 255, 40}, // 瞬间回落
-    {90, 40, 0},    // 间隙
-    {160, 0, 200}, // 第二下
-    {180, 200, 0}, // 回落
-    {520, 0, 0}    // 长间隔
-};
-static void effect_heartbeat(uint32_t now_ms)
+void rgb_lut_init()
 {
-    const uint8_t stage_count = sizeof(HEART_STAGES) / sizeof(HEART_STAGES[0]);
-    const beat_stage_cfg &cfg = HEART_STAGES[anim_state.beat_stage];
-
-    const uint32_t elapsed = now_ms - anim_state.beat_stage_start;
-    if (elapsed >= cfg.duration_ms)
+    for (int i = 0; i < METEOR_LUT; i++)
+        meteor_decay[i] = static_cast<uint8_t>(expf(-static_cast<float>(i) / METEOR_SUB * 0.55f) * 255.0f);
+    for (int i = 0; i < 256; i++)
     {
-        anim_state.beat_stage = (anim_state.beat_stage + 1) % stage_count;
-        anim_state.beat_stage_start = now_ms;
+        // 稍微加暖色和伽马以获得更丝滑的视觉
+        const float v = i / 255.0f;
+        meteor_r[i] = static_cast<uint8_t>(powf(v, 0.85f) * 255.0f);
+        meteor_g[i] = static_cast<uint8_t>(powf(v, 1.05f) * 180.0f);
+        meteor_b[i] = static_cast<uint8_t>(powf(v, 1.2f) * 120.0f);
     }
+}
 
-    const beat_stage_cfg &cur = HEART_STAGES[anim_state.beat_stage];
-    const uint32_t cur_elapsed = now_ms - anim_state.beat_stage_start;
-    const float t = cur.duration_ms == 0 ? 1.0f : (float)cur_elapsed / (float)cur.duration_ms;
-    const float level_f = (float)cur.start_level + (float)(cur.end_level - cur.start_level) * t;
-    const uint8_t level = (uint8_t)level_f;
-
-    const uint16_t count = pixel_count();
+void rgb_render(int mode, uint32_t now_ms, rgb_px *px, uint16_t count)
+{
     if (count == 0)
         return;
-
-    for (uint16_t i = 0; i < count; i++)
+    switch (mode)
     {
-        rgb_strip.setPixelColor(i, rgb_strip.Color(level, 0, 0));
+    case RGB_MODE_NEON:
+        effect_neon(now_ms, px, count);
+        break;
+    case RGB_MODE_BREATH:
+        effect_breath(now_ms, px, count);
+        break;
+    case RGB_MODE_METEOR:
+        effect_meteor(now_ms, px, count);
+        break;
+    case RGB_MODE_HEARTBEAT:
+        effect_heartbeat(now_ms, px, count);
+        break;
+    default:
+        memset(px, 0, sizeof(rgb_px) * count);
+        break;
     }
-    rgb_strip.show();
 }
 
 void my_rgb_init()
 {
-    rgb_strip.begin();
-    rgb_strip.setBrightness(96);
-    rgb_strip.show();
-
-    memset(&anim_state, 0, sizeof(anim_state));
+    rgb_lut_init();
+    rmt_ready = rmt_init();
+    if (!rmt_ready)
+        Serial.println("RGB RMT 初始化失败");
 
     if (robot.rgb.rgb_count <= 0 || robot.rgb.rgb_count > RGB_LED_COUNT)
         robot.rgb.rgb_count = RGB_LED_COUNT;
     if (robot.rgb.mode < RGB_MODE_NEON || robot.rgb.mode > RGB_MODE_HEARTBEAT)
         robot.rgb.mode = RGB_MODE_NEON;
 
-    anim_state.beat_stage_start = millis();
+    memset(frame, 0, sizeof(frame));
+    rgb_show(frame, RGB_LED_COUNT);
 }
 
 void my_rgb_update()
 {
+    uint16_t count = RGB_LED_COUNT;
+    if (robot.rgb.rgb_count > 0 && robot.rgb.rgb_count < RGB_LED_COUNT)
+        count = robot.rgb.rgb_count;
+
     const uint32_t now_ms = millis();
-    switch (robot.rgb.mode)
-    {
-    case RGB_MODE_NEON:
-        effect_neon(now_ms);
-        break;
-    case RGB_MODE_BREATH:
-        effect_breath(now_ms);
-        break;
-    case RGB_MODE_METEOR:
-        effect_meteor(now_ms);
-        break;
-    case RGB_MODE_HEARTBEAT:
-        effect_heartbeat(now_ms);
-        break;
-    default:
-        break;
-    }
+    const led_status_snapshot status = led_status_capture(now_ms);
+
+    // 未使用的灯珠保持熄灭
+    memset(frame, 0, sizeof(frame));
+    rgb_render(robot.rgb.mode, now_ms, frame, count);
+    led_status_compose(status, now_ms, frame, count);
+    TRACE_BEGIN(RGB_SHOW);
+    rgb_show(frame, RGB_LED_COUNT);
+    TRACE_END(RGB_SHOW);
 }
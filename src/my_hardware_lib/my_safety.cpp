@@ -0,0 +1,168 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <esp_task_wdt.h>
+#include "my_safety.h"
+#include "my_config.h"
+#include "my_motion.h"
+#include "my_motor.h"
+#include "my_trace.h"
+
+namespace
+{
+    struct task_monitor
+    {
+        const char *name;
+        uint32_t timeout_ticks;      // 超过该监控周期数无心跳记为一次停滞
+        volatile uint32_t beats;     // 心跳计数（任务写）
+        uint32_t seen_beats;         // 中断上次看到的心跳计数
+        uint32_t idle_ticks;         // 连续无心跳的监控周期数
+        volatile uint32_t stalls;    // 停滞次数
+        volatile uint32_t max_idle;  // 最长无心跳周期数
+    };
+
+    constexpr uint32_t ms_to_ticks(uint32_t ms)
+    {
+        return ms * 1000UL / SAFETY_TICK_US;
+    }
+
+    task_monitor monitors[SAFETY_TASK_COUNT] = {
+        {"ctrl", SAFETY_CTRL_MISS_MAX, 0, 0, 0, 0, 0},
+        {"telem", ms_to_ticks(2000), 0, 0, 0, 0, 0},
+        {"screen", ms_to_ticks(1000), 0, 0, 0, 0, 0},
+        {"rgb", ms_to_ticks(500), 0, 0, 0, 0, 0},
+    };
+
+    hw_timer_t *safety_timer = nullptr;
+    portMUX_TYPE safety_mux = portMUX_INITIALIZER_UNLOCKED;
+
+    volatile bool tripped = false;
+    volatile uint32_t trip_count = 0;     // 切断次数
+    volatile uint32_t missed_ticks = 0;   // 控制任务累计错过的周期数
+    volatile uint32_t inject_until_ms = 0;
+    volatile bool trip_pending_log = false; // 控制任务只置位，由低优先级任务打印
+    uint32_t last_trip_ms = 0;
+    bool wdt_ok = false;
+
+    void IRAM_ATTR on_safety_tick()
+    {
+        portENTER_CRITICAL_ISR(&safety_mux);
+        for (int i = 0; i < SAFETY_TASK_COUNT; ++i)
+        {
+            task_monitor &m = monitors[i];
+            const uint32_t beats = m.beats;
+            if (beats != m.seen_beats)
+            {
+                m.seen_beats = beats;
+                m.idle_ticks = 0;
+                continue;
+            }
+            m.idle_ticks++;
+            if (m.idle_ticks > m.max_idle)
+                m.max_idle = m.idle_ticks;
+            if (i == SAFETY_TASK_CTRL && m.idle_ticks > 1)
+                missed_ticks++;
+            if (m.idle_ticks == m.timeout_ticks)
+            {
+                m.stalls++;
+                if (i == SAFETY_TASK_CTRL && !tripped)
+                {
+                    // 控制任务停摆：立即在中断里切断电机方向脚
+                    my_motor_kill_isr();
+                    TRACE_FREEZE(SAFETY_TRIP); // 冻结追踪缓冲，保留停摆前的现场
+                    tripped = true;
+                    trip_count++;
+                }
+            }
+        }
+        portEXIT_CRITICAL_ISR(&safety_mux);
+    }
+}
+
+void my_safety_init()
+{
+    esp_err_t err = esp_task_wdt_init(SAFETY_TWDT_TIMEOUT_S, true);
+    wdt_ok = (err == ESP_OK || err == ESP_ERR_INVALID_STATE); // 框架可能已初始化过
+
+    safety_timer = timerBegin(SAFETY_TIMER_ID, 80, true); // 80MHz / 80 = 1us 计数
+    timerAttachInterrupt(safety_timer, &on_safety_tick, true);
+    timerAlarmWrite(safety_timer, SAFETY_TICK_US, true);
+    timerAlarmEnable(safety_timer);
+    Serial.println("安全监控已启动");
+}
+
+void safety_register_ctrl(TaskHandle_t task)
+{
+    if (wdt_ok && task)
+        wdt_ok = esp_task_wdt_add(task) == ESP_OK;
+}
+
+void safety_beat(safety_task task)
+{
+    if (task == SAFETY_TASK_CTRL)
+    {
+        // 故障注入期间不喂狗也不跳动，模拟控制任务卡死
+        if (inject_until_ms && (int32_t)(millis() - inject_until_ms) < 0)
+            return;
+        inject_until_ms = 0;
+
+        if (wdt_ok)
+            esp_task_wdt_reset();
+        if (tripped)
+        {
+            // 控制任务恢复：先解除运行，再解锁输出，需人工重新启用
+            robot.run = false;
+            my_motor_kill();
+            last_trip_ms = millis();
+            portENTER_CRITICAL(&safety_mux);
+            tripped = false;
+            portEXIT_CRITICAL(&safety_mux);
+            trip_pending_log = true;
+        }
+    }
+    monitors[task].beats = monitors[task].beats + 1;
+}
+
+void safety_log_poll()
+{
+    if (!trip_pending_log)
+        return;
+    trip_pending_log = false;
+    Serial.printf("[SAFETY] %lu ms 控制任务超时，电机已切断并解除运行\n", (unsigned long)last_trip_ms);
+}
+
+bool safety_tripped()
+{
+    return tripped;
+}
+
+uint32_t safety_ctrl_missed()
+{
+    return missed_ticks;
+}
+
+void safety_inject_stall(uint32_t ms)
+{
+#if MY_SAFETY_INJECT
+    if (ms > 0)
+        inject_until_ms = (millis() + std::min<uint32_t>(ms, SAFETY_INJECT_MAX_MS)) | 1;
+#else
+    (void)ms;
+#endif
+}
+
+void safety_write_state(JsonObject obj)
+{
+    obj["tripped"] = tripped;
+    obj["trips"] = trip_count;
+    obj["missed"] = missed_ticks;
+    obj["last_trip_ms"] = last_trip_ms;
+    obj["wdt"] = wdt_ok;
+    JsonObject tasks = obj["tasks"].to<JsonObject>();
+    for (int i = 0; i < SAFETY_TASK_COUNT; ++i)
+    {
+        JsonObject t = tasks[monitors[i].name].to<JsonObject>();
+        t["beats"] = monitors[i].beats;
+        t["stalls"] = monitors[i].stalls;
+        t["max_idle_ms"] = monitors[i].max_idle * SAFETY_TICK_US / 1000;
+    }
+}
@@ -8,17 +8,34 @@
 #include "my_motion.h"
 #include "my_bat.h"
 #include "my_I2C.h"
+#include "my_trace.h"
+#include <string.h>
 
 namespace
 {
     constexpr uint32_t FRAME_INTERVAL_MS = SCREEN_REFRESH_TIME;
-    constexpr float BATT_MIN_V = 9.0f;
-    constexpr float BATT_MAX_V = 12.6f;
-
     Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &ScreenWire, -1);
 
+    constexpr int SCREEN_PAGES = SCREEN_HEIGHT / 8;
+    constexpr size_t FB_BYTES = SCREEN_WIDTH * SCREEN_PAGES;
+
     bool screen_ready = false;
     uint32_t last_frame_ms = 0;
+    uint8_t screen_addr = 0;
+    uint8_t shadow[FB_BYTES]; // 屏幕上当前实际显示的内容
+    bool shadow_valid = false;
+    uint8_t bus_fails = 0; // 上次请求恢复以来发送失败的帧数
+
+    struct screen_stats
+    {
+        uint32_t frames;     // 有内容变化并发送的帧数
+        uint32_t skipped;    // 无变化跳过的帧数
+        uint32_t build_us;   // 最近一帧绘制耗时
+        uint32_t bus_us;     // 最近一帧总线耗时
+        uint32_t bus_max_us; // 最长总线耗时
+        uint32_t bytes;      // 最近一帧发送的显存字节数
+        uint32_t spans;      // 最近一帧发送的区间数
+    } stats = {};
 
     uint8_t normalized_address(uint8_t raw)
     {
@@ -29,7 +46,7 @@ namespace
         return raw;
     }
 
-    void draw_battery(float voltage)
+    void draw_battery(float voltage, float soc)
     {
         const int body_x = 0;
         const int body_y = 2;
@@ -37,7 +54,7 @@ namespace
         const int body_h = 12;
         const int tip_w = 2;
 
-        const float pct = constrain((voltage - BATT_MIN_V) / (BATT_MAX_V - BATT_MIN_V), 0.0f, 1.0f);
+        const float pct = constrain(soc, 0.0f, 1.0f);
 
         display.drawRoundRect(body_x, body_y, body_w, body_h, 2, SSD1306_WHITE);
         display.fillRect(body_x + body_w, body_y + 3, tip_w, body_h - 6, SSD1306_WHITE);
@@ -56,6 +73,90 @@ namespace
         display.print(text);
     }
 
+    bool send_commands(const uint8_t *cmds, size_t n)
+    {
+        ScreenWire.beginTransmission(screen_addr);
+        ScreenWire.write(static_cast<uint8_t>(0x00)); // Co=0, D/C=0：后续均为命令
+        ScreenWire.write(cmds, n);
+        return ScreenWire.endTransmission() == 0;
+    }
+
+    // 发送一页内 [first, last] 列的显存，SSD1306 处于水平寻址模式
+    bool send_span(uint8_t page, uint8_t first, uint8_t last, const uint8_t *data)
+    {
+        const uint8_t addr_cmds[] = {
+            0x21, first, last, // 列地址范围
+            0x22, page, page,  // 页地址范围
+        };
+        if (!send_commands(addr_cmds, sizeof(addr_cmds)))
+            return false;
+
+        size_t remain = static_cast<size_t>(last - first + 1);
+        while (remain > 0)
+        {
+            const size_t n = remain > SCREEN_I2C_CHUNK ? SCREEN_I2C_CHUNK : remain;
+            ScreenWire.beginTransmission(screen_addr);
+            ScreenWire.write(static_cast<uint8_t>(0x40)); // D/C=1：显存数据
+            ScreenWire.write(data, n);
+            if (ScreenWire.endTransmission() != 0)
+                return false;
+            data += n;
+            remain -= n;
+        }
+        return true;
+    }
+
+    // 与影子缓冲比较，只发送变化的页/列区间；失败时作废影子缓冲，下一帧全量重发
+    void flush_dirty()
+    {
+        TRACE_SCOPE(OLED_I2C);
+        const uint8_t *fb = display.getBuffer();
+        uint32_t bytes = 0;
+        uint32_t spans = 0;
+        bool ok = true;
+
+        const uint32_t t0 = micros();
+        for (int page = 0; page < SCREEN_PAGES && ok; ++page)
+        {
+            const uint8_t *cur = fb + page * SCREEN_WIDTH;
+            uint8_t *prev = shadow + page * SCREEN_WIDTH;
+            int first = 0;
+            int last = SCREEN_WIDTH - 1;
+            if (shadow_valid && !screen_diff_page(cur, prev, SCREEN_WIDTH, first, last))
+                continue;
+
+            ok = send_span(page, first, last, cur + first);
+            if (ok)
+            {
+                memcpy(prev + first, cur + first, last - first + 1);
+                bytes += last - first + 1;
+                spans++;
+            }
+        }
+        const uint32_t bus_us = micros() - t0;
+
+        if (spans == 0 && ok)
+        {
+            stats.skipped++;
+            return;
+        }
+        shadow_valid = ok;
+        my_i2c_record(1, bus_us, ok);
+        if (ok)
+            bus_fails = 0;
+        else if (++bus_fails >= SCREEN_RECOVER_FAILS)
+        {
+            bus_fails = 0;
+            my_i2c_recover_async(1); // 恢复后影子缓冲已作废，下一帧全量重发
+        }
+        stats.frames++;
+        stats.bus_us = bus_us;
+        if (bus_us > stats.bus_max_us)
+            stats.bus_max_us = bus_us;
+        stats.bytes = bytes;
+        stats.spans = spans;
+    }
+
     void draw_group_badge(int group_number, bool enabled)
     {
         const int badge_y = 16;
@@ -118,6 +219,7 @@ void my_screen_init()
     display.print(addr, HEX);
     display.display();
 
+    screen_addr = addr;
     screen_ready = true;
     last_frame_ms = millis() - FRAME_INTERVAL_MS;
 }
@@ -134,12 +236,29 @@ void my_screen_update()
     {
         return;
     }
+    if (my_i2c_recovering(1))
+    {
+        return; // 恢复任务正在操作屏幕总线，跳过本帧
+    }
     last_frame_ms = now_ms;
+    TRACE_SCOPE(SCREEN);
 
-    my_bat_update();
-
+    const uint32_t t0 = micros();
     display.clearDisplay();
-    draw_battery(battery_voltage);
+    draw_battery(battery_voltage, robot.bat.soc);
     draw_group_badge(robot.group_cfg.group_number, robot.group_cfg.enabled);
-    display.display();
+    stats.build_us = micros() - t0;
+
+    flush_dirty();
+}
+
+void screen_write_stats(JsonObject obj)
+{
+    obj["frames"] = stats.frames;
+    obj["skipped"] = stats.skipped;
+    obj["build_us"] = stats.build_us;
+    obj["bus_us"] = stats.bus_us;
+    obj["bus_max_us"] = stats.bus_max_us;
+    obj["bytes"] = stats.bytes;
+    obj["spans"] = stats.spans;
 }
@@ -0,0 +1,355 @@
+#include "my_trace.h"
+
+#if MY_TRACE_ENABLE
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <esp_timer.h>
+#include "hal/cpu_hal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace
+{
+    static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+
+    const char *const TRACE_NAMES[TRACE_ID_COUNT] = {
+#define TRACE_NAME(id, name) name,
+        TRACE_IDS(TRACE_NAME)
+#undef TRACE_NAME
+    };
+
+    // 12 字节；对时记录的 us 字段存 esp_timer 的低 32 位
+    struct trace_evt
+    {
+        uint32_t cc; // CPU 周期计数（各核独立）
+        union
+        {
+            TaskHandle_t task;
+            uint32_t us;
+        };
+        uint16_t id;
+        uint8_t ph;
+        uint8_t isr;
+    };
+
+    // 每核一个，只由本核在关中断时写入，因此不需要原子操作
+    struct trace_ring
+    {
+        trace_evt ev[TRACE_EVENTS];
+        uint32_t written; // 累计写入条数，ev[written % TRACE_EVENTS] 为下一条
+        uint32_t sync_cc; // 最近一次对时的周期计数
+        bool synced;
+    };
+
+    trace_ring rings[portNUM_PROCESSORS];
+    volatile bool armed = false;
+    bool reading = false;    // 有读者时暂停记录
+    bool rearm = false;      // 读者关闭后恢复记录
+    uint32_t cpu_mhz = 240;
+    int64_t freeze_us = 0;   // 停止记录的时刻，导出时用来还原 64 位时间
+    uint32_t freeze_count = 0;
+
+    inline void IRAM_ATTR put(trace_ring &r, const trace_evt &e)
+    {
+        r.ev[r.written & (TRACE_EVENTS - 1)] = e;
+        r.written++;
+    }
+
+    void stop()
+    {
+        armed = false;
+        // 写入方在关中断的几十个周期内完成，停一下保证另一核上正在进行的写入已结束
+        delayMicroseconds(20);
+    }
+} // namespace
+
+void IRAM_ATTR trace_rec(uint16_t id, uint8_t ph)
+{
+    if (!armed)
+        return;
+    const UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    if (armed)
+    {
+        const BaseType_t core = xPortGetCoreID();
+        trace_ring &r = rings[core];
+        const uint32_t cc = cpu_hal_get_cycle_count();
+        if (!r.synced || cc - r.sync_cc >= TRACE_SYNC_CYCLES)
+        {
+            trace_evt s;
+            s.cc = cc;
+            s.us = static_cast<uint32_t>(esp_timer_get_time());
+            s.id = 0;
+            s.ph = TRACE_PH_SYNC;
+            s.isr = 0;
+            put(r, s);
+            r.sync_cc = cc;
+            r.synced = true;
+        }
+        trace_evt e;
+        e.cc = cc;
+        e.isr = xPortInIsrContext() ? 1 : 0;
+        e.task = e.isr ? nullptr : xTaskGetCurrentTaskHandleForCPU(core);
+        e.id = id;
+        e.ph = ph;
+        put(r, e);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+}
+
+void trace_arm()
+{
+    if (reading)
+    {
+        rearm = true;
+        return;
+    }
+    stop();
+    for (trace_ring &r : rings)
+    {
+        r.written = 0;
+        r.synced = false;
+    }
+    cpu_mhz = getCpuFrequencyMhz();
+    armed = true;
+}
+
+void IRAM_ATTR trace_freeze(uint16_t reason)
+{
+    if (!armed)
+        return;
+    if (reason < TRACE_ID_COUNT)
+        trace_rec(reason, TRACE_PH_INSTANT);
+    armed = false;
+    rearm = false;
+    freeze_us = esp_timer_get_time();
+    freeze_count++;
+}
+
+bool trace_armed()
+{
+    return armed || (reading && rearm);
+}
+
+void trace_write_state(JsonObject obj)
+{
+    obj["armed"] = trace_armed();
+    obj["freezes"] = freeze_count;
+    JsonArray ev = obj["events"].to<JsonArray>();
+    for (const trace_ring &r : rings)
+        ev.add(r.written < TRACE_EVENTS ? r.written : TRACE_EVENTS);
+}
+
+// ======================= 导出 =======================
+struct trace_reader
+{
+    enum stage_t : uint8_t
+    {
+        HEAD,
+        EVENTS,
+        NAMES,
+        TAIL,
+        DONE,
+    } stage;
+    uint8_t core;
+    uint32_t pos, end; // 当前核的读取区间（累计序号）
+    uint32_t first_sync;
+    uint32_t sync_cc;
+    int64_t sync_us;
+    int64_t ref_us; // 环中最新事件之后的 64 位时刻，用于还原对时记录的高位
+    bool comma;
+    uint8_t name_i;
+    uint8_t tid_count;
+    TaskHandle_t tids[TRACE_TID_MAX];
+    char line[160];
+    uint16_t len, off;
+};
+
+namespace
+{
+    trace_reader reader;
+
+    // 找到当前核的第一条对时记录，之前的事件向前推算时间
+    bool reader_seek_core(trace_reader &r)
+    {
+        while (r.core < portNUM_PROCESSORS)
+        {
+            const trace_ring &ring = rings[r.core];
+            r.end = ring.written;
+            r.pos = ring.written > TRACE_EVENTS ? ring.written - TRACE_EVENTS : 0;
+            for (uint32_t i = r.pos; i < r.end; ++i)
+            {
+                const trace_evt &e = ring.ev[i & (TRACE_EVENTS - 1)];
+                if (e.ph != TRACE_PH_SYNC)
+                    continue;
+                r.first_sync = i;
+                r.sync_cc = e.cc;
+                r.sync_us = r.ref_us - static_cast<uint32_t>(static_cast<uint32_t>(r.ref_us) - e.us);
+                return true;
+            }
+            r.core++;
+        }
+        return false;
+    }
+
+    uint32_t reader_tid(trace_reader &r, const trace_evt &e)
+    {
+        if (e.isr)
+            return TRACE_TID_MAX + 1 + r.core;
+        for (uint8_t i = 0; i < r.tid_count; ++i)
+            if (r.tids[i] == e.task)
+                return i + 1;
+        if (r.tid_count < TRACE_TID_MAX)
+        {
+            r.tids[r.tid_count++] = e.task;
+            return r.tid_count;
+        }
+        return 0;
+    }
+
+    void reader_printf(trace_reader &r, const char *fmt, ...)
+    {
+        va_list ap;
+        va_start(ap, fmt);
+        const int n = vsnprintf(r.line, sizeof(r.line), fmt, ap);
+        va_end(ap);
+        r.len = n < 0 ? 0 : (n >= (int)sizeof(r.line) ? sizeof(r.line) - 1 : n);
+        r.off = 0;
+    }
+
+    const char *sep(trace_reader &r)
+    {
+        const char *s = r.comma ? ",\n" : "\n";
+        r.comma = true;
+        return s;
+    }
+
+    // 生成下一行到 r.line；全部输出完返回 false
+    bool reader_next(trace_reader &r)
+    {
+        for (;;)
+        {
+            switch (r.stage)
+            {
+            case trace_reader::HEAD:
+                reader_printf(r, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+                r.stage = reader_seek_core(r) ? trace_reader::EVENTS : trace_reader::NAMES;
+                return true;
+
+            case trace_reader::EVENTS:
+            {
+                if (r.pos >= r.end)
+                {
+                    r.core++;
+                    if (!reader_seek_core(r))
+                        r.stage = trace_reader::NAMES;
+                    continue;
+                }
+                const uint32_t i = r.pos++;
+                const trace_evt &e = rings[r.core].ev[i & (TRACE_EVENTS - 1)];
+                int64_t ns;
+                if (e.ph == TRACE_PH_SYNC)
+                {
+                    if (i > r.first_sync)
+                    {
+                        r.sync_us += static_cast<uint32_t>(e.us - static_cast<uint32_t>(r.sync_us));
+                        r.sync_cc = e.cc;
+                    }
+                    continue;
+                }
+                if (i < r.first_sync)
+                {
+                    const uint32_t back = r.sync_cc - e.cc;
+                    if (back >= 0x80000000u) // 超出周期计数的回绕范围，无法还原
+                        continue;
+                    ns = r.sync_us * 1000 - (int64_t)back * 1000 / cpu_mhz;
+                }
+                else
+                {
+                    ns = r.sync_us * 1000 + (int64_t)(e.cc - r.sync_cc) * 1000 / cpu_mhz;
+                }
+                if (ns < 0 || e.id >= TRACE_ID_COUNT)
+                    continue;
+                const char ph = e.ph == TRACE_PH_BEGIN ? 'B' : (e.ph == TRACE_PH_END ? 'E' : 'i');
+                reader_printf(r, "%s{\"name\":\"%s\",\"ph\":\"%c\",%s\"ts\":%llu.%03u,\"pid\":0,\"tid\":%u}",
+                              sep(r), TRACE_NAMES[e.id], ph, ph == 'i' ? "\"s\":\"g\"," : "",
+                              (unsigned long long)(ns / 1000), (unsigned)(ns % 1000), (unsigned)reader_tid(r, e));
+                return true;
+            }
+
+            case trace_reader::NAMES:
+            {
+                // 线程名放在最后：导出过程中才知道出现过哪些任务
+                const uint8_t i = r.name_i++;
+                if (i < r.tid_count)
+                {
+                    // 本固件的任务创建后不会删除，句柄始终有效
+                    reader_printf(r, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                                  sep(r), (unsigned)(i + 1), pcTaskGetName(r.tids[i]));
+                    return true;
+                }
+                const uint8_t core = i - r.tid_count;
+                if (core < portNUM_PROCESSORS)
+                {
+                    reader_printf(r, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"ISR core %u\"}}",
+                                  sep(r), (unsigned)(TRACE_TID_MAX + 1 + core), (unsigned)core);
+                    return true;
+                }
+                r.stage = trace_reader::TAIL;
+                continue;
+            }
+
+            case trace_reader::TAIL:
+                reader_printf(r, "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"esp32\"}}\n]}\n", sep(r));
+                r.stage = trace_reader::DONE;
+                return true;
+
+            default:
+                return false;
+            }
+        }
+    }
+} // namespace
+
+trace_reader *trace_reader_open()
+{
+    if (reading)
+        return nullptr;
+    const bool was_armed = armed;
+    stop();
+    reading = true;
+    rearm = was_armed;
+
+    trace_reader &r = reader;
+    memset(&r, 0, sizeof(r));
+    r.ref_us = was_armed ? esp_timer_get_time() : freeze_us;
+    r.stage = trace_reader::HEAD;
+    return &r;
+}
+
+size_t trace_reader_fill(trace_reader *r, uint8_t *buf, size_t cap)
+{
+    size_t n = 0;
+    while (n < cap)
+    {
+        if (r->off >= r->len && !reader_next(*r))
+            break;
+        const size_t take = std::min<size_t>(cap - n, r->len - r->off);
+        memcpy(buf + n, r->line + r->off, take);
+        r->off += take;
+        n += take;
+    }
+    return n;
+}
+
+void trace_reader_close(trace_reader *r)
+{
+    if (r != &reader || !reading)
+        return;
+    reading = false;
+    if (rearm)
+        trace_arm();
+}
+
+#endif
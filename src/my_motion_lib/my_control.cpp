@@ -4,11 +4,13 @@
 #include "my_encoder.h"
 #include "my_tool.h"
 #include "my_motor.h"
+#include "my_feedforward.h"
 
 PIDController PID_ANG{robot.ang_pid.p, robot.ang_pid.i, 0, robot.ang_pid.k, robot.ang_pid.l};               // 直立控制
 PIDController PID_SPD{robot.spd_pid.p, robot.spd_pid.i, robot.spd_pid.d, robot.spd_pid.k, robot.spd_pid.l}; // 速度控制
 PIDController PID_YAW{robot.yaw_pid.p, robot.yaw_pid.i, 0, robot.yaw_pid.k, robot.yaw_pid.l};               // 偏航控制
 PIDController PID_POS{robot.pos_pid.p, robot.pos_pid.i, robot.pos_pid.d, robot.pos_pid.k, robot.pos_pid.l}; // 位置控制
+PIDController PID_HEAD{robot.head_pid.p, robot.head_pid.i, robot.head_pid.d, robot.head_pid.k, robot.head_pid.l}; // 航向保持
 
 LowPassFilter LQF_ZEROPOINT{0.1};
 LowPassFilter LQF_JOY{0.2};
@@ -23,6 +25,24 @@ namespace
         robot.motor.L_cmd = 0.0f;
         robot.motor.R_cmd = 0.0f;
     }
+
+    // 航向误差归一化到 [-180, 180)
+    inline float wrap_deg(float a)
+    {
+        while (a >= 180.0f)
+            a -= 360.0f;
+        while (a < -180.0f)
+            a += 360.0f;
+        return a;
+    }
+
+    // 释放航向锁定，下次松杆重新捕获
+    inline void heading_release()
+    {
+        robot.heading.holding = false;
+        robot.heading.err = 0.0f;
+        PID_HEAD.reset();
+    }
 }
 
 void pid_state_update()
@@ -43,6 +63,10 @@ void pid_state_update()
     PID_YAW.P = robot.yaw_pid.p;
     PID_YAW.I = robot.yaw_pid.i;
     PID_YAW.D = robot.yaw_pid.d;
+
+    PID_HEAD.P = robot.head_pid.p;
+    PID_HEAD.I = robot.head_pid.i;
+    PID_HEAD.D = robot.head_pid.d;
 }
 
 void robot_state_update()
@@ -63,6 +87,12 @@ void robot_state_update()
 
 void robot_pos_control()
 {
+    if (robot.profile.active) // 脚本执行中由运动曲线直接给出位置目标
+    {
+        robot.pos.tar = robot.profile.pos_tar;
+        robot.joy_stop_control = false;
+        return;
+    }
     if (robot.joy.y != 0) // 有前后方向运动指令时的处理
     {
         robot.pos.tar = robot.pos.now; // 位移零点重置
@@ -85,6 +115,9 @@ void pitch_control()
     robot.pos.duty = PID_POS(robot.pos.err); // 位置环输出作为速度目标修正量
 
     float joy_spd_tar = robot.joy.y_coef * LQF_JOY(robot.joy.y);
+    if (robot.profile.active)
+        joy_spd_tar = robot.profile.spd_tar; // 脚本执行中用曲线速度替代摇杆
+    feedforward_update(joy_spd_tar);
     robot.spd.tar = joy_spd_tar - robot.pos.duty; // 速度目标 = 摇杆期望 - 位置环修正
 
     robot.spd.err = robot.spd.now - robot.spd.tar;
@@ -93,7 +126,7 @@ void pitch_control()
     robot.spd.duty = PID_SPD(robot.spd.err); // 速度环输出用作角度目标修正
 
     float pitch_offset = my_lim(robot.spd.duty * RAD_TO_DEG_F, PITCH_ANGLE_OFFSET_LIMIT);
-    robot.ang.tar = robot.pitch_zero - pitch_offset;
+    robot.ang.tar = robot.pitch_zero - pitch_offset + robot.ff.ang;
     robot.ang.err = robot.ang.now - robot.ang.tar;
     if (fabsf(robot.ang.err) < PITCH_ANG_DEADBAND)
         robot.ang.err = 0.0f;
@@ -107,14 +140,16 @@ void pitch_control()
     }
     else
         robot.motor.base_duty = robot.ang.duty;
+    robot.motor.base_duty += robot.ff.tor;
     if (fabsf(robot.motor.base_duty) < PITCH_TOR_DEADBAND)
         robot.motor.base_duty = 0.0f;
 }
 
 void yaw_control()
 {
-    // 只在有明确转向指令时输出，不做航向保持
-    const float yaw_cmd_rate = robot.joy.x * robot.joy.x_coef * YAW_RATE_MAX_DEG_S;
+    // 有转向指令时按角速度前馈转向；松杆后可选航向保持
+    const float yaw_cmd_rate = robot.profile.active ? robot.profile.yaw_rate
+                                                    : robot.joy.x * robot.joy.x_coef * YAW_RATE_MAX_DEG_S;
     const float yaw_rate_now = robot.imu.gyroz;
 
     robot.yaw.tar = yaw_cmd_rate;      // 记录目标角速度便于遥测显示
@@ -124,13 +159,32 @@ void yaw_control()
     if (fabsf(yaw_cmd_rate) < YAW_RATE_CMD_DEADBAND)
     {
         PID_YAW.reset();               // 避免累积
+        if (robot.heading.enable)
+        {
+            // 松杆后等转动基本停下再锁定航向，避免把惯性转角算进误差
+            if (!robot.heading.holding && fabsf(yaw_rate_now) < HEADING_CAPTURE_RATE)
+            {
+                robot.heading.tar = robot.heading.angle;
+                robot.heading.holding = true;
+                PID_HEAD.reset();
+            }
+            if (robot.heading.holding)
+            {
+                robot.heading.err = wrap_deg(robot.heading.tar - robot.heading.angle);
+                const float hold = PID_HEAD(robot.heading.err);
+                robot.motor.yaw_duty = my_lim(hold - robot.yaw_pid.d * yaw_rate_now, robot.yaw_pid.l);
+                return;
+            }
+        }
         robot.motor.yaw_duty = -robot.yaw_pid.d * yaw_rate_now; // 只做一点阻尼
         if (fabsf(robot.motor.yaw_duty) < YAW_TORQUE_DEADBAND)
             robot.motor.yaw_duty = 0.0f;
         return;
     }
 
-    // 前馈比例转向 + 角速度阻尼，不维持航向
+    heading_release();
+
+    // 前馈比例转向 + 角速度阻尼
     const float yaw_ff = robot.yaw_pid.p * yaw_cmd_rate;
     const float yaw_damp = robot.yaw_pid.d * yaw_rate_now;
 
@@ -158,8 +212,10 @@ void duty_add()
     const float left_mix = my_lim(base + yaw, DUTY_SUM_LIM);
     const float right_mix = my_lim(base - yaw, DUTY_SUM_LIM);
 
-    motor_left_u = my_lim(-left_mix / DUTY_SUM_LIM, 1.0f);
-    motor_right_u = my_lim(-right_mix / DUTY_SUM_LIM, 1.0f);
+    // 电池电压补偿：电压下降时等比放大占空比，保持电机端电压与整定时一致
+    const float comp = robot.bat.comp;
+    motor_left_u = my_lim(-left_mix / DUTY_SUM_LIM * comp, 1.0f);
+    motor_right_u = my_lim(-right_mix / DUTY_SUM_LIM * comp, 1.0f);
 
     robot.motor.L_cmd = motor_left_u;
     robot.motor.R_cmd = motor_right_u;
@@ -171,6 +227,8 @@ void control_idle_reset()
     PID_SPD.reset();
     PID_POS.reset();
     PID_YAW.reset();
+    heading_release();
+    feedforward_reset();
 
     robot.pos.tar = robot.pos.now;
     robot.spd.tar = 0.0f;
@@ -180,36 +238,3 @@ void control_idle_reset()
     robot.motor.R_duty = 0.0f;
     clear_motor_commands();
 }
-
-void fall_check()
-{
-    // 摔倒检测
-    if (!robot.fallen.enable) // 没有启用直接返回
-        return;
-
-    const bool tipped = robot.imu.angley > FALL_MAX_PITCH || robot.imu.angley < FALL_MIN_PITCH;
-    if (tipped)
-        robot.fallen.count++;
-    else
-    {
-        robot.fallen.count = 0;
-        robot.fallen.is = false;
-    }
-    if (robot.fallen.count >= COUNT_FALL_MAX)
-        robot.fallen.is = true;
-
-    if (robot.fallen.is)
-    {
-        // 摔倒后清指令/积分，避免立起后暴冲
-        robot.group_cfg.target_linear = 0.0f;
-        robot.group_cfg.target_yaw = 0.0f;
-        robot.group_cfg.applied_linear = 0.0f;
-        robot.group_cfg.applied_yaw = 0.0f;
-        robot.joy.x = 0.0f;
-        robot.joy.y = 0.0f;
-        control_idle_reset();
-        robot.motor.L_duty = 0.0f;
-        robot.motor.R_duty = 0.0f;
-        clear_motor_commands();
-    }
-}
@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include <math.h>
+#include "my_feedforward.h"
+#include "my_motion.h"
+#include "my_pid.h"
+#include "my_profile.h"
+#include "my_tool.h"
+
+namespace
+{
+    LowPassFilter LQF_ACC{FF_ACC_TAU};
+    float last_spd_tar = 0.0f;
+    bool has_last = false;
+
+    // 指令加速度：脚本执行时直接取曲线加速度，否则对速度指令求导并低通
+    float commanded_acc(float spd_tar, float dt)
+    {
+        if (robot.profile.active)
+        {
+            // 方向取段方向：段首周期速度指令还是 0，不能据此判断正负
+            return LQF_ACC.apply(profile_dir() * robot.profile.a, dt);
+        }
+        const float raw = has_last ? (spd_tar - last_spd_tar) * ODOM_WHEEL_RADIUS_M / dt : 0.0f;
+        return LQF_ACC.apply(raw, dt);
+    }
+}
+
+void feedforward_reset()
+{
+    LQF_ACC.reset(0.0f);
+    has_last = false;
+    robot.ff.acc = 0.0f;
+    robot.ff.ang = 0.0f;
+    robot.ff.tor = 0.0f;
+}
+
+void feedforward_update(float spd_tar)
+{
+    const float dt = robot.dt_ms * 0.001f;
+    if (dt <= 0.0f)
+        return;
+
+    robot.ff.acc = my_lim(commanded_acc(spd_tar, dt), FF_ACC_LIMIT);
+    last_spd_tar = spd_tar;
+    has_last = true;
+
+    if (!robot.ff.enable)
+    {
+        robot.ff.ang = 0.0f;
+        robot.ff.tor = 0.0f;
+        return;
+    }
+
+    // 倒立摆匀加速时的平衡倾角：tan(theta) = a / g
+    const float lean = atanf(robot.ff.acc / GRAVITY_MPS2) * RAD_TO_DEG_F;
+    robot.ff.ang = my_lim(robot.ff.k_ang * lean, PITCH_ANGLE_OFFSET_LIMIT);
+    // 车体加速所需轮端力矩，按 base_duty 量纲线性折算
+    robot.ff.tor = my_lim(robot.ff.k_tor * robot.ff.acc, FF_TOR_LIMIT);
+}
+
+void feedforward_write_state(JsonObject obj)
+{
+    obj["en"] = robot.ff.enable;
+    obj["acc"] = robot.ff.acc;
+    obj["ang"] = robot.ff.ang;
+    obj["tor"] = robot.ff.tor;
+    obj["pid"] = robot.ang.duty; // 反馈项，与前馈对比
+}
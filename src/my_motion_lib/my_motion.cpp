@@ -3,7 +3,12 @@
 #include "my_motor.h"
 #include "my_control.h"
 #include "my_car_group.h"
+#include "my_odom.h"
+#include "my_profile.h"
+#include "my_supervisor.h"
 #include "my_tool.h"
+#include "my_trace.h"
+#include "my_telem_ring.h"
 
 robot_state robot = {
     // 状态指示位
@@ -32,6 +37,8 @@ robot_state robot = {
     },         // 编队状态
     // 轮子数据
     .wel = {0, 0, 0, 0},                                 // 轮子数据 wel1 , wel2, pos1, pos2
+    // 里程计 x, y, theta, v, w, cov
+    .odom = {0, 0, 0, 0, 0, {0, 0, 0, 0, 0, 0}},
     .motor = {
         .base_duty = 0.0f,
         .yaw_duty = 0.0f,
@@ -44,6 +51,8 @@ robot_state robot = {
         .R_deadzone_fwd = 0.0f,
         .R_deadzone_rev = 0.0f,
     },                             
+    // 电池 v_raw, v, ocv, current, soc, slope, t_empty_s, comp, low, brownout
+    .bat = {0, 0, 0, 0, 1.0f, 0, -1.0f, 1.0f, false, false},
     // IMU数据 anglex, angley, anglez, gyrox, gyroy, gyroz
     .imu_zero = {0, 0, 0, 0, 0, 0},
     .imu_l = {0, 0, 0, 0, 0, 0},
@@ -51,8 +60,8 @@ robot_state robot = {
     // 摇杆控制 x, y, a, r, x_coef, y_coef
     .joy = {0, 0, 0, 0, 0.1, 10.0},
     .joy_l = {0, 0, 0, 0, 0.1, 10.0},
-    // 摔倒检测 is, count, enable
-    .fallen = {false, 0, false},
+    // 摔倒检测 is, count, enable, recover, phase, phase_ms, attempts
+    .fallen = {false, 0, false, false, balance_phase::idle, 0, 0},
     // 灯珠数量，模式
     .rgb = {0, 0},
     // pid状态检测 now,last,target,error,duty
@@ -60,11 +69,18 @@ robot_state robot = {
     .spd = {0, 0, 0, 0, 0}, // 速度环状态
     .pos = {0, 0, 0, 0, 0}, // 位置环状态
     .yaw = {0, 0, 0, 0, 0}, // 偏航环状态
+    // 航向保持 enable, holding, angle, tar, err, bias, still_ms
+    .heading = {false, false, 0, 0, 0, 0, 0},
+    // 运动曲线 active, index, queued, s, v, a, yaw_rate, pos_tar, spd_tar, abort_reason
+    .profile = {false, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    // 前馈 enable, k_ang, k_tor, acc, ang, tor
+    .ff = {false, 1.0f, 0.5f, 0, 0, 0},
     // pid参数设定
     .ang_pid = {0.6f, 10.0f, 0.016f, 100000, 250}, // 直立环参数
     .spd_pid = {0.003f, 0.00f, 0.00f, 100000, 5}, // 速度环参数
     .pos_pid = {0.00f, 0.00f, 0.00f, 100000, 5}, // 位置环参数
     .yaw_pid = {0.025f, 0.00f, 0.00f, 100000, 5}, // 偏航环参数：P为转向力度，D为阻尼
+    .head_pid = {0.08f, 0.02f, 0.00f, 100000, 2}, // 航向保持参数：输入航向误差(deg)，输出偏航占空比
 };
 
 void my_motion_init()
@@ -74,28 +90,46 @@ void my_motion_init()
     my_motor_init();
 
     my_group_init();
+
+    my_odom_init();
+
+    my_profile_init();
 }
 
 void my_motion_update()
 {
     static bool last_car_group_mode = false;
+    TRACE_SCOPE(CTRL);
 
     // 编队启用即进入车组模式（关闭自平衡），关闭编队恢复自平衡
     robot.car_group_mode = robot.group_cfg.enabled || robot.car_group_manual;
 
+    TRACE_BEGIN(IMU);
     my_mpu6050_update();
+    TRACE_END(IMU);
     // 更新robot状态数据
+    TRACE_BEGIN(STATE);
     robot_state_update();
+    TRACE_END(STATE);
+    // 里程计：编码器增量 + 陀螺仪航向融合
+    TRACE_BEGIN(ODOM);
+    my_odom_update();
+    TRACE_END(ODOM);
     // 编队指令映射到本地摇杆
+    TRACE_BEGIN(GROUP);
     group_tick();
+    TRACE_END(GROUP);
 
-    // 模式切换时清积分，避免残余输出
+    // 模式切换时清积分，避免残余输出；动作脚本只在自平衡模式执行，切换时一并中止，
+    // 车组模式期间排队的段和启动请求也在切回时丢弃
     if (robot.car_group_mode != last_car_group_mode)
     {
         control_idle_reset();
         robot.joy_stop_control = false;
+        profile_abort(PROFILE_ABORT_MODE);
     }
 
+    TRACE_BEGIN(BALANCE);
     if (robot.car_group_mode)
     {
         // 车组模式：关闭自平衡，直接差速驱动
@@ -112,24 +146,32 @@ void my_motion_update()
     else
     {
         // 自平衡模式：串级 PID 控制
+        profile_tick();
         robot_pos_control();
         pitch_control();
         yaw_control();
         duty_add();
         pitch_zero_adapt();
     }
-    // 摔倒检测
-    fall_check();
+    TRACE_END(BALANCE);
+    // 摔倒检测 / 起控 / 自恢复状态机
+    TRACE_BEGIN(SUP);
+    supervisor_tick();
+    TRACE_END(SUP);
     // 测试模式
-    // 运行检查
-    if (!robot.run)
+    // 运行检查（IMU 连续失效时同样停机，等待总线恢复）
+    if (!robot.run || !my_mpu6050_ok())
     {
         control_idle_reset(); // 清积分并重置目标，避免停机时积分累积导致启用瞬间大力输出
         robot.motor.L_duty = 0.0f;
         robot.motor.R_duty = 0.0f;
     }
     // 电机执行
+    TRACE_BEGIN(MOTOR);
     my_motor_update();
+    TRACE_END(MOTOR);
+    // 本周期的状态存入曲线样本环（无人订阅曲线时直接返回）
+    telem_ring_push();
     // 记录本帧摇杆，用于下次检测松杆/回零
     robot.joy_l = robot.joy;
     last_car_group_mode = robot.car_group_mode;
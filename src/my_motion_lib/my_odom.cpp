@@ -0,0 +1,141 @@
+#include <Arduino.h>
+#include <math.h>
+#include "my_odom.h"
+#include "my_motion.h"
+
+namespace
+{
+    constexpr float DEG_TO_RAD_F = 1.0f / RAD_TO_DEG_F;
+
+    // 上一周期的轮子累计转角（rad），用于求本周期增量
+    float last_pos1 = 0.0f;
+    float last_pos2 = 0.0f;
+
+    // 清零请求：网页任务写入，控制任务在 my_odom_update 开头应用，保证位姿与 last_pos 同一周期内更新
+    struct reset_req
+    {
+        float x;
+        float y;
+        float theta;
+    };
+    reset_req reset_pose = {};
+    volatile bool reset_pending = false;
+    portMUX_TYPE reset_mux = portMUX_INITIALIZER_UNLOCKED;
+
+    inline float wrap_pi(float a)
+    {
+        while (a > PI)
+            a -= 2.0f * PI;
+        while (a < -PI)
+            a += 2.0f * PI;
+        return a;
+    }
+
+    void clear_cov()
+    {
+        for (float &c : robot.odom.cov)
+            c = 0.0f;
+    }
+
+    // 协方差传播：P = F P F^T + Q，F 为差速模型对 (x, y, theta) 的雅可比
+    void propagate_cov(float ds, float theta_mid, float dtheta_abs, float dt_s)
+    {
+        float *P = robot.odom.cov;
+        const float pxx = P[0], pxy = P[1], pxt = P[2], pyy = P[3], pyt = P[4], ptt = P[5];
+        const float a = -ds * sinf(theta_mid); // dx/dtheta
+        const float b = ds * cosf(theta_mid);  // dy/dtheta
+
+        P[0] = pxx + 2.0f * a * pxt + a * a * ptt;
+        P[1] = pxy + a * pyt + b * pxt + a * b * ptt;
+        P[2] = pxt + a * ptt;
+        P[3] = pyy + 2.0f * b * pyt + b * b * ptt;
+        P[4] = pyt + b * ptt;
+
+        // 过程噪声：距离噪声沿行驶方向，航向噪声随转角与时间累积
+        const float q_s = ODOM_DIST_NOISE * fabsf(ds);
+        const float c = cosf(theta_mid);
+        const float s = sinf(theta_mid);
+        P[0] += q_s * c * c;
+        P[1] += q_s * c * s;
+        P[3] += q_s * s * s;
+        P[5] = ptt + ODOM_HEADING_NOISE * dtheta_abs + ODOM_HEADING_DRIFT * dt_s;
+    }
+
+    void apply_reset(float x, float y, float theta)
+    {
+        robot.odom.x = x;
+        robot.odom.y = y;
+        robot.odom.theta = wrap_pi(theta);
+        robot.odom.v = 0.0f;
+        robot.odom.w = 0.0f;
+        clear_cov();
+        last_pos1 = robot.wel.pos1;
+        last_pos2 = robot.wel.pos2;
+    }
+}
+
+void my_odom_reset(float x, float y, float theta)
+{
+    portENTER_CRITICAL(&reset_mux);
+    reset_pose = {x, y, theta};
+    reset_pending = true;
+    portEXIT_CRITICAL(&reset_mux);
+}
+
+void my_odom_init()
+{
+    reset_pending = false;
+    apply_reset(0.0f, 0.0f, 0.0f);
+}
+
+void my_odom_update()
+{
+    const float dt_s = robot.dt_ms * 0.001f;
+    if (dt_s <= 0.0f)
+        return;
+
+    if (reset_pending)
+    {
+        portENTER_CRITICAL(&reset_mux);
+        const reset_req r = reset_pose;
+        reset_pending = false;
+        portEXIT_CRITICAL(&reset_mux);
+        apply_reset(r.x, r.y, r.theta);
+    }
+
+    // 编码器方向与 robot.pos.now 一致：前进时轮子转角为负
+    const float dl = -(robot.wel.pos1 - last_pos1) * ODOM_WHEEL_RADIUS_M;
+    const float dr = -(robot.wel.pos2 - last_pos2) * ODOM_WHEEL_RADIUS_M;
+    last_pos1 = robot.wel.pos1;
+    last_pos2 = robot.wel.pos2;
+
+    const float ds = 0.5f * (dl + dr);
+    const float dtheta_enc = (dr - dl) / ODOM_TRACK_WIDTH_M;
+    const float dtheta_gyro = robot.imu.gyroz * DEG_TO_RAD_F * dt_s;
+    // 运动时按固定权重融合（轮子打滑时陀螺仪更可信）；两轮都几乎不动时只取轮速差，避免积分陀螺零漂
+    const bool at_rest = fabsf(ds) < ODOM_REST_V * dt_s && fabsf(dtheta_enc) < ODOM_REST_W * dt_s;
+    const float w_gyro = at_rest ? 0.0f : ODOM_GYRO_WEIGHT;
+    const float dtheta = w_gyro * dtheta_gyro + (1.0f - w_gyro) * dtheta_enc;
+
+    // 中点积分，减小转弯时的截断误差
+    const float theta_mid = robot.odom.theta + 0.5f * dtheta;
+    robot.odom.x += ds * cosf(theta_mid);
+    robot.odom.y += ds * sinf(theta_mid);
+    robot.odom.theta = wrap_pi(robot.odom.theta + dtheta);
+    robot.odom.v = ds / dt_s;
+    robot.odom.w = dtheta / dt_s;
+
+    propagate_cov(ds, theta_mid, fabsf(dtheta), dt_s);
+}
+
+void odom_write_state(JsonObject obj)
+{
+    obj["x"] = robot.odom.x;
+    obj["y"] = robot.odom.y;
+    obj["th"] = robot.odom.theta;
+    obj["v"] = robot.odom.v;
+    obj["w"] = robot.odom.w;
+    JsonArray cov = obj["cov"].to<JsonArray>();
+    for (float c : robot.odom.cov)
+        cov.add(c);
+}
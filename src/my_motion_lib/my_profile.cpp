@@ -0,0 +1,280 @@
+#include <Arduino.h>
+#include <math.h>
+#include <strings.h>
+#include "my_profile.h"
+#include "my_motion.h"
+#include "my_tool.h"
+
+namespace
+{
+    // 单生产者（网页任务）/单消费者（控制任务）环形队列，head 只由生产者写，tail 只由消费者写
+    profile_segment queue[PROFILE_QUEUE_LEN];
+    volatile uint32_t q_head = 0;
+    volatile uint32_t q_tail = 0;
+
+    volatile bool start_req = false;
+    volatile bool stop_req = false;
+
+    bool seg_loaded = false;   // 当前段是否已装载
+    profile_segment cur = {};  // 当前段（取绝对值后的参数）
+    float dir = 1.0f;          // 行驶方向
+    float seg_len = 0.0f;      // 当前段距离绝对值（m）
+    float pos_origin = 0.0f;   // 当前段起点（轮子转角 rad）
+    uint32_t seg_elapsed_ms = 0;
+
+    inline uint32_t queue_count()
+    {
+        return q_head - q_tail;
+    }
+
+    inline float approach(float now, float tar, float step)
+    {
+        if (now < tar)
+            return now + step < tar ? now + step : tar;
+        return now - step > tar ? now - step : tar;
+    }
+
+    // 从 (v, a) 出发在加加速度 J、减速度 A 限制下停车所需距离
+    float stop_distance(float v, float a, float A, float J)
+    {
+        float d = 0.0f;
+        if (a > 0.0f)
+        {
+            // 先把正加速度降到 0
+            const float t0 = a / J;
+            d += v * t0 + 0.5f * a * t0 * t0 - J * t0 * t0 * t0 / 6.0f;
+            v += 0.5f * a * a / J;
+        }
+        if (v <= 0.0f)
+            return d;
+        const float v_knee = A * A / J;
+        if (v >= v_knee)
+            return d + 0.5f * v * (v / A + A / J); // 有匀减速段
+        return d + v * sqrtf(v / J);               // 仅加加速度段
+    }
+
+    void sanitize(profile_segment &s)
+    {
+        s.v = my_lim(fabsf(s.v), 0.01f, PROFILE_V_MAX);
+        s.a = my_lim(fabsf(s.a), 0.05f, PROFILE_A_MAX);
+        s.j = my_lim(fabsf(s.j), 0.1f, PROFILE_J_MAX);
+        s.w = my_lim(s.w, YAW_RATE_MAX_DEG_S);
+    }
+
+    bool load_next()
+    {
+        if (queue_count() == 0)
+            return false;
+        cur = queue[q_tail % PROFILE_QUEUE_LEN];
+        q_tail = q_tail + 1;
+        dir = cur.d < 0.0f ? -1.0f : 1.0f;
+        seg_len = fabsf(cur.d);
+        pos_origin = robot.profile.pos_tar;
+        seg_elapsed_ms = 0;
+        robot.profile.s = 0.0f;
+        seg_loaded = true;
+        return true;
+    }
+
+    void finish_segment()
+    {
+        // 段结束时把位置目标落到精确终点，剩余误差交给位置环
+        robot.profile.pos_tar = pos_origin + dir * seg_len / ODOM_WHEEL_RADIUS_M;
+        robot.profile.index++;
+        seg_loaded = false;
+    }
+
+    // 直线段：在线加加速度受限规划，每周期常数时间
+    bool step_distance(float dt)
+    {
+        const float A = cur.a;
+        const float J = cur.shape == profile_shape::scurve ? cur.j : 1e6f;
+        float v = robot.profile.v;
+        float a = robot.profile.a;
+        const float remain = seg_len - robot.profile.s;
+
+        float a_tar;
+        if (remain <= stop_distance(v, a, A, J))
+            a_tar = -A;
+        else if (v + (a > 0.0f ? 0.5f * a * a / J : 0.0f) < cur.v)
+            a_tar = A;
+        else
+            a_tar = 0.0f;
+
+        a = cur.shape == profile_shape::scurve ? approach(a, a_tar, J * dt) : a_tar;
+        v += a * dt;
+        if (v > cur.v)
+        {
+            v = cur.v;
+            if (a > 0.0f)
+                a = 0.0f;
+        }
+        // 减速中速度过零即结束本段：S 型的加速度回零跟不上时，不能让速度反向倒车
+        if (v <= 0.0f && a < 0.0f)
+        {
+            robot.profile.v = 0.0f;
+            robot.profile.a = 0.0f;
+            return true;
+        }
+        robot.profile.s += v * dt;
+        robot.profile.v = v;
+        robot.profile.a = a;
+        if (robot.profile.s >= seg_len)
+        {
+            robot.profile.s = seg_len;
+            robot.profile.v = 0.0f;
+            robot.profile.a = 0.0f;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t safety_check()
+    {
+        if (!robot.run)
+            return PROFILE_ABORT_RUN;
+        if (robot.fallen.is)
+            return PROFILE_ABORT_FALL;
+        if (robot.joy.x != 0.0f || robot.joy.y != 0.0f)
+            return PROFILE_ABORT_JOY;
+        if (fabsf(robot.ang.err) > PROFILE_ABORT_PITCH)
+            return PROFILE_ABORT_PITCH;
+        return PROFILE_ABORT_NONE;
+    }
+}
+
+profile_shape profile_shape_from_string(const char *shape)
+{
+    if (shape && (!strcasecmp(shape, "trap") || !strcasecmp(shape, "trapezoid")))
+        return profile_shape::trapezoid;
+    return profile_shape::scurve;
+}
+
+void my_profile_init()
+{
+    q_head = 0;
+    q_tail = 0;
+    start_req = false;
+    stop_req = false;
+    seg_loaded = false;
+    robot.profile = {};
+}
+
+bool profile_push(const profile_segment &seg)
+{
+    if (queue_count() >= PROFILE_QUEUE_LEN)
+        return false;
+    profile_segment s = seg;
+    sanitize(s);
+    queue[q_head % PROFILE_QUEUE_LEN] = s;
+    q_head = q_head + 1; // 先写数据再发布索引
+    return true;
+}
+
+void profile_start()
+{
+    start_req = true;
+}
+
+void profile_stop()
+{
+    stop_req = true;
+}
+
+void profile_abort(uint8_t reason)
+{
+    q_tail = q_head; // 消费端清空队列
+    start_req = false;
+    if (!robot.profile.active)
+        return;
+    seg_loaded = false;
+    robot.profile.active = false;
+    robot.profile.v = 0.0f;
+    robot.profile.a = 0.0f;
+    robot.profile.yaw_rate = 0.0f;
+    robot.profile.spd_tar = 0.0f;
+    robot.profile.queued = 0;
+    robot.profile.abort_reason = reason;
+    robot.pos.tar = robot.pos.now; // 原地停住
+}
+
+void profile_tick()
+{
+    if (stop_req)
+    {
+        stop_req = false;
+        profile_abort(PROFILE_ABORT_USER);
+    }
+
+    if (start_req && !robot.profile.active)
+    {
+        start_req = false;
+        robot.profile.active = true;
+        robot.profile.index = 0;
+        robot.profile.v = 0.0f;
+        robot.profile.a = 0.0f;
+        robot.profile.yaw_rate = 0.0f;
+        robot.profile.pos_tar = robot.pos.now;
+        robot.profile.abort_reason = PROFILE_ABORT_NONE;
+        seg_loaded = false;
+    }
+
+    if (!robot.profile.active)
+        return;
+
+    const uint8_t reason = safety_check();
+    if (reason != PROFILE_ABORT_NONE)
+    {
+        profile_abort(reason);
+        return;
+    }
+
+    if (!seg_loaded && !load_next())
+    {
+        // 脚本执行完毕，保持终点位置
+        robot.profile.active = false;
+        robot.profile.spd_tar = 0.0f;
+        robot.profile.yaw_rate = 0.0f;
+        robot.profile.queued = 0;
+        return;
+    }
+
+    const float dt = robot.dt_ms * 0.001f;
+    bool done;
+    if (seg_len > 0.0f)
+    {
+        done = step_distance(dt);
+    }
+    else
+    {
+        seg_elapsed_ms += robot.dt_ms;
+        done = seg_elapsed_ms >= cur.t_ms;
+    }
+
+    // 偏航角速度按斜率逼近目标，段结束时回零
+    const float yaw_goal = done ? 0.0f : cur.w;
+    robot.profile.yaw_rate = approach(robot.profile.yaw_rate, yaw_goal, PROFILE_YAW_ACC * dt);
+
+    robot.profile.spd_tar = dir * robot.profile.v / ODOM_WHEEL_RADIUS_M;
+    if (done)
+        finish_segment();
+    else
+        robot.profile.pos_tar = pos_origin + dir * robot.profile.s / ODOM_WHEEL_RADIUS_M;
+    robot.profile.queued = static_cast<int>(queue_count());
+}
+
+float profile_dir()
+{
+    return dir;
+}
+
+void profile_write_state(JsonObject obj)
+{
+    obj["active"] = robot.profile.active;
+    obj["index"] = robot.profile.index;
+    obj["queued"] = robot.profile.queued;
+    obj["s"] = robot.profile.s;
+    obj["v"] = robot.profile.v;
+    obj["w"] = robot.profile.yaw_rate;
+    obj["abort"] = robot.profile.abort_reason;
+}
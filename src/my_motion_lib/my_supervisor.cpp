@@ -0,0 +1,319 @@
+#include <Arduino.h>
+#include <math.h>
+#include "my_supervisor.h"
+#include "my_control.h"
+#include "my_motion.h"
+#include "my_motor.h"
+
+namespace
+{
+    // 读者最多取最近 SUPERVISOR_LOG_LEN 条；多留的槽位保证控制任务正在写的那格不在读取范围内
+    constexpr uint32_t LOG_SLOTS = SUPERVISOR_LOG_LEN * 2;
+    supervisor_event log_buf[LOG_SLOTS];
+    uint32_t log_count = 0;          // 累计条数，取模得到写入位置；只由控制任务写
+    uint32_t log_printed = 0;        // 已打印到串口的条数，只由打印任务使用
+
+    uint32_t load_log_count()
+    {
+        return __atomic_load_n(&log_count, __ATOMIC_ACQUIRE);
+    }
+
+    // 把 [from, total) 的条目复制到 out（out[0] 对应 from），total - from 不超过 SUPERVISOR_LOG_LEN。
+    // 读者在其他任务：复制期间控制任务可能已绕回覆盖了最旧的几条，复制后重新读取条数，返回仍完整的第一条序号
+    uint32_t log_copy(uint32_t from, uint32_t total, supervisor_event *out)
+    {
+        for (uint32_t i = from; i != total; ++i)
+            out[i - from] = log_buf[i % LOG_SLOTS];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE); // 复制完成后再读条数
+        const uint32_t now_count = __atomic_load_n(&log_count, __ATOMIC_RELAXED);
+        while (from != total && now_count - from >= LOG_SLOTS)
+            from++;
+        return from;
+    }
+
+    uint32_t cond_since_ms = 0; // 当前状态下某个条件开始满足的时间，0 表示未满足
+
+    inline float pitch_rel()
+    {
+        return robot.imu.angley - robot.pitch_zero;
+    }
+
+    void enter(balance_phase to, uint32_t now)
+    {
+        const balance_phase from = robot.fallen.phase;
+        if (from == to)
+            return;
+        robot.fallen.phase = to;
+        robot.fallen.phase_ms = now;
+        cond_since_ms = 0;
+
+        const uint32_t n = log_count;
+        __atomic_thread_fence(__ATOMIC_RELEASE); // 上一次的条数先于本条内容可见，读者据此判断被覆盖的条目
+        supervisor_event &e = log_buf[n % LOG_SLOTS];
+        e.ms = now;
+        e.from = from;
+        e.to = to;
+        __atomic_store_n(&log_count, n + 1, __ATOMIC_RELEASE); // 串口输出由 supervisor_log_poll 在低优先级任务完成
+    }
+
+    // 条件持续满足 hold_ms 后返回 true
+    bool held(bool cond, uint32_t now, uint32_t hold_ms)
+    {
+        if (!cond)
+        {
+            cond_since_ms = 0;
+            return false;
+        }
+        if (cond_since_ms == 0)
+            cond_since_ms = now ? now : 1;
+        return now - cond_since_ms >= hold_ms;
+    }
+
+    // 摔倒后清指令/积分，避免立起后暴冲
+    void cut_outputs()
+    {
+        robot.group_cfg.target_linear = 0.0f;
+        robot.group_cfg.target_yaw = 0.0f;
+        robot.group_cfg.applied_linear = 0.0f;
+        robot.group_cfg.applied_yaw = 0.0f;
+        robot.joy.x = 0.0f;
+        robot.joy.y = 0.0f;
+        control_idle_reset();
+    }
+
+    bool upright()
+    {
+        return fabsf(pitch_rel()) < ARM_PITCH_WINDOW && fabsf(robot.imu.gyroy) < ARM_RATE_MAX;
+    }
+
+    // 倾倒判定：超过硬阈值；或倾角较大且仍朝同方向快速倾倒；或轮速饱和仍无法拉回
+    bool tipping()
+    {
+        const float p = pitch_rel();
+        if (robot.imu.angley > FALL_MAX_PITCH || robot.imu.angley < FALL_MIN_PITCH)
+            return true;
+        if (fabsf(p) > FALL_RATE_PITCH)
+        {
+            const bool diverging = p * robot.imu.gyroy > 0.0f && fabsf(robot.imu.gyroy) > FALL_RATE_MAX;
+            const bool saturated = fabsf(robot.spd.now) > FALL_WHEEL_MAX;
+            return diverging || saturated;
+        }
+        return false;
+    }
+
+    bool settled()
+    {
+        return fabsf(robot.imu.gyroy) < SETTLE_RATE_MAX && fabsf(robot.spd.now) < SETTLE_WHEEL_MAX;
+    }
+
+    void drive_both(float u)
+    {
+        motor_left_u = u;
+        motor_right_u = u;
+        robot.motor.L_cmd = u;
+        robot.motor.R_cmd = u;
+    }
+
+    // 车组模式不做自平衡：沿用原先的简单倾倒切断
+    void legacy_check()
+    {
+        const bool tipped = robot.imu.angley > FALL_MAX_PITCH || robot.imu.angley < FALL_MIN_PITCH;
+        if (tipped)
+            robot.fallen.count++;
+        else
+        {
+            robot.fallen.count = 0;
+            robot.fallen.is = false;
+        }
+        if (robot.fallen.count >= COUNT_FALL_MAX)
+            robot.fallen.is = true;
+        if (robot.fallen.is)
+            cut_outputs();
+    }
+}
+
+const char *balance_phase_to_string(balance_phase phase)
+{
+    switch (phase)
+    {
+    case balance_phase::idle:
+        return "idle";
+    case balance_phase::arming:
+        return "arming";
+    case balance_phase::balancing:
+        return "balancing";
+    case balance_phase::falling:
+        return "falling";
+    case balance_phase::fallen:
+        return "fallen";
+    case balance_phase::recovering:
+        return "recovering";
+    }
+    return "unknown";
+}
+
+void supervisor_tick()
+{
+    const uint32_t now = millis();
+
+    if (!robot.fallen.enable)
+    {
+        // 未启用监控：保持原行为，运行开关直接决定是否平衡
+        robot.fallen.is = false;
+        robot.fallen.count = 0;
+        enter(robot.run ? balance_phase::balancing : balance_phase::idle, now);
+        return;
+    }
+
+    if (robot.car_group_mode)
+    {
+        legacy_check();
+        return;
+    }
+
+    switch (robot.fallen.phase)
+    {
+    case balance_phase::idle:
+        if (robot.run)
+            enter(robot.fallen.is ? balance_phase::fallen : balance_phase::arming, now);
+        break;
+
+    case balance_phase::arming:
+        cut_outputs();
+        if (!robot.run)
+            enter(balance_phase::idle, now);
+        else if (held(upright(), now, ARM_HOLD_MS))
+        {
+            robot.fallen.is = false;
+            robot.fallen.attempts = 0;
+            control_idle_reset();
+            enter(balance_phase::balancing, now);
+        }
+        break;
+
+    case balance_phase::balancing:
+        if (!robot.run)
+        {
+            enter(balance_phase::idle, now);
+            break;
+        }
+        robot.fallen.count = tipping() ? robot.fallen.count + 1 : 0;
+        if (robot.fallen.count >= COUNT_FALL_MAX)
+        {
+            robot.fallen.count = 0;
+            robot.fallen.is = true;
+            cut_outputs();
+            enter(balance_phase::falling, now);
+        }
+        break;
+
+    case balance_phase::falling:
+        cut_outputs();
+        if (upright())
+            enter(robot.run ? balance_phase::arming : balance_phase::idle, now); // 被人扶住
+        else if (held(settled(), now, SETTLE_MS))
+            enter(balance_phase::fallen, now);
+        break;
+
+    case balance_phase::fallen:
+        cut_outputs();
+        robot.fallen.is = true;
+        if (held(upright(), now, ARM_HOLD_MS))
+        {
+            // 被人扶起：撤销摔倒标志，由运行开关决定是否重新起控
+            robot.fallen.is = false;
+            robot.fallen.attempts = 0;
+            enter(robot.run ? balance_phase::arming : balance_phase::idle, now);
+        }
+        else if (robot.run && robot.fallen.recover && robot.fallen.attempts < RECOVER_MAX_ATTEMPTS)
+        {
+            if (now - robot.fallen.phase_ms >= RECOVER_WAIT_MS)
+            {
+                robot.fallen.attempts++;
+                enter(balance_phase::recovering, now);
+            }
+        }
+        else if (robot.run)
+        {
+            robot.run = false; // 无法自恢复：解除运行，等待人工处理
+        }
+        break;
+
+    case balance_phase::recovering:
+    {
+        if (!robot.run)
+        {
+            cut_outputs();
+            enter(balance_phase::fallen, now);
+            break;
+        }
+        const uint32_t t = now - robot.fallen.phase_ms;
+        if (fabsf(pitch_rel()) < RECOVER_CATCH_PITCH)
+        {
+            // 已回到可控范围，清积分后交还平衡控制
+            control_idle_reset();
+            robot.fallen.is = false;
+            enter(balance_phase::balancing, now);
+            break;
+        }
+        if (t >= RECOVER_TIMEOUT_MS)
+        {
+            cut_outputs();
+            enter(balance_phase::fallen, now);
+            break;
+        }
+        // 先反向蓄势，再朝倾倒方向冲击，让车体反作用力矩把重心甩回
+        control_idle_reset();
+        const float toward = pitch_rel() > 0.0f ? -1.0f : 1.0f; // 与 duty_add 中的符号约定一致
+        if (t < RECOVER_WIND_MS)
+            drive_both(-toward * RECOVER_WIND_DUTY);
+        else if (t < RECOVER_WIND_MS + RECOVER_KICK_MS)
+            drive_both(toward * RECOVER_KICK_DUTY);
+        else
+            drive_both(0.0f);
+        break;
+    }
+    }
+}
+
+void supervisor_log_poll()
+{
+    const uint32_t total = load_log_count();
+    if (total == log_printed)
+        return;
+    const uint32_t from = total - log_printed > SUPERVISOR_LOG_LEN ? total - SUPERVISOR_LOG_LEN : log_printed;
+    supervisor_event copy[SUPERVISOR_LOG_LEN];
+    const uint32_t first = log_copy(from, total, copy);
+    if (first != log_printed)
+        Serial.printf("[SUP] 丢失 %lu 条切换日志\n", (unsigned long)(first - log_printed));
+    for (uint32_t i = first; i != total; ++i)
+    {
+        const supervisor_event &e = copy[i - from];
+        Serial.printf("[SUP] %lu ms %s -> %s\n", (unsigned long)e.ms,
+                      balance_phase_to_string(e.from), balance_phase_to_string(e.to));
+    }
+    log_printed = total;
+}
+
+void supervisor_write_state(JsonObject obj)
+{
+    obj["phase"] = balance_phase_to_string(robot.fallen.phase);
+    obj["since_ms"] = millis() - robot.fallen.phase_ms;
+    obj["recover"] = robot.fallen.recover;
+    obj["attempts"] = robot.fallen.attempts;
+}
+
+void supervisor_write_log(JsonArray arr)
+{
+    const uint32_t total = load_log_count();
+    const uint32_t from = total < SUPERVISOR_LOG_LEN ? 0 : total - SUPERVISOR_LOG_LEN;
+    supervisor_event copy[SUPERVISOR_LOG_LEN];
+    for (uint32_t i = log_copy(from, total, copy); i != total; ++i)
+    {
+        const supervisor_event &e = copy[i - from];
+        JsonObject o = arr.add<JsonObject>();
+        o["ms"] = e.ms;
+        o["from"] = balance_phase_to_string(e.from);
+        o["to"] = balance_phase_to_string(e.to);
+    }
+}
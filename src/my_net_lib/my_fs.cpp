@@ -1,66 +1,86 @@
-#include <sys/stat.h>
+#include <string.h>
 #include "my_net_config.h"
+#include "my_assets_manifest.h"
 
-// LittleFS mount point (default in Arduino-ESP32)
-static constexpr const char *FS_BASE_PATH = "/littlefs";
+// 启动时扫描得到的 LittleFS 覆盖文件（空串表示无覆盖）
+static String asset_override[ASSET_COUNT];
 
-// stat-based exists check to avoid VFS warning logs on missing files
-static bool fsExistsNoLog(const String &path)
+// ======================= 静态资源清单 =======================
+// 清单按 url 排序，二分查找；运行时不访问文件系统元数据
+const asset_entry *assetFind(const char *url)
 {
-    struct stat st {};
-    String full = String(FS_BASE_PATH) + path;
-    return stat(full.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    size_t lo = 0;
+    size_t hi = ASSET_COUNT;
+    while (lo < hi)
+    {
+        const size_t mid = (lo + hi) / 2;
+        const int cmp = strcmp(url, ASSETS[mid].url);
+        if (cmp == 0)
+            return &ASSETS[mid];
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return nullptr;
 }
-// ======================= MIME & 静态文件 =======================
-static String contentType(const String &path)
+
+// 只在启动时检查一次 LittleFS 中是否有同名（或 .gz）文件
+void assetsScanOverrides()
 {
-    if (path.endsWith(".htm") || path.endsWith(".html"))
-        return "text/html; charset=utf-8";
-    if (path.endsWith(".css"))
-        return "text/css; charset=utf-8";
-    if (path.endsWith(".js"))
-        return "application/javascript; charset=utf-8";
-    if (path.endsWith(".json"))
-        return "application/json; charset=utf-8";
-    if (path.endsWith(".png"))
-        return "image/png";
-    if (path.endsWith(".jpg") || path.endsWith(".jpeg"))
-        return "image/jpeg";
-    if (path.endsWith(".gif"))
-        return "image/gif";
-    if (path.endsWith(".svg"))
-        return "image/svg+xml";
-    if (path.endsWith(".ico"))
-        return "image/x-icon";
-    if (path.endsWith(".txt"))
-        return "text/plain; charset=utf-8";
-    return "application/octet-stream";
+    for (size_t i = 0; i < ASSET_COUNT; ++i)
+    {
+        const String raw = ASSETS[i].url;
+        const String gz = raw + ".gz";
+        if (FSYS.exists(gz))
+            asset_override[i] = gz;
+        else if (FSYS.exists(raw))
+            asset_override[i] = raw;
+        else
+            continue;
+        Serial.printf("[WEB] LittleFS override: %s\n", asset_override[i].c_str());
+    }
 }
 
 bool handleFileRead(AsyncWebServerRequest *req, String path)
 {
     if (path.endsWith("/"))
         path += "home.html"; // 默认页
-    const String gz = path + ".gz";
-    const String type = contentType(path);
+    const asset_entry *a = assetFind(path.c_str());
+    if (!a)
+        return false;
 
-    const bool hasGz = fsExistsNoLog(gz);
-    const bool hasRaw = fsExistsNoLog(path);
-
-    if (hasGz)
+    // 覆盖文件：无 ETag，每次重新读取
+    const String &override_path = asset_override[a - ASSETS];
+    if (override_path.length() > 0)
     {
-        auto *res = req->beginResponse(FSYS, gz, type);
-        res->addHeader("Content-Encoding", "gzip");
-        res->addHeader("Cache-Control", "public, max-age=604800");
-        req->send(res);
-        return true;
+        TRACE_BEGIN(FS_READ);
+        File f = FSYS.open(override_path, "r");
+        TRACE_END(FS_READ);
+        if (f)
+        {
+            auto *res = req->beginResponse(f, path, a->mime); // .gz 文件自动加 Content-Encoding
+            res->addHeader("Cache-Control", "no-store");
+            req->send(res);
+            return true;
+        }
     }
-    if (hasRaw)
+
+    // 内容未变化：浏览器缓存仍有效
+    if (req->hasHeader("If-None-Match") && req->header("If-None-Match") == a->etag)
     {
-        auto *res = req->beginResponse(FSYS, path, type);
-        res->addHeader("Cache-Control", "public, max-age=604800");
+        auto *res = req->beginResponse(304);
+        res->addHeader("ETag", a->etag);
+        res->addHeader("Cache-Control", "no-cache");
         req->send(res);
         return true;
     }
-    return false;
+
+    // 直接从映射的 Flash 发送
+    auto *res = req->beginResponse(200, a->mime, a->data, a->len);
+    res->addHeader("Content-Encoding", "gzip");
+    res->addHeader("ETag", a->etag);
+    res->addHeader("Cache-Control", "no-cache");
+    req->send(res);
+    return true;
 }
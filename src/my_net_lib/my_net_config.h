@@ -6,6 +6,10 @@
 #include <FS.h>
 #include <LittleFS.h>
 #include "my_net.h"
+#include "my_trace.h"
+#include "my_telem_schema.h"
+#include "my_telem_codec.h"
+#include "my_telem_ring.h"
 
 // 变量暴露
 // 文件系统
@@ -15,33 +19,111 @@
 #define REFRESH_RATE_DEF 10
 #define REFRESH_RATE_MAX 60
 #define REFRESH_RATE_MIN 1
+// 遥测订阅
+#define WS_SUB_MAX DEFAULT_MAX_WS_CLIENTS
+// 分发层
+#define WS_COALESCE_DEPTH 2    // 客户端队列深度达到该值时遥测只保留最新一帧
+#define WS_RELIABLE_MAX 16     // 每个客户端待发的可靠消息上限，溢出即断开让前端重连同步
+#define WS_CLEANUP_MS 1000     // 清理断开客户端的周期
+#define WS_KEEPALIVE_S 15      // 自动 ping 周期
+// SSE 只读遥测（/events）
+#define SSE_MAX_CLIENTS 4      // 同时连接的 SSE 客户端上限
+#define SSE_PERIOD_MS 100      // 推送周期，与 WS 客户端的订阅频率无关
+#define SSE_CHANNELS TELEM_CH_DEFAULT
+#define SSE_DROP_DEPTH 2       // 客户端库内队列达到该深度时跳过本帧
+#define SSE_STALL_MAX 50       // 连续跳过该帧数（约 5 s）后断开
+#define SSE_RETRY_MS 2000      // 浏览器断线重连间隔
 
-struct ChartConfig
+// 发送策略
+enum ws_policy : uint8_t
 {
-    const char *title;
-    const char *legend[3];
+    WS_POLICY_COALESCE, // 遥测：队列拥塞时合并为最新一帧
+    WS_POLICY_RELIABLE, // 配置应答/状态：不丢弃，按序补发
+    WS_POLICY_STREAM    // 曲线差分流（二进制）：单独一个槽，拥塞时同样只留最新一帧，但丢帧要告知编码端
 };
 
-struct SliderGroup
+// 遥测通道（位掩码），客户端按需订阅
+enum telem_channel : uint8_t
 {
-    const char *group;
-    const char *names[3];
+    TELEM_CH_ATT = 1 << 0,    // 姿态、摔倒/监控状态、航向
+    TELEM_CH_LOOPS = 1 << 1,  // 控制环曲线、前馈
+    TELEM_CH_MOTORS = 1 << 2, // 电机指令与轮速
+    TELEM_CH_GROUP = 1 << 3,  // 编队
+    TELEM_CH_BAT = 1 << 4,    // 电池
+    TELEM_CH_ODOM = 1 << 5,   // 里程计与动作脚本
+    TELEM_CH_DIAG = 1 << 6,   // 堆/栈/CPU 诊断，只在新快照产生时推送（约 1 Hz），不随遥测频率
+};
+#define TELEM_CH_DEFAULT (TELEM_CH_ATT | TELEM_CH_GROUP | TELEM_CH_BAT | TELEM_CH_ODOM)
+
+// 本周期需要推送的客户端
+struct ws_sub_due
+{
+    uint32_t id;
+    uint8_t mask;
+    telem_plot plot;   // loops 通道的曲线偏移表
+    telem_codec codec; // 该客户端曲线流的差分参考
+    telem_batch batch; // 该客户端的样本游标与抽样间隔
+};
+
+// 静态资源清单项，由 tools/build_assets.py 生成
+struct asset_entry
+{
+    const char *url;     // 请求路径
+    const uint8_t *data; // 嵌入 Flash 的 gzip 数据
+    const char *mime;
+    const char *etag;    // 强 ETag（带引号）
+    uint32_t len;        // 压缩后长度
 };
 
 // 异步服务器对象
 extern AsyncWebServer server;
 extern AsyncWebSocket ws;
 
-void web_pid_set(JsonObject param);
+void web_pid_set(JsonObjectConst param);
 void web_pid_get(AsyncWebSocketClient *c);
+// 字段表生成的编码（my_telem_schema.h）
+void telem_plot_default(telem_plot &p);                        // 带 TELEM_F_CHART 的字段，每组一张图
+void telem_plot_resolve(JsonArrayConst charts, telem_plot &p); // [[key...] x 图表数] -> 偏移表，只在选择变化时调用
+void telem_plot_write(const telem_plot &p, JsonArray charts);  // 同 ui_config.charts 格式
+void schema_write_ui(JsonObject doc);            // ui_config 的 charts / sliders
+void schema_write(JsonObject obj);               // /api/schema：全部字段及分组
+bool schema_params_set(JsonObjectConst param);   // 按键写入参数，返回是否有改动
+void schema_params_get(JsonObject param);
 void web_joystick(float x, float y, float a);
 // fs函数
-static String contentType(const String &path);
+const asset_entry *assetFind(const char *url);
+void assetsScanOverrides();
+// 订阅函数
+void ws_sub_init(); // 在注册 WebSocket 回调前调用
+void ws_sub_add(uint32_t id);
+void ws_sub_remove(uint32_t id);
+void ws_sub_set(uint32_t id, JsonArrayConst ch, int hz); // ch 为空时保持原通道，hz <= 0 时保持原频率
+void ws_sub_set_rate(uint32_t id, int hz);
+void ws_sub_set_channel(uint32_t id, uint8_t ch, bool on);
+void ws_sub_set_plot(uint32_t id, const telem_plot &plot);
+void ws_sub_set_stream(uint32_t id, const telem_codec &codec, const telem_batch &batch); // 编码后写回曲线流状态
+size_t ws_sub_collect(uint32_t now_ms, ws_sub_due *out); // 取出到期的客户端并推进其下次时间
+size_t ws_sub_find(uint8_t ch, uint32_t *ids);            // 订阅了某通道的客户端
+void ws_sub_write(uint32_t id, JsonObject obj);
+// 分发函数（可在任意任务投递，实际发送只在 telem 任务的 ws_fanout_pump 中进行）
+void ws_fanout_init();
+void ws_fanout_add(uint32_t id);
+void ws_fanout_remove(uint32_t id);
+bool wsPost(uint32_t id, AsyncWebSocketSharedBuffer buf, ws_policy policy); // 返回 false 表示覆盖了尚未发出的流帧
+void wsPostAll(AsyncWebSocketSharedBuffer buf, ws_policy policy);
+void ws_fanout_pump();
+void ws_fanout_write(JsonArray arr);
+void tcp_queue_write(JsonObject obj); // AsyncTCP 事件队列计数
+void ws_pool_write(JsonObject obj);   // WS 缓冲池占用 / 峰值 / 回退到堆的次数
+// SSE 函数（my_web_sse.cpp）
+void sse_init();
+bool sse_due(uint32_t now_ms);                          // 到推送时刻且有 SSE 客户端
+void sse_push(const AsyncWebSocketSharedBuffer &json);  // json 为 SSE_CHANNELS 的遥测，可直接用 WS 路径的缓冲
+void sse_write_state(JsonObject obj);
 // webtool函数
 void wsSendTo(AsyncWebSocketClient *c, const JsonDocument &doc);
-void my_wsheart();
-bool wsCanBroadcast();
 void wsBroadcast(const JsonDocument &doc);
+AsyncWebSocketSharedBuffer wsEncode(const JsonDocument &doc);
 bool handleFileRead(AsyncWebServerRequest *req, String path);
 // tool函数
 float my_db(float value, float deadband);
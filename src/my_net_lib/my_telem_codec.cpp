@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include <cmath>
+#include "hal/cpu_hal.h"
+#include "my_telem_codec.h"
+
+namespace
+{
+    // 量化后的取值范围，保证两值之差不溢出 int32
+    constexpr int32_t Q_MAX = (1 << 30) - 1;
+
+    // 只在 telem 任务中更新
+    struct codec_stats
+    {
+        uint32_t frames;
+        uint32_t keys;
+        uint32_t samples;
+        uint32_t bytes;
+        uint32_t raw;    // 同样的值按 f32 发送需要的字节数
+        uint64_t cycles; // 累计编码耗时（CPU 周期）
+        uint32_t cycles_max;
+    } stats = {};
+
+    int32_t quantize(float v, float res, int32_t prev)
+    {
+        if (!std::isfinite(v))
+            return prev; // 无效值沿用上一帧，不打断差分
+        const float q = v / (res > 0.0f ? res : 1.0f);
+        if (q >= Q_MAX)
+            return Q_MAX;
+        if (q <= -Q_MAX)
+            return -Q_MAX;
+        return static_cast<int32_t>(lroundf(q));
+    }
+
+    void put_varint(uint8_t *&p, int32_t v)
+    {
+        uint32_t z = (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+        while (z >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(z | 0x80);
+            z >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(z);
+    }
+} // namespace
+
+bool telem_codec_same(const telem_codec &a, const telem_codec &b)
+{
+    if (!a.valid || !b.valid)
+        return a.valid == b.valid;
+    return a.seq == b.seq && a.since_key == b.since_key && a.n == b.n &&
+           memcmp(a.field, b.field, a.n) == 0 && memcmp(a.q, b.q, a.n * sizeof(a.q[0])) == 0;
+}
+
+size_t telem_codec_encode(telem_codec &c, const telem_plot &p, const float (*rows)[TELEM_PLOT_MAX], uint8_t k,
+                          uint8_t step_ms, uint8_t *out)
+{
+    const uint32_t t0 = cpu_hal_get_cycle_count();
+    const bool key = !c.valid || c.since_key + 1 >= TELEM_KEY_FRAMES ||
+                     c.n != p.n || memcmp(c.field, p.field, p.n) != 0;
+    uint8_t *w = out;
+    *w++ = key ? TELEM_FRAME_KEY : TELEM_FRAME_DELTA;
+    *w++ = c.seq;
+    *w++ = p.n;
+    *w++ = k;
+    *w++ = step_ms;
+    if (key)
+    {
+        memcpy(w, p.split, TELEM_PLOT_CHARTS);
+        w += TELEM_PLOT_CHARTS;
+        memcpy(w, p.field, p.n);
+        w += p.n;
+        memset(c.q, 0, sizeof(c.q));
+    }
+    for (uint8_t j = 0; j < k; ++j)
+    {
+        for (uint8_t i = 0; i < p.n; ++i)
+        {
+            const int32_t q = quantize(rows[j][i], TELEM_FIELDS[p.field[i]].res, c.q[i]);
+            put_varint(w, q - c.q[i]);
+            c.q[i] = q;
+        }
+    }
+    c.valid = true;
+    c.seq++;
+    c.since_key = key ? 0 : c.since_key + 1;
+    c.n = p.n;
+    memcpy(c.field, p.field, p.n);
+
+    const size_t len = w - out;
+    const uint32_t dt = cpu_hal_get_cycle_count() - t0;
+    stats.frames++;
+    stats.keys += key;
+    stats.samples += k;
+    stats.bytes += len;
+    stats.raw += TELEM_FRAME_HEAD + k * p.n * sizeof(float);
+    stats.cycles += dt;
+    if (dt > stats.cycles_max)
+        stats.cycles_max = dt;
+    return len;
+}
+
+void telem_codec_write_state(JsonObject obj)
+{
+    const codec_stats s = stats;
+    const uint32_t mhz = getCpuFrequencyMhz();
+    obj["frames"] = s.frames;
+    obj["keys"] = s.keys;
+    obj["samples"] = s.samples;
+    obj["bytes"] = s.bytes;
+    obj["raw"] = s.raw;
+    obj["avg_bytes"] = s.frames ? static_cast<float>(s.bytes) / s.frames : 0.0f;
+    obj["enc_avg_us"] = s.frames ? static_cast<float>(s.cycles) / s.frames / mhz : 0.0f;
+    obj["enc_max_us"] = static_cast<float>(s.cycles_max) / mhz;
+}
@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "my_telem_ring.h"
+
+namespace
+{
+    static_assert((TELEM_RING_SAMPLES & (TELEM_RING_SAMPLES - 1)) == 0, "TELEM_RING_SAMPLES must be a power of two");
+    static_assert(TELEM_BATCH_MAX <= 255, "batch size must fit in uint8_t");
+
+    struct sample
+    {
+        float v[TELEM_FIELD_COUNT]; // 按字段表下标
+    };
+
+    sample ring[TELEM_RING_SAMPLES];
+    uint32_t head = 0; // 累计写入条数，只由控制任务写
+    volatile bool enabled = false;
+
+    uint32_t load_head()
+    {
+        return __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    }
+
+    // rows 为从序号 first 起、间隔 stride 复制出的 k 个样本；写指针已到 h2 时，
+    // 丢掉复制期间可能被控制任务覆盖的最旧几个，返回剩余样本数
+    uint8_t drop_overwritten(uint32_t h2, uint32_t first, uint32_t stride, float (*rows)[TELEM_PLOT_MAX], uint8_t k)
+    {
+        uint8_t lost = 0;
+        while (lost < k && h2 - (first + lost * stride) >= TELEM_RING_SAMPLES)
+            lost++;
+        if (lost)
+            memmove(rows, rows + lost, (k - lost) * sizeof(rows[0]));
+        return k - lost;
+    }
+} // namespace
+
+void telem_ring_enable(bool on)
+{
+    enabled = on;
+}
+
+void telem_ring_push()
+{
+    if (!enabled)
+        return;
+    const uint32_t h = head;
+    sample &s = ring[h & (TELEM_RING_SAMPLES - 1)];
+    for (size_t i = 0; i < TELEM_FIELD_COUNT; ++i)
+        s.v[i] = telem_read(TELEM_FIELDS[i]);
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+}
+
+uint8_t telem_ring_take(telem_batch &b, const telem_plot &p, float (*rows)[TELEM_PLOT_MAX], uint8_t &step_ms)
+{
+    const uint32_t h = load_head();
+    const int32_t behind = static_cast<int32_t>(h - b.cursor);
+    if (behind <= 0)
+    {
+        if (behind < -TELEM_RING_SAMPLES) // 序号回绕后的旧游标
+            b.cursor = h;
+        return 0;
+    }
+    // 落后一整环以上（新连接、推送频率很低或刚开始采样）：从最旧的样本开始；
+    // h - TELEM_RING_SAMPLES 所在的槽正是下一个写入位置，复查时必然被丢弃，从它的下一个开始
+    if (behind >= TELEM_RING_SAMPLES)
+        b.cursor = h - TELEM_RING_SAMPLES + 1;
+    const uint32_t avail = h - b.cursor;
+
+    // 字节预算：样本率 x 每样本字节数 / 预算；同时保证一帧装得下
+    const uint32_t dt_ms = std::max(robot.dt_ms, 1);
+    const uint32_t est_x16 = b.est_x16 ? b.est_x16 : p.n * 16u; // 未知时按每个值 1 字节估计
+    const uint32_t need_x16 = 1000u / dt_ms * est_x16;
+    uint32_t stride = (need_x16 + TELEM_STREAM_BUDGET * 16u - 1) / (TELEM_STREAM_BUDGET * 16u);
+    stride = std::max(stride, (avail + TELEM_BATCH_MAX - 1) / TELEM_BATCH_MAX);
+    stride = std::min<uint32_t>(std::max<uint32_t>(stride, 1), 255);
+
+    uint8_t k = 0;
+    uint32_t idx = b.cursor;
+    for (; static_cast<int32_t>(h - idx) > 0 && k < TELEM_BATCH_MAX; idx += stride, ++k)
+    {
+        const sample &s = ring[idx & (TELEM_RING_SAMPLES - 1)];
+        for (uint8_t i = 0; i < p.n; ++i)
+            rows[k][i] = s.v[p.field[i]];
+    }
+
+    // 复制期间控制任务可能已覆盖最旧的几个样本，丢掉它们
+    k = drop_overwritten(load_head(), b.cursor, stride, rows, k);
+
+    b.cursor = idx;
+    b.stride = stride;
+    step_ms = std::min<uint32_t>(stride * dt_ms, 255);
+    return k;
+}
+
+void telem_batch_account(telem_batch &b, size_t frame_len, uint8_t k)
+{
+    if (k == 0)
+        return;
+    const uint32_t per_x16 = std::min<uint32_t>(frame_len * 16 / k, UINT16_MAX);
+    b.est_x16 = b.est_x16 ? (b.est_x16 * 7u + per_x16) / 8u : per_x16;
+}
+
+bool telem_batch_same(const telem_batch &a, const telem_batch &b)
+{
+    return a.cursor == b.cursor && a.stride == b.stride && a.est_x16 == b.est_x16;
+}
@@ -1,23 +1,18 @@
 #include "my_net_config.h"
 #include "my_rgb.h"
 #include "my_car_group.h"
+#include "my_odom.h"
+#include "my_profile.h"
+#include "my_supervisor.h"
+#include "my_safety.h"
+#include "my_I2C.h"
+#include "my_screen.h"
+#include "my_diag.h"
 // ======================= 内部状态 =======================
 // Web/WS 服务实例（仅本翻译单元可见）
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 
-static constexpr int CHART_COUNT = 3;
-static constexpr int SLIDER_GROUP_COUNT = 4;
-
-ChartConfig chart_config[CHART_COUNT] = {{CHART_NAME1, {CHART_NAME11, CHART_NAME12, CHART_NAME13}},
-                                         {CHART_NAME2, {CHART_NAME21, CHART_NAME22, CHART_NAME23}},
-                                         {CHART_NAME3, {CHART_NAME31, CHART_NAME32, CHART_NAME33}}};
-
-SliderGroup slider_group[SLIDER_GROUP_COUNT] = {{SLIDER_NAME1, {SLIDER_NAME11, SLIDER_NAME12, SLIDER_NAME13}},
-                                                {SLIDER_NAME2, {SLIDER_NAME21, SLIDER_NAME22, SLIDER_NAME23}},
-                                                {SLIDER_NAME3, {SLIDER_NAME31, SLIDER_NAME32, SLIDER_NAME33}},
-                                                {SLIDER_NAME4, {SLIDER_NAME41, SLIDER_NAME42, SLIDER_NAME43}}};
-
 struct RgbModeInfo
 {
     const char *name;
@@ -56,38 +51,34 @@ static void send_group_state(AsyncWebSocketClient *c)
     group_write_state(g);
     if (c)
         wsSendTo(c, out);
-    else if (wsCanBroadcast())
+    else
         wsBroadcast(out);
 }
 
 
+static void send_profile_state(AsyncWebSocketClient *c, int accepted)
+{
+    JsonDocument out;
+    out["type"] = "profile_state";
+    out["accepted"] = accepted;
+    JsonObject p = out["profile"].to<JsonObject>();
+    profile_write_state(p);
+    wsSendTo(c, out);
+}
+
 // ======================= 事件处理 =======================
 // 连接事件：仅在 WS_EVT_CONNECT 时发送一次 UI 配置；其后不再发送
 void we_evt_connect(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type, void *arg, uint8_t *data, size_t len)
 {
+    // 队列满时不由库断开连接，背压交给分发层处理
+    c->setCloseClientOnQueueFull(false);
+    c->keepAlivePeriod(WS_KEEPALIVE_S);
+    ws_fanout_add(c->id());
+
     JsonDocument doc;
     doc["type"] = "ui_config";
-    // charts
-    JsonArray charts = doc["charts"].to<JsonArray>();
-
-    for (int i = 0; i < CHART_COUNT; ++i)
-    {
-        JsonObject o = charts.add<JsonObject>();
-        o["title"] = chart_config[i].title;
-        JsonArray l = o["legends"].to<JsonArray>();
-        for (int j = 0; j < 3; ++j)
-            l.add(chart_config[i].legend[j]);
-    }
-    // sliders
-    JsonArray sliders = doc["sliders"].to<JsonArray>();
-    for (int i = 0; i < SLIDER_GROUP_COUNT; ++i)
-    {
-        JsonObject g = sliders.add<JsonObject>();
-        g["group"] = slider_group[i].group;
-        JsonArray n = g["names"].to<JsonArray>();
-        for (int j = 0; j < 3; ++j)
-            n.add(slider_group[i].names[j]);
-    }
+    // charts / sliders 由字段表生成
+    schema_write_ui(doc.as<JsonObject>());
 
     JsonObject rgb = doc["rgb"].to<JsonObject>();
     JsonArray modes = rgb["modes"].to<JsonArray>();
@@ -107,6 +98,7 @@ void we_evt_connect(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType typ
     doc.shrinkToFit(); // 发送前收紧空间，减轻带宽
     // 先发 ui_config（首连一次，配置标题/图例/分组名称）
     wsSendTo(c, doc);
+    ws_sub_add(c->id());
     // 再发一个简单的 info，便于前端状态显示
     JsonDocument ack;
     ack["type"] = "info";
@@ -117,12 +109,14 @@ void we_evt_connect(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType typ
 // 断联事件
 void we_evt_disconnect(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type, void *arg, uint8_t *data, size_t len)
 {
-    // 可按需记录日志或清理该 client 的状态
+    ws_sub_remove(c->id());
+    ws_fanout_remove(c->id());
 }
 
 // 消息事件
 void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type, void *arg, uint8_t *data, size_t len)
 {
+    TRACE_SCOPE(WS_DATA);
     AwsFrameInfo *info = (AwsFrameInfo *)arg;
     JsonDocument doc;
     DeserializationError e = deserializeJson(doc, data, len);
@@ -141,9 +135,12 @@ void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type,
     serializeJsonPretty(doc, Serial);
 
     // ===========逻辑处理区域===========
-    // 1) 设置遥测频率（上限锁 60Hz，避免队列堆积）
+    // 1) 设置遥测频率（上限锁 60Hz，避免队列堆积；同时作为新连接的默认值）
     if (!strcmp(typeStr, "telem_hz"))
+    {
         robot.data_ms = 1000 / my_lim(doc["ms"], REFRESH_RATE_MIN, REFRESH_RATE_MAX);
+        ws_sub_set_rate(c->id(), doc["ms"] | REFRESH_RATE_DEF);
+    }
 
     // 2) 运行开关（只影响执行器；不影响遥测是否发送）
     else if (!strcmp(typeStr, "robot_run"))
@@ -151,11 +148,17 @@ void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type,
 
     // 3) 图表推送开关（关闭时后台仅发 3 路，显著减载）
     else if (!strcmp(typeStr, "charts_send"))
+    {
         robot.chart_enable = doc["on"] | false; // 默认关闭
+        ws_sub_set_channel(c->id(), TELEM_CH_LOOPS, robot.chart_enable);
+    }
 
     // 4) 摔倒检测开关
     else if (!strcmp(typeStr, "fall_check"))
+    {
         robot.fallen.enable = doc["enable"];
+        robot.fallen.recover = doc["recover"] | robot.fallen.recover;
+    }
 
     // 5) 姿态零偏（预留）
     else if (!strcmp(typeStr, "imu_restart"))
@@ -167,7 +170,7 @@ void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type,
 
     // 7) 设置 PID
     else if (!strcmp(typeStr, "set_pid"))
-        web_pid_set(doc["param"].as<JsonObject>());
+        web_pid_set(doc["param"].as<JsonObjectConst>());
 
     // 8) 读取 PID（回填给前端）
     else if (!strcmp(typeStr, "get_pid"))
@@ -210,6 +213,110 @@ void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type,
     else if (!strcmp(typeStr, "group_query"))
         send_group_state(c);
 
+    // 航向保持开关与参数
+    else if (!strcmp(typeStr, "yaw_hold"))
+    {
+        robot.heading.enable = doc["enable"] | robot.heading.enable;
+        robot.head_pid.p = doc["p"] | robot.head_pid.p;
+        robot.head_pid.i = doc["i"] | robot.head_pid.i;
+        robot.head_pid.d = doc["d"] | robot.head_pid.d;
+        robot.heading.holding = false; // 下个控制周期重新捕获目标航向
+        pid_state_update();
+    }
+
+    // 动作脚本：segs 追加到队列，cmd = start / stop（stop 同时清空队列）
+    else if (!strcmp(typeStr, "profile"))
+    {
+        const char *cmd = doc["cmd"] | "";
+        int accepted = 0;
+        if (!strcmp(cmd, "stop"))
+            profile_stop();
+        else
+        {
+            for (JsonObject s : doc["segs"].as<JsonArray>())
+            {
+                profile_segment seg{
+                    .d = s["d"] | 0.0f,
+                    .v = s["v"] | 0.3f,
+                    .a = s["a"] | 0.5f,
+                    .j = s["j"] | 2.0f,
+                    .w = s["w"] | 0.0f,
+                    .t_ms = s["t"] | 0u,
+                    .shape = profile_shape_from_string(s["shape"] | "s"),
+                };
+                if (!profile_push(seg))
+                    break; // 队列已满，其余段丢弃并在应答中体现
+                accepted++;
+            }
+            if (!strcmp(cmd, "start"))
+                profile_start();
+        }
+        send_profile_state(c, accepted);
+    }
+
+    // 速度/直立前馈开关与增益
+    else if (!strcmp(typeStr, "ff_set"))
+    {
+        robot.ff.enable = doc["enable"] | robot.ff.enable;
+        robot.ff.k_ang = doc["k_ang"] | robot.ff.k_ang;
+        robot.ff.k_tor = doc["k_tor"] | robot.ff.k_tor;
+    }
+
+    // 平衡监控状态与切换日志
+    else if (!strcmp(typeStr, "sup_query"))
+    {
+        JsonDocument out;
+        out["type"] = "sup_state";
+        JsonObject st = out["state"].to<JsonObject>();
+        supervisor_write_state(st);
+        JsonArray log = out["log"].to<JsonArray>();
+        supervisor_write_log(log);
+        wsSendTo(c, out);
+    }
+
+    // 安全监控：查询故障计数 / 注入控制任务停摆（仅 MY_SAFETY_INJECT 构建，用于台架验证切断链路）
+    else if (!strcmp(typeStr, "safety"))
+    {
+#if MY_SAFETY_INJECT
+        safety_inject_stall(doc["stall_ms"] | 0u);
+#endif
+        JsonDocument out;
+        out["type"] = "safety_state";
+        JsonObject st = out["safety"].to<JsonObject>();
+        safety_write_state(st);
+        wsSendTo(c, out);
+    }
+
+    // 遥测订阅：ch 为通道名数组（att/loops/motors/group/bat/odom），hz 为该客户端的推送频率
+    else if (!strcmp(typeStr, "subscribe"))
+    {
+        ws_sub_set(c->id(), doc["ch"].as<JsonArrayConst>(), doc["hz"] | 0);
+        JsonDocument out;
+        out["type"] = "sub_state";
+        JsonObject st = out["sub"].to<JsonObject>();
+        ws_sub_write(c->id(), st);
+        wsSendTo(c, out);
+    }
+
+    // 图表曲线选择：charts 为各图的字段键数组（见 /api/schema），解析一次成字段下标表
+    else if (!strcmp(typeStr, "plot"))
+    {
+        telem_plot plot;
+        if (doc["charts"].is<JsonArrayConst>())
+            telem_plot_resolve(doc["charts"].as<JsonArrayConst>(), plot);
+        else
+            telem_plot_default(plot);
+        ws_sub_set_plot(c->id(), plot);
+        JsonDocument out;
+        out["type"] = "plot_state";
+        telem_plot_write(plot, out["charts"].to<JsonArray>());
+        wsSendTo(c, out);
+    }
+
+    // 里程计清零（默认以当前位置为原点）
+    else if (!strcmp(typeStr, "odom_reset"))
+        my_odom_reset(doc["x"] | 0.0f, doc["y"] | 0.0f, doc["th"] | 0.0f);
+
     else if (!strcmp(typeStr, "rgb_set"))
     {
         robot.rgb.mode = clamp_rgb_mode(doc["mode"] | robot.rgb.mode);
@@ -219,10 +326,7 @@ void ws_evt_data(AsyncWebSocket *s, AsyncWebSocketClient *c, AwsEventType type,
         out["type"] = "rgb_state";
         out["mode"] = robot.rgb.mode;
         out["count"] = robot.rgb.rgb_count;
-        if (wsCanBroadcast())
-            wsBroadcast(out);
-        else
-            wsSendTo(c, out);
+        wsBroadcast(out);
     }
 }
 
@@ -272,9 +376,25 @@ static void handleApiState(AsyncWebServerRequest *req)
     d["running"] = robot.run;
     d["chart_enable"] = robot.chart_enable;
     d["fallen_enable"] = robot.fallen.enable;
+    d["fall_recover"] = robot.fallen.recover;
+    d["yaw_hold"] = robot.heading.enable;
+    JsonObject ff = d["ff"].to<JsonObject>();
+    ff["enable"] = robot.ff.enable;
+    ff["k_ang"] = robot.ff.k_ang;
+    ff["k_tor"] = robot.ff.k_tor;
     d["rgb_mode"] = clamp_rgb_mode(robot.rgb.mode);
     d["rgb_count"] = clamp_rgb_count(robot.rgb.rgb_count);
     d["rgb_max"] = RGB_LED_COUNT;
+    JsonObject safety = d["safety"].to<JsonObject>();
+    safety_write_state(safety);
+    JsonArray wsc = d["ws"].to<JsonArray>();
+    ws_fanout_write(wsc);
+    JsonObject sse = d["sse"].to<JsonObject>();
+    sse_write_state(sse);
+    JsonObject i2c = d["i2c"].to<JsonObject>();
+    i2c_write_stats(i2c);
+    JsonObject screen = d["screen"].to<JsonObject>();
+    screen_write_stats(screen);
     JsonObject g = d["group"].to<JsonObject>();
     g["name"] = robot.group_cfg.name;
     group_write_state(g);
@@ -282,10 +402,85 @@ static void handleApiState(AsyncWebServerRequest *req)
     req->send(200, "application/json; charset=utf-8", s);
 }
 
+// 诊断：默认 JSON，?bin 时返回紧凑二进制（格式见 my_diag.h）
+static void handleApiDiag(AsyncWebServerRequest *req)
+{
+    if (req->hasParam("bin"))
+    {
+        uint8_t buf[DIAG_BIN_MAX];
+        const size_t len = diag_encode_bin(buf, sizeof(buf));
+        AsyncResponseStream *res = req->beginResponseStream("application/octet-stream");
+        res->addHeader("Cache-Control", "no-store");
+        res->write(buf, len);
+        req->send(res);
+        return;
+    }
+    JsonDocument d;
+    String s;
+    diag_write_state(d.to<JsonObject>());
+    JsonObject tcp = d["tcp"].to<JsonObject>();
+    tcp_queue_write(tcp);
+    JsonObject ws_pool = d["ws_pool"].to<JsonObject>();
+    ws_pool_write(ws_pool);
+    JsonObject codec = d["codec"].to<JsonObject>();
+    telem_codec_write_state(codec);
+#if MY_TRACE_ENABLE
+    JsonObject trace = d["trace"].to<JsonObject>();
+    trace_write_state(trace);
+#endif
+    serializeJson(d, s);
+    AsyncWebServerResponse *res = req->beginResponse(200, "application/json; charset=utf-8", s);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+}
+
+// 遥测字段表：前端及外部工具据此解析图表数组和参数键
+static void handleApiSchema(AsyncWebServerRequest *req)
+{
+    JsonDocument d;
+    String s;
+    schema_write(d.to<JsonObject>());
+    serializeJson(d, s);
+    req->send(200, "application/json; charset=utf-8", s);
+}
+
+#if MY_TRACE_ENABLE
+// 事件追踪：?arm=1 清空并重新记录，?arm=0 冻结；无参数时导出 Chrome Trace JSON（导出期间暂停记录）
+static void handleApiTrace(AsyncWebServerRequest *req)
+{
+    if (req->hasParam("arm"))
+    {
+        if (req->getParam("arm")->value().toInt())
+            trace_arm();
+        else
+            trace_freeze();
+        JsonDocument d;
+        String s;
+        trace_write_state(d.to<JsonObject>());
+        serializeJson(d, s);
+        req->send(200, "application/json; charset=utf-8", s);
+        return;
+    }
+    trace_reader *r = trace_reader_open();
+    if (!r)
+    {
+        req->send(409, "text/plain; charset=utf-8", "trace export already in progress");
+        return;
+    }
+    // 响应发送完或连接断开时释放回调，随之关闭读者并恢复记录
+    std::shared_ptr<trace_reader> reader(r, trace_reader_close);
+    AsyncWebServerResponse *res = req->beginChunkedResponse("application/json", [reader](uint8_t *buf, size_t max_len, size_t)
+                                                            { return trace_reader_fill(reader.get(), buf, max_len); });
+    res->addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+}
+#endif
+
 static void handleRootRequest(AsyncWebServerRequest *req)
 {
     if (!handleFileRead(req, "/"))
-        req->send(404, "text/plain; charset=utf-8", "home.html not found (upload LittleFS data)");
+        req->send(404, "text/plain; charset=utf-8", "home.html not found (rebuild firmware to embed data/)");
 }
 
 static void handleNotFound(AsyncWebServerRequest *req)
@@ -297,15 +492,23 @@ static void handleNotFound(AsyncWebServerRequest *req)
 // ======================= 路由 & 初始化入口 =======================
 void my_web_asyn_init()
 {
-    if (!FSYS.begin(true)) // 1) 文件系统
+    if (!FSYS.begin(true)) // 1) 文件系统（仅用于覆盖内嵌网页资源）
         Serial.println("[WEB] LittleFS mount failed (formatted?)");
-    else if (!(FSYS.exists("/home.html") || FSYS.exists("/home.html.gz")))
-        Serial.println("[WEB] home.html missing in LittleFS, upload data folder with `pio run -t uploadfs`");
+    else
+        assetsScanOverrides();
 
+    ws_fanout_init();
+    ws_sub_init();
     ws.onEvent(onWsEvent); // 2) WebSocket
     server.addHandler(&ws);
+    sse_init(); // SSE 只读遥测 /events
 
     server.on("/api/state", HTTP_GET, handleApiState); // 3) 基础 API
+    server.on("/api/diag", HTTP_GET, handleApiDiag);
+    server.on("/api/schema", HTTP_GET, handleApiSchema);
+#if MY_TRACE_ENABLE
+    server.on("/api/trace", HTTP_GET, handleApiTrace);
+#endif
     server.on("/", HTTP_GET, handleRootRequest);       // 4) 静态文件
     server.onNotFound(handleNotFound);
     server.begin(); // 5) 启动 HTTP
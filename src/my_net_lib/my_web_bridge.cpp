@@ -1,6 +1,13 @@
 #include <cmath>
 #include "my_net_config.h"
 #include "my_car_group.h"
+#include "my_odom.h"
+#include "my_profile.h"
+#include "my_feedforward.h"
+#include "my_supervisor.h"
+#include "my_safety.h"
+#include "my_bat.h"
+#include "my_diag.h"
 
 static constexpr float JOY_X_DEADBAND = 0.10f;
 static constexpr float JOY_Y_DEADBAND = 0.02f;
@@ -8,71 +15,181 @@ static constexpr float JOY_A_DEADBAND = 0.02f;
 static constexpr float JOY_AXIS_LOCK_FRACTION = 0.2f; // 副轴必须超过主轴的比例才放行
 static constexpr float JOY_AXIS_LOCK_FLOOR = 0.05f;    // 副轴绝对值低于该值直接清零
 
-// 12+2 路遥测数据
-void my_web_data_update()
+// 按通道组包
+static void telem_encode(uint8_t mask, JsonDocument &doc)
 {
+    doc["type"] = "telemetry";
+    if (mask & TELEM_CH_ATT)
+    {
+        doc["fallen"] = FALLEN;
+        JsonObject sup = doc["sup"].to<JsonObject>();
+        supervisor_write_state(sup);
+        sup["tripped"] = safety_tripped();
+        doc["pitch"] = ANGLE_X;
+        doc["roll"] = ANGLE_Y;
+        doc["yaw"] = ANGLE_Z;
+        JsonObject h = doc["heading"].to<JsonObject>();
+        h["en"] = robot.heading.enable;
+        h["hold"] = robot.heading.holding;
+        h["ang"] = robot.heading.angle;
+        h["err"] = robot.heading.err;
+        h["bias"] = robot.heading.bias;
+    }
+    if (mask & TELEM_CH_BAT)
+    {
+        JsonObject bat = doc["bat"].to<JsonObject>();
+        bat_write_state(bat);
+    }
+    if (mask & TELEM_CH_GROUP)
+    {
+        JsonObject g = doc["group"].to<JsonObject>();
+        group_write_state(g);
+    }
+    if (mask & TELEM_CH_ODOM)
+    {
+        JsonObject o = doc["odom"].to<JsonObject>();
+        odom_write_state(o);
+        JsonObject p = doc["profile"].to<JsonObject>();
+        profile_write_state(p);
+    }
+    if (mask & TELEM_CH_MOTORS)
+    {
+        JsonObject m = doc["motor"].to<JsonObject>();
+        m["L"] = robot.motor.L_cmd;
+        m["R"] = robot.motor.R_cmd;
+        m["Ld"] = robot.motor.L_duty;
+        m["Rd"] = robot.motor.R_duty;
+        m["spd1"] = robot.wel.spd1;
+        m["spd2"] = robot.wel.spd2;
+    }
+    // 曲线数据随 loops 通道以二进制帧单独推送（见 telem_stream_push）
+    if (mask & TELEM_CH_LOOPS)
+    {
+        JsonObject ff = doc["ff"].to<JsonObject>();
+        feedforward_write_state(ff);
+    }
+}
+
+// 曲线流：从样本环取出上一帧之后的控制环样本打包发送。
+// 差分参考与样本游标都相同的客户端共用一帧，编码后各自写回；被覆盖的帧让该客户端下一帧发关键帧
+static void telem_stream_push(ws_sub_due *due, size_t n)
+{
+    // 只在 telem 任务中使用，放在静态区以免占用任务栈
+    static float rows[TELEM_BATCH_MAX][TELEM_PLOT_MAX];
+    static uint8_t frame[TELEM_FRAME_MAX];
+    bool sent[WS_SUB_MAX] = {};
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (sent[i] || !(due[i].mask & TELEM_CH_LOOPS))
+            continue;
+        const telem_codec ref = due[i].codec;
+        const telem_batch ref_batch = due[i].batch;
+        telem_codec next = ref;
+        telem_batch next_batch = ref_batch;
+        uint8_t step_ms = 0;
+        const uint8_t k = telem_ring_take(next_batch, due[i].plot, rows, step_ms);
+        AsyncWebSocketSharedBuffer buf;
+        if (k > 0)
+        {
+            const size_t len = telem_codec_encode(next, due[i].plot, rows, k, step_ms, frame);
+            telem_batch_account(next_batch, len, k);
+            buf = makeWebSocketSharedBuffer(len);
+            memcpy(buf->data(), frame, len);
+        }
+        for (size_t j = i; j < n; ++j)
+        {
+            if (sent[j] || !(due[j].mask & TELEM_CH_LOOPS) || !telem_plot_same(due[j].plot, due[i].plot) ||
+                !telem_codec_same(due[j].codec, ref) || !telem_batch_same(due[j].batch, ref_batch))
+                continue;
+            telem_codec c = next;
+            if (buf && !wsPost(due[j].id, buf, WS_POLICY_STREAM))
+                c.valid = false;
+            ws_sub_set_stream(due[j].id, c, next_batch);
+            sent[j] = true;
+        }
+    }
+}
+
+// 诊断快照每 DIAG_SAMPLE_MS 才更新一次，有新快照时按可靠消息推送给订阅了 diag 的客户端
+static void diag_push()
+{
+    static uint32_t sent_seq = 0;
+    const uint32_t seq = diag_seq();
+    if (seq == sent_seq)
+        return;
+    sent_seq = seq;
+
+    uint32_t ids[WS_SUB_MAX];
+    const size_t n = ws_sub_find(TELEM_CH_DIAG, ids);
+    if (n == 0)
+        return;
     JsonDocument doc;
+    doc["type"] = "diag";
+    diag_write_state(doc["diag"].to<JsonObject>());
+    AsyncWebSocketSharedBuffer buf = wsEncode(doc);
+    for (size_t i = 0; i < n; ++i)
+        wsPost(ids[i], buf, WS_POLICY_RELIABLE);
+}
 
-    // 组包 -> 广播
-    doc["type"] = "telemetry";
-    doc["fallen"] = FALLEN;
-    doc["pitch"] = ANGLE_X;
-    doc["roll"] = ANGLE_Y;
-    doc["yaw"] = ANGLE_Z;
-    JsonObject g = doc["group"].to<JsonObject>();
-    group_write_state(g);
-    // 根据 charts_send 决定是否打包 n 路曲线数据
-    if (robot.chart_enable)
+// 遥测数据：每种通道组合只编码一次，再分发给订阅了该组合的客户端（含 SSE）
+void my_web_data_update()
+{
+    TRACE_SCOPE(TELEM);
+    const uint32_t now_ms = millis();
+    ws_sub_due due[WS_SUB_MAX];
+    const size_t n = ws_sub_collect(now_ms, due);
+    bool sent[WS_SUB_MAX] = {};
+    AsyncWebSocketSharedBuffer sse_buf; // 与 SSE 通道相同的那份编码
+
+    for (size_t i = 0; i < n; ++i)
     {
-        JsonArray arr = doc["d"].to<JsonArray>();
-        arr.add(CHART_11);
-        arr.add(CHART_12);
-        arr.add(CHART_13);
-        arr.add(CHART_21);
-        arr.add(CHART_22);
-        arr.add(CHART_23);
-        arr.add(CHART_31);
-        arr.add(CHART_32);
-        arr.add(CHART_33);
+        if (sent[i])
+            continue;
+        JsonDocument doc;
+        telem_encode(due[i].mask, doc);
+        AsyncWebSocketSharedBuffer buf = wsEncode(doc);
+        if (due[i].mask == SSE_CHANNELS)
+            sse_buf = buf;
+        for (size_t j = i; j < n; ++j)
+        {
+            if (sent[j] || due[j].mask != due[i].mask)
+                continue;
+            wsPost(due[j].id, buf, WS_POLICY_COALESCE);
+            sent[j] = true;
+        }
     }
-    wsBroadcast(doc);
+    // 没有客户端看曲线时控制任务不采样
+    uint32_t ids[WS_SUB_MAX];
+    telem_ring_enable(ws_sub_find(TELEM_CH_LOOPS, ids) > 0);
+    telem_stream_push(due, n);
+    // SSE 只读客户端：本节拍已有同通道的 WS 编码就直接复用
+    if (sse_due(now_ms))
+    {
+        if (!sse_buf)
+        {
+            JsonDocument doc;
+            telem_encode(SSE_CHANNELS, doc);
+            sse_buf = wsEncode(doc);
+        }
+        sse_push(sse_buf);
+    }
+    diag_push();
+    TRACE_BEGIN(WS_PUMP);
+    ws_fanout_pump();
+    TRACE_END(WS_PUMP);
 }
-// PID 设置（顺序：角度P/I/D，速度P/I/D，位置P/I/D）
-void web_pid_set(JsonObject param)
+// 控制参数设置：键见 my_telem_schema.h 中带 TELEM_F_PARAM 的字段
+void web_pid_set(JsonObjectConst param)
 {
-    SLIDER_11 = param["key01"].as<float>();
-    SLIDER_12 = param["key02"].as<float>();
-    SLIDER_13 = param["key03"].as<float>();
-    SLIDER_21 = param["key04"].as<float>();
-    SLIDER_22 = param["key05"].as<float>();
-    SLIDER_23 = param["key06"].as<float>();
-    SLIDER_31 = param["key07"].as<float>();
-    SLIDER_32 = param["key08"].as<float>();
-    SLIDER_33 = param["key09"].as<float>();
-    SLIDER_41 = param["key10"].as<float>();
-    SLIDER_42 = param["key11"].as<float>();
-    SLIDER_43 = param["key12"].as<float>();
-    pid_state_update();
+    if (schema_params_set(param))
+        pid_state_update();
 }
-// PID 读取
+// 控制参数读取
 void web_pid_get(AsyncWebSocketClient *c)
 {
     JsonDocument out;
-    JsonObject pr = out["param"].to<JsonObject>();
     out["type"] = "pid";
-    pr["key01"] = SLIDER_11;
-    pr["key02"] = SLIDER_12;
-    pr["key03"] = SLIDER_13;
-    pr["key04"] = SLIDER_21;
-    pr["key05"] = SLIDER_22;
-    pr["key06"] = SLIDER_23;
-    pr["key07"] = SLIDER_31;
-    pr["key08"] = SLIDER_32;
-    pr["key09"] = SLIDER_33;
-    pr["key10"] = SLIDER_41;
-    pr["key11"] = SLIDER_42;
-    pr["key12"] = SLIDER_43;
-
+    schema_params_get(out["param"].to<JsonObject>());
     wsSendTo(c, out);
 }
 // 摇杆
@@ -0,0 +1,261 @@
+#include "my_net_config.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+// ======================= WS 分发：按客户端独立的背压策略 =======================
+namespace
+{
+    struct ws_peer
+    {
+        uint32_t id; // 0 表示空位
+        AsyncWebSocketSharedBuffer latest;                // 待发送的最新遥测
+        uint32_t latest_ms;                               // latest 生成时刻
+        AsyncWebSocketSharedBuffer stream;                // 待发送的曲线流帧（二进制）
+        AsyncWebSocketSharedBuffer reliable[WS_RELIABLE_MAX];
+        uint8_t head;
+        uint8_t count;
+        bool overflow; // 可靠队列溢出，等待断开
+
+        uint32_t sent;      // 遥测发出帧数
+        uint32_t coalesced; // 被更新帧覆盖的遥测帧数
+        uint32_t stream_sent;
+        uint32_t stream_dropped; // 被覆盖或发送失败的曲线流帧数
+        uint32_t acks;      // 可靠消息发出数
+        uint32_t deferred;  // 可靠消息因队列满而延后的次数
+        uint32_t lag_ms;    // 最近一帧遥测从生成到入队的延迟
+        uint32_t lag_max_ms;
+        size_t queue;       // 最近一次观察到的库内队列深度
+        size_t queue_max;
+    };
+
+    ws_peer peers[WS_SUB_MAX];
+    SemaphoreHandle_t peer_lock = nullptr;
+    uint32_t last_cleanup_ms = 0;
+    uint32_t closed_overflow = 0;
+
+    // 调用方需持有 peer_lock
+    ws_peer *find(uint32_t id)
+    {
+        for (ws_peer &p : peers)
+            if (p.id == id)
+                return &p;
+        return nullptr;
+    }
+
+    void flush_peer(ws_peer &p, uint32_t now_ms)
+    {
+        AsyncWebSocketClient *c = ws.client(p.id);
+        if (!c || c->status() != WS_CONNECTED)
+            return;
+
+        if (p.overflow)
+        {
+            c->close();
+            closed_overflow++;
+            p.overflow = false;
+            return;
+        }
+
+        p.queue = c->queueLen();
+        if (p.queue > p.queue_max)
+            p.queue_max = p.queue;
+
+        // 可靠消息优先，按序发出，留一个空位给遥测
+        while (p.count > 0 && p.queue + 1 < WS_MAX_QUEUED_MESSAGES)
+        {
+            if (!c->text(p.reliable[p.head]))
+                break;
+            p.reliable[p.head].reset();
+            p.head = (p.head + 1) % WS_RELIABLE_MAX;
+            p.count--;
+            p.acks++;
+            p.queue++;
+        }
+        if (p.count > 0)
+            p.deferred++;
+
+        // 遥测：队列较浅时才入队，否则留到下个节拍（期间到来的新帧会覆盖它）
+        if (p.latest && p.queue < WS_COALESCE_DEPTH)
+        {
+            if (c->text(p.latest))
+            {
+                p.sent++;
+                p.queue++;
+                p.lag_ms = now_ms - p.latest_ms;
+                if (p.lag_ms > p.lag_max_ms)
+                    p.lag_max_ms = p.lag_ms;
+            }
+            p.latest.reset();
+        }
+        // 曲线流与 JSON 遥测同节拍生成，多留一个位置
+        if (p.stream && p.queue < WS_COALESCE_DEPTH + 1)
+        {
+            if (c->binary(p.stream))
+                p.stream_sent++;
+            else
+                p.stream_dropped++; // 解码端按 seq 发现断档，等下一个关键帧
+            p.stream.reset();
+        }
+    }
+    // 调用方需持有 peer_lock；返回 false 表示覆盖了尚未发出的流帧
+    bool post(ws_peer &p, const AsyncWebSocketSharedBuffer &buf, ws_policy policy)
+    {
+        if (policy == WS_POLICY_COALESCE)
+        {
+            if (p.latest)
+                p.coalesced++;
+            p.latest = buf;
+            p.latest_ms = millis();
+        }
+        else if (policy == WS_POLICY_STREAM)
+        {
+            const bool dropped = static_cast<bool>(p.stream);
+            if (dropped)
+                p.stream_dropped++;
+            p.stream = buf;
+            return !dropped;
+        }
+        else if (p.count < WS_RELIABLE_MAX)
+        {
+            p.reliable[(p.head + p.count) % WS_RELIABLE_MAX] = buf;
+            p.count++;
+        }
+        else
+        {
+            p.overflow = true;
+        }
+        return true;
+    }
+}
+
+void ws_fanout_init()
+{
+    peer_lock = xSemaphoreCreateMutex();
+}
+
+void ws_fanout_add(uint32_t id)
+{
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    ws_peer *p = find(id);
+    if (!p)
+        p = find(0);
+    if (p)
+    {
+        *p = {};
+        p->id = id;
+    }
+    xSemaphoreGive(peer_lock);
+}
+
+void ws_fanout_remove(uint32_t id)
+{
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    if (ws_peer *p = find(id))
+        *p = {};
+    xSemaphoreGive(peer_lock);
+}
+
+bool wsPost(uint32_t id, AsyncWebSocketSharedBuffer buf, ws_policy policy)
+{
+    if (!buf || buf->empty())
+        return true;
+    bool ok = true;
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    if (ws_peer *p = find(id))
+        ok = post(*p, buf, policy);
+    xSemaphoreGive(peer_lock);
+    return ok;
+}
+
+void wsPostAll(AsyncWebSocketSharedBuffer buf, ws_policy policy)
+{
+    if (!buf || buf->empty())
+        return;
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    for (ws_peer &p : peers)
+        if (p.id != 0)
+            post(p, buf, policy);
+    xSemaphoreGive(peer_lock);
+}
+
+// telem 任务每个节拍调用：客户端的增删也只在这里清理，保证 ws.client() 指针在本任务内有效
+void ws_fanout_pump()
+{
+    const uint32_t now_ms = millis();
+    if (now_ms - last_cleanup_ms >= WS_CLEANUP_MS)
+    {
+        last_cleanup_ms = now_ms;
+        ws.cleanupClients();
+    }
+
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    for (ws_peer &p : peers)
+    {
+        if (p.id != 0)
+            flush_peer(p, now_ms);
+    }
+    xSemaphoreGive(peer_lock);
+}
+
+void ws_fanout_write(JsonArray arr)
+{
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    for (const ws_peer &p : peers)
+    {
+        if (p.id == 0)
+            continue;
+        JsonObject o = arr.add<JsonObject>();
+        o["id"] = p.id;
+        o["q"] = p.queue;
+        o["q_max"] = p.queue_max;
+        o["sent"] = p.sent;
+        o["coalesced"] = p.coalesced;
+        o["stream_sent"] = p.stream_sent;
+        o["stream_dropped"] = p.stream_dropped;
+        o["acks"] = p.acks;
+        o["pending"] = p.count;
+        o["deferred"] = p.deferred;
+        o["lag_ms"] = p.lag_ms;
+        o["lag_max_ms"] = p.lag_max_ms;
+    }
+    xSemaphoreGive(peer_lock);
+}
+
+void tcp_queue_write(JsonObject obj)
+{
+    async_tcp_queue_stats_t st;
+    asyncTcpQueueStats(&st);
+    obj["depth"] = st.depth;
+    obj["depth_max"] = st.high_water;
+    obj["cap"] = st.capacity;
+    obj["enq"] = st.enqueued;
+    obj["poll_coalesced"] = st.poll_coalesced;
+    obj["poll_shed"] = st.poll_shed;
+    obj["recv_deferred"] = st.recv_deferred;
+    obj["dropped"] = st.dropped;
+    obj["cancelled"] = st.cancelled;
+    obj["wait_avg_us"] = st.wait_avg_us;
+    obj["wait_max_us"] = st.wait_max_us;
+    obj["pool"] = st.pool_size;
+    obj["pool_used"] = st.pool_used;
+    obj["pool_max"] = st.pool_high_water;
+}
+
+void ws_pool_write(JsonObject obj)
+{
+    JsonArray cls = obj["classes"].to<JsonArray>();
+    for (size_t i = 0; i < AsyncWebSocketPool::classCount(); i++)
+    {
+        AsyncWebSocketPoolStats st;
+        if (!AsyncWebSocketPool::stats(i, &st))
+            continue;
+        JsonObject o = cls.add<JsonObject>();
+        o["block"] = st.block;
+        o["slots"] = st.slots;
+        o["used"] = st.used;
+        o["used_max"] = st.highWater;
+        o["heap_fallback"] = st.fallback;
+        o["psram"] = st.psram;
+    }
+    obj["oversize"] = AsyncWebSocketPool::oversize();
+    obj["largest_free"] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+}
@@ -0,0 +1,162 @@
+#include "my_net_config.h"
+#include "my_telem_schema.h"
+
+namespace
+{
+    bool plot_add(telem_plot &p, uint8_t chart, size_t idx)
+    {
+        if (p.n >= TELEM_PLOT_MAX || p.split[chart] >= TELEM_PLOT_PER_CHART)
+            return false;
+        p.field[p.n] = static_cast<uint8_t>(idx);
+        p.n++;
+        p.split[chart]++;
+        return true;
+    }
+
+    int field_index(const char *key)
+    {
+        for (size_t i = 0; i < TELEM_FIELD_COUNT; ++i)
+            if (!strcmp(TELEM_FIELDS[i].key, key))
+                return static_cast<int>(i);
+        return -1;
+    }
+
+    // 按 flag 把连续同组的字段写成 [{<title_key>: group, <names_key>: [...], keys: [...]}]
+    void write_groups(JsonArray out, uint8_t flag, const char *title_key, const char *names_key)
+    {
+        const char *group = nullptr;
+        JsonArray names, keys;
+        for (const telem_field &f : TELEM_FIELDS)
+        {
+            if (!(f.flags & flag))
+                continue;
+            if (!group || strcmp(group, f.group) != 0)
+            {
+                group = f.group;
+                JsonObject g = out.add<JsonObject>();
+                g[title_key] = f.group;
+                names = g[names_key].to<JsonArray>();
+                keys = g["keys"].to<JsonArray>();
+            }
+            names.add(f.label);
+            keys.add(f.key);
+        }
+    }
+} // namespace
+
+// 默认曲线：带 TELEM_F_CHART 的字段，每个分组一张图
+void telem_plot_default(telem_plot &p)
+{
+    p = {};
+    const char *group = nullptr;
+    int chart = -1;
+    for (size_t i = 0; i < TELEM_FIELD_COUNT; ++i)
+    {
+        const telem_field &f = TELEM_FIELDS[i];
+        if (!(f.flags & TELEM_F_CHART))
+            continue;
+        if (!group || strcmp(group, f.group) != 0)
+        {
+            group = f.group;
+            if (++chart >= TELEM_PLOT_CHARTS)
+                return;
+        }
+        plot_add(p, chart, i);
+    }
+}
+
+// charts 为各图的字段键数组；未知键和超出上限的曲线忽略
+void telem_plot_resolve(JsonArrayConst charts, telem_plot &p)
+{
+    p = {};
+    uint8_t chart = 0;
+    for (JsonArrayConst keys : charts)
+    {
+        if (chart >= TELEM_PLOT_CHARTS)
+            break;
+        for (JsonVariantConst k : keys)
+        {
+            const char *key = k.as<const char *>();
+            const int idx = key ? field_index(key) : -1;
+            if (idx >= 0)
+                plot_add(p, chart, idx);
+        }
+        chart++;
+    }
+}
+
+// 与 ui_config.charts 同格式：[{title, legends, keys}]
+void telem_plot_write(const telem_plot &p, JsonArray charts)
+{
+    uint8_t at = 0;
+    for (uint8_t c = 0; c < TELEM_PLOT_CHARTS; ++c)
+    {
+        JsonObject o = charts.add<JsonObject>();
+        JsonArray legends = o["legends"].to<JsonArray>();
+        JsonArray keys = o["keys"].to<JsonArray>();
+        const char *title = p.split[c] ? TELEM_FIELDS[p.field[at]].group : "";
+        bool mixed = false;
+        for (uint8_t i = at; i < at + p.split[c]; ++i)
+            mixed |= strcmp(TELEM_FIELDS[p.field[i]].group, title) != 0;
+        for (uint8_t i = at; i < at + p.split[c]; ++i)
+        {
+            const telem_field &f = TELEM_FIELDS[p.field[i]];
+            legends.add(mixed ? f.key : f.label);
+            keys.add(f.key);
+        }
+        o["title"] = mixed ? "自选" : title;
+        at += p.split[c];
+    }
+}
+
+void schema_write_ui(JsonObject doc)
+{
+    telem_plot p;
+    telem_plot_default(p);
+    telem_plot_write(p, doc["charts"].to<JsonArray>());
+    write_groups(doc["sliders"].to<JsonArray>(), TELEM_F_PARAM, "group", "names");
+}
+
+void schema_write(JsonObject obj)
+{
+    JsonArray fields = obj["fields"].to<JsonArray>();
+    for (const telem_field &f : TELEM_FIELDS)
+    {
+        JsonObject o = fields.add<JsonObject>();
+        o["key"] = f.key;
+        o["group"] = f.group;
+        o["label"] = f.label;
+        o["unit"] = f.unit;
+        o["type"] = telem_type_name(f.type);
+        o["res"] = f.res;
+        if (f.flags & TELEM_F_CHART)
+            o["chart"] = true;
+        if (f.flags & TELEM_F_PARAM)
+            o["param"] = true;
+    }
+    schema_write_ui(obj);
+}
+
+// 只写入消息中出现的参数，缺省的保持原值
+bool schema_params_set(JsonObjectConst param)
+{
+    bool changed = false;
+    for (const telem_field &f : TELEM_FIELDS)
+    {
+        if (!(f.flags & TELEM_F_PARAM))
+            continue;
+        JsonVariantConst v = param[f.key];
+        if (!v.is<float>())
+            continue;
+        telem_write(f, v.as<float>());
+        changed = true;
+    }
+    return changed;
+}
+
+void schema_params_get(JsonObject param)
+{
+    for (const telem_field &f : TELEM_FIELDS)
+        if (f.flags & TELEM_F_PARAM)
+            param[f.key] = telem_read(f);
+}
@@ -0,0 +1,156 @@
+#include "my_net_config.h"
+#include "freertos/semphr.h"
+// ======================= SSE 只读遥测：/events =======================
+// 仪表盘、记录用的电脑只需要看数据，走 SSE 不占 WebSocket 客户端位，也不参与 WS 分发层的排队。
+// 固定频率推送 TELEM_CH_DEFAULT 通道的 JSON，与同节拍的 WS 客户端共用一次序列化结果。
+namespace
+{
+    struct sse_peer
+    {
+        AsyncEventSourceClient *c; // nullptr 表示空位；断开回调中清除，之后库才释放对象
+        uint32_t sent;
+        uint32_t dropped; // 队列未清空而跳过的帧数
+        uint16_t stall;   // 连续跳过的帧数
+    };
+
+    AsyncEventSource events("/events");
+    sse_peer peers[SSE_MAX_CLIENTS] = {};
+    // 连接事件在 async_tcp 任务，推送在 telem 任务。
+    // 锁顺序：close_lock -> 库内客户端表锁 -> peer_lock。on_connect 在库锁内取 peer_lock，
+    // 所以持有 peer_lock 时不能调用 close()（它会经 on_disconnect 去取库锁）。
+    SemaphoreHandle_t peer_lock = nullptr;
+    // 关闭期间持有；on_disconnect 也要取它，保证待关闭的客户端在 close() 返回前不会被库释放。
+    // 递归锁：close() 在本任务内同步回调 on_disconnect
+    SemaphoreHandle_t close_lock = nullptr;
+    uint32_t next_ms = 0;
+    uint32_t seq = 0;
+    uint32_t rejected = 0;  // 超出客户端上限被拒绝的连接
+    uint32_t closed_stall = 0;
+
+    sse_peer *find(AsyncEventSourceClient *c)
+    {
+        for (sse_peer &p : peers)
+            if (p.c == c)
+                return &p;
+        return nullptr;
+    }
+
+    // 在 HTTP 层拒绝超出上限的连接（401），不让它们占用 TCP 和库内队列
+    bool on_authorize(AsyncWebServerRequest *)
+    {
+        xSemaphoreTake(peer_lock, portMAX_DELAY);
+        const bool ok = find(nullptr) != nullptr;
+        if (!ok)
+            rejected++;
+        xSemaphoreGive(peer_lock);
+        return ok;
+    }
+
+    // 库在持有自身客户端表锁时回调，这里不能关闭连接
+    void on_connect(AsyncEventSourceClient *c)
+    {
+        xSemaphoreTake(peer_lock, portMAX_DELAY);
+        sse_peer *p = find(nullptr);
+        if (p)
+            *p = {c, 0, 0, 0};
+        else
+            rejected++; // 极少见：与其他连接同时通过了检查，该连接不会收到推送
+        xSemaphoreGive(peer_lock);
+        // retry 字段让浏览器断线后按该间隔重连
+        c->send("{\"type\":\"hello\"}", "hello", 0, SSE_RETRY_MS);
+    }
+
+    void on_disconnect(AsyncEventSourceClient *c)
+    {
+        xSemaphoreTakeRecursive(close_lock, portMAX_DELAY);
+        xSemaphoreTake(peer_lock, portMAX_DELAY);
+        if (sse_peer *p = find(c))
+            *p = {};
+        xSemaphoreGive(peer_lock);
+        xSemaphoreGiveRecursive(close_lock);
+    }
+} // namespace
+
+void sse_init()
+{
+    peer_lock = xSemaphoreCreateMutex();
+    close_lock = xSemaphoreCreateRecursiveMutex();
+    events.authorizeConnect(on_authorize);
+    events.onConnect(on_connect);
+    events.onDisconnect(on_disconnect);
+    server.addHandler(&events);
+}
+
+bool sse_due(uint32_t now_ms)
+{
+    if (static_cast<int32_t>(now_ms - next_ms) < 0)
+        return false;
+    next_ms = now_ms + SSE_PERIOD_MS;
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    bool any = false;
+    for (const sse_peer &p : peers)
+        any |= p.c != nullptr;
+    xSemaphoreGive(peer_lock);
+    return any;
+}
+
+// json 为 WS 路径已序列化的遥测；拼上 SSE 帧头后所有 SSE 客户端共用一份
+void sse_push(const AsyncWebSocketSharedBuffer &json)
+{
+    if (!json || json->empty())
+        return;
+    char head[40];
+    const int n = snprintf(head, sizeof(head), "id: %u\nevent: telemetry\ndata: ", static_cast<unsigned>(++seq));
+    auto msg = std::make_shared<String>();
+    msg->reserve(n + json->size() + 2);
+    msg->concat(head, n);
+    msg->concat(reinterpret_cast<const char *>(json->data()), json->size());
+    msg->concat("\n\n", 2);
+
+    AsyncEventSourceClient *stalled[SSE_MAX_CLIENTS];
+    size_t n_stalled = 0;
+    xSemaphoreTakeRecursive(close_lock, portMAX_DELAY);
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    for (sse_peer &p : peers)
+    {
+        if (!p.c)
+            continue;
+        // 丢帧策略：上一帧还没发完就跳过本帧，只发最新状态；长期发不出去的客户端断开
+        if (p.c->packetsWaiting() >= SSE_DROP_DEPTH || !p.c->write(msg))
+        {
+            p.dropped++;
+            if (++p.stall >= SSE_STALL_MAX)
+            {
+                closed_stall++;
+                stalled[n_stalled++] = p.c;
+                p = {}; // 先腾出槽位，放锁后再关闭
+            }
+            continue;
+        }
+        p.sent++;
+        p.stall = 0;
+    }
+    xSemaphoreGive(peer_lock);
+    for (size_t i = 0; i < n_stalled; ++i)
+        stalled[i]->close();
+    xSemaphoreGiveRecursive(close_lock);
+}
+
+void sse_write_state(JsonObject obj)
+{
+    xSemaphoreTake(peer_lock, portMAX_DELAY);
+    JsonArray arr = obj["clients"].to<JsonArray>();
+    for (const sse_peer &p : peers)
+    {
+        if (!p.c)
+            continue;
+        JsonObject o = arr.add<JsonObject>();
+        o["q"] = p.c->packetsWaiting();
+        o["sent"] = p.sent;
+        o["dropped"] = p.dropped;
+    }
+    xSemaphoreGive(peer_lock);
+    obj["hz"] = 1000 / SSE_PERIOD_MS;
+    obj["rejected"] = rejected;
+    obj["closed_stall"] = closed_stall;
+}
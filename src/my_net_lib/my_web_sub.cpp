@@ -0,0 +1,230 @@
+#include "my_net_config.h"
+#include "freertos/semphr.h"
+// ======================= 遥测订阅：每个客户端独立的通道与频率 =======================
+namespace
+{
+    struct ws_sub
+    {
+        uint32_t id; // 0 表示空位
+        uint8_t mask;
+        uint16_t period_ms;
+        uint32_t next_ms;
+    };
+
+    // 曲线流状态较大，单独放在互斥锁下，不在自旋锁里整块复制
+    struct ws_stream
+    {
+        uint32_t id;       // 0 表示空位
+        telem_plot plot;   // 已解析的曲线选择
+        telem_codec codec; // 曲线流的差分参考
+        telem_batch batch; // 曲线流的样本游标
+    };
+
+    struct channel_name
+    {
+        const char *name;
+        uint8_t bit;
+    };
+
+    const channel_name CHANNELS[] = {
+        {"att", TELEM_CH_ATT},
+        {"loops", TELEM_CH_LOOPS},
+        {"motors", TELEM_CH_MOTORS},
+        {"group", TELEM_CH_GROUP},
+        {"bat", TELEM_CH_BAT},
+        {"odom", TELEM_CH_ODOM},
+        {"diag", TELEM_CH_DIAG},
+    };
+
+    ws_sub subs[WS_SUB_MAX] = {};
+    portMUX_TYPE sub_mux = portMUX_INITIALIZER_UNLOCKED; // 连接事件在 async_tcp 任务，推送在 telem 任务
+    ws_stream streams[WS_SUB_MAX] = {};
+    SemaphoreHandle_t stream_lock = nullptr;
+
+    uint16_t period_from_hz(int hz)
+    {
+        return 1000 / my_lim(hz, REFRESH_RATE_MIN, REFRESH_RATE_MAX);
+    }
+
+    // 调用方需持有 sub_mux
+    ws_sub *find(uint32_t id)
+    {
+        for (ws_sub &s : subs)
+            if (s.id == id)
+                return &s;
+        return nullptr;
+    }
+
+    // 调用方需持有 stream_lock
+    ws_stream *find_stream(uint32_t id)
+    {
+        for (ws_stream &s : streams)
+            if (s.id == id)
+                return &s;
+        return nullptr;
+    }
+}
+
+void ws_sub_init()
+{
+    stream_lock = xSemaphoreCreateMutex();
+}
+
+void ws_sub_add(uint32_t id)
+{
+    telem_plot default_plot;
+    telem_plot_default(default_plot);
+    portENTER_CRITICAL(&sub_mux);
+    ws_sub *s = find(id);
+    if (!s)
+        s = find(0);
+    if (s)
+    {
+        // 新连接沿用全局设置，与旧前端行为一致
+        s->id = id;
+        s->mask = TELEM_CH_DEFAULT | (robot.chart_enable ? TELEM_CH_LOOPS : 0);
+        s->period_ms = robot.data_ms;
+        s->next_ms = 0;
+    }
+    portEXIT_CRITICAL(&sub_mux);
+
+    xSemaphoreTake(stream_lock, portMAX_DELAY);
+    ws_stream *st = find_stream(id);
+    if (!st)
+        st = find_stream(0);
+    if (st)
+        *st = {id, default_plot, {}, {}};
+    xSemaphoreGive(stream_lock);
+}
+
+void ws_sub_remove(uint32_t id)
+{
+    portENTER_CRITICAL(&sub_mux);
+    if (ws_sub *s = find(id))
+        *s = {};
+    portEXIT_CRITICAL(&sub_mux);
+
+    xSemaphoreTake(stream_lock, portMAX_DELAY);
+    if (ws_stream *st = find_stream(id))
+        *st = {};
+    xSemaphoreGive(stream_lock);
+}
+
+void ws_sub_set(uint32_t id, JsonArrayConst ch, int hz)
+{
+    uint8_t mask = 0;
+    for (JsonVariantConst v : ch)
+    {
+        const char *name = v.as<const char *>();
+        if (!name)
+            continue;
+        for (const channel_name &c : CHANNELS)
+            if (!strcmp(name, c.name))
+                mask |= c.bit;
+    }
+
+    portENTER_CRITICAL(&sub_mux);
+    if (ws_sub *s = find(id))
+    {
+        if (!ch.isNull())
+            s->mask = mask;
+        if (hz > 0)
+            s->period_ms = period_from_hz(hz);
+        s->next_ms = 0;
+    }
+    portEXIT_CRITICAL(&sub_mux);
+}
+
+void ws_sub_set_rate(uint32_t id, int hz)
+{
+    portENTER_CRITICAL(&sub_mux);
+    if (ws_sub *s = find(id))
+        s->period_ms = period_from_hz(hz);
+    portEXIT_CRITICAL(&sub_mux);
+}
+
+void ws_sub_set_channel(uint32_t id, uint8_t ch, bool on)
+{
+    portENTER_CRITICAL(&sub_mux);
+    if (ws_sub *s = find(id))
+        s->mask = on ? (s->mask | ch) : (s->mask & ~ch);
+    portEXIT_CRITICAL(&sub_mux);
+}
+
+void ws_sub_set_plot(uint32_t id, const telem_plot &plot)
+{
+    xSemaphoreTake(stream_lock, portMAX_DELAY);
+    if (ws_stream *st = find_stream(id))
+        st->plot = plot;
+    xSemaphoreGive(stream_lock);
+}
+
+void ws_sub_set_stream(uint32_t id, const telem_codec &codec, const telem_batch &batch)
+{
+    // 编码期间曲线选择即使变了也可以写回：编码端发现字段不一致会自动发关键帧
+    xSemaphoreTake(stream_lock, portMAX_DELAY);
+    if (ws_stream *st = find_stream(id))
+    {
+        st->codec = codec;
+        st->batch = batch;
+    }
+    xSemaphoreGive(stream_lock);
+}
+
+size_t ws_sub_collect(uint32_t now_ms, ws_sub_due *out)
+{
+    size_t n = 0;
+    portENTER_CRITICAL(&sub_mux);
+    for (ws_sub &s : subs)
+    {
+        // 诊断通道有自己的节奏，不参与遥测组包
+        const uint8_t mask = s.mask & ~TELEM_CH_DIAG;
+        if (s.id == 0 || mask == 0 || static_cast<int32_t>(now_ms - s.next_ms) < 0)
+            continue;
+        // 落后太多时不追帧，直接从当前时刻重新计时
+        s.next_ms = (now_ms - s.next_ms > s.period_ms) ? now_ms + s.period_ms : s.next_ms + s.period_ms;
+        out[n].id = s.id;
+        out[n].mask = mask;
+        n++;
+    }
+    portEXIT_CRITICAL(&sub_mux);
+
+    // 曲线流状态只对订阅了 loops 的客户端复制；期间客户端断开则按空选择处理
+    xSemaphoreTake(stream_lock, portMAX_DELAY);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!(out[i].mask & TELEM_CH_LOOPS))
+            continue;
+        const ws_stream *st = find_stream(out[i].id);
+        out[i].plot = st ? st->plot : telem_plot{};
+        out[i].codec = st ? st->codec : telem_codec{};
+        out[i].batch = st ? st->batch : telem_batch{};
+    }
+    xSemaphoreGive(stream_lock);
+    return n;
+}
+
+size_t ws_sub_find(uint8_t ch, uint32_t *ids)
+{
+    size_t n = 0;
+    portENTER_CRITICAL(&sub_mux);
+    for (const ws_sub &s : subs)
+        if (s.id != 0 && (s.mask & ch))
+            ids[n++] = s.id;
+    portEXIT_CRITICAL(&sub_mux);
+    return n;
+}
+
+void ws_sub_write(uint32_t id, JsonObject obj)
+{
+    portENTER_CRITICAL(&sub_mux);
+    const ws_sub *found = find(id);
+    const ws_sub s = found ? *found : ws_sub{};
+    portEXIT_CRITICAL(&sub_mux);
+
+    JsonArray ch = obj["ch"].to<JsonArray>();
+    for (const channel_name &c : CHANNELS)
+        if (s.mask & c.bit)
+            ch.add(c.name);
+    obj["hz"] = s.period_ms ? 1000 / s.period_ms : 0;
+}
@@ -1,56 +1,23 @@
 #include "my_net_config.h"
 // ======================= 工具：发送 JSON 到某个客户端/全部 =======================
-void wsSendTo(AsyncWebSocketClient *c, const JsonDocument &doc)
-{
-    String s;
-    serializeJson(doc, s);
-    if (c)
-        c->text(s);
-}
-
-// ======================= 工具函数：WS 保活与广播 =======================
-void my_wsheart()
+// 序列化一次，得到可被多个客户端共享的缓冲
+AsyncWebSocketSharedBuffer wsEncode(const JsonDocument &doc)
 {
-    ws.cleanupClients(); // 清理断开的
-    size_t n = ws.count();
-    for (size_t i = 0; i < n; i++)
-    {
-        AsyncWebSocketClient *c = ws.client(i);
-        if (!c)
-            continue;
-        if (c->canSend())
-            c->ping(); // 发送 ping 帧
-    }
-    vTaskDelay(pdMS_TO_TICKS(15000)); // 每 15 秒 ping 一次
+    const size_t len = measureJson(doc);
+    auto buf = makeWebSocketSharedBuffer(len);
+    serializeJson(doc, reinterpret_cast<char *>(buf->data()), len);
+    return buf;
 }
 
-bool wsCanBroadcast()
+void wsSendTo(AsyncWebSocketClient *c, const JsonDocument &doc)
 {
-    bool ok = true;
-    size_t n = ws.count();
-    for (size_t i = 0; i < n; i++)
-    {
-        AsyncWebSocketClient *c = ws.client(i);
-        if (!c)
-            continue;
-        if (c->queueIsFull() || !c->canSend())
-        {
-            ok = false;
-            break;
-        }
-    }
-    return ok;
+    if (c)
+        wsPost(c->id(), wsEncode(doc), WS_POLICY_RELIABLE);
 }
 
+// 状态类广播：所有客户端共享同一份缓冲，可靠投递
 void wsBroadcast(const JsonDocument &doc)
 {
-    // 清理断开的客户端，避免幽灵连接占坑
-    ws.cleanupClients();
-    if (!wsCanBroadcast())
-        return; // 丢掉这一帧，避免把队列越堆越高
-
-    String s;
-    s.reserve(320); // 预留缓冲，减少堆分配
-    serializeJson(doc, s);
-    ws.textAll(s);
+    TRACE_SCOPE(WS_BCAST);
+    wsPostAll(wsEncode(doc), WS_POLICY_RELIABLE);
 }
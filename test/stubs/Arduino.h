@@ -0,0 +1,123 @@
+#pragma once
+// 主机测试用的 Arduino 最小替身：时间由测试推进，引脚电平可由测试脚本驱动
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+
+#define IRAM_ATTR
+#define PI 3.1415926535897932384626433832795
+#define BIT(n) (1UL << (n))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+// ---- 时间：测试调用 host_advance_us/ms 推进 ----
+inline uint64_t &host_now_us()
+{
+    static uint64_t us = 0;
+    return us;
+}
+inline void host_advance_us(uint64_t us) { host_now_us() += us; }
+inline void host_advance_ms(uint32_t ms) { host_now_us() += static_cast<uint64_t>(ms) * 1000; }
+inline uint32_t micros() { return static_cast<uint32_t>(host_now_us()); }
+inline uint32_t millis() { return static_cast<uint32_t>(host_now_us() / 1000); }
+inline void delay(uint32_t ms) { host_advance_ms(ms); }
+inline void delayMicroseconds(uint32_t us) { host_advance_us(us); }
+inline uint32_t getCpuFrequencyMhz() { return 240; }
+
+// ---- 引脚：默认读回最后写入的电平；read_hook 可模拟外部器件拉住总线 ----
+struct host_pin_bus
+{
+    int level[64];
+    int mode[64];
+    uint32_t writes[64];
+    int (*read_hook)(int pin);
+};
+inline host_pin_bus &host_pins()
+{
+    static host_pin_bus b = {};
+    return b;
+}
+inline void pinMode(int pin, int mode)
+{
+    host_pins().mode[pin] = mode;
+    if (mode == INPUT_PULLUP)
+        host_pins().level[pin] = HIGH; // 上拉：无人驱动时读高
+}
+inline void digitalWrite(int pin, int v)
+{
+    host_pins().level[pin] = v;
+    host_pins().writes[pin]++;
+}
+inline int digitalRead(int pin)
+{
+    return host_pins().read_hook ? host_pins().read_hook(pin) : host_pins().level[pin];
+}
+
+// ---- 硬件定时器：只登记中断入口和周期，由测试调用 host_timer_fire() 触发 ----
+struct hw_timer_t
+{
+    void (*isr)();
+    uint64_t alarm_us;
+    bool enabled;
+};
+inline hw_timer_t &host_timer()
+{
+    static hw_timer_t t = {};
+    return t;
+}
+inline hw_timer_t *timerBegin(uint8_t, uint16_t, bool) { return &host_timer(); }
+inline void timerAttachInterrupt(hw_timer_t *t, void (*fn)(), bool) { t->isr = fn; }
+inline void timerAlarmWrite(hw_timer_t *t, uint64_t us, bool) { t->alarm_us = us; }
+inline void timerAlarmEnable(hw_timer_t *t) { t->enabled = true; }
+// 推进一个定时器周期并执行中断
+inline void host_timer_fire()
+{
+    hw_timer_t &t = host_timer();
+    host_advance_us(t.alarm_us);
+    if (t.enabled && t.isr)
+        t.isr();
+}
+
+// ---- 串口：只计数和保留最后一行，供测试检查打印发生在哪里 ----
+struct HostSerial
+{
+    uint32_t lines = 0;
+    char last[160] = {};
+
+    void begin(unsigned long) {}
+    size_t print(const char *s) { return record(s); }
+    size_t println(const char *s = "") { return record(s); }
+    size_t printf(const char *fmt, ...)
+    {
+        char buf[sizeof(last)];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        return record(buf);
+    }
+
+private:
+    size_t record(const char *s)
+    {
+        lines++;
+        strncpy(last, s, sizeof(last) - 1);
+        return strlen(s);
+    }
+};
+static HostSerial Serial;
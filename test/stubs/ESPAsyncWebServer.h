@@ -0,0 +1,128 @@
+#pragma once
+// 主机测试用的 ESPAsyncWebServer 替身：只保留分发层用到的 WebSocket 客户端接口。
+// 每个客户端的库内队列有上限，由测试按链路快慢逐节拍调用 host_drain() 排空
+#include <Arduino.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#define WS_MAX_QUEUED_MESSAGES 32
+#define DEFAULT_MAX_WS_CLIENTS 8
+
+class String;
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncEventSourceClient;
+
+using AsyncWebSocketBufferVector = std::vector<uint8_t>;
+using AsyncWebSocketSharedBuffer = std::shared_ptr<AsyncWebSocketBufferVector>;
+
+typedef enum
+{
+    WS_DISCONNECTED,
+    WS_CONNECTED,
+    WS_DISCONNECTING
+} AwsClientStatus;
+
+class AsyncWebSocketClient
+{
+public:
+    struct host_msg
+    {
+        AsyncWebSocketSharedBuffer buf;
+        bool binary;
+    };
+
+    explicit AsyncWebSocketClient(uint32_t id) : _id(id) {}
+
+    uint32_t id() const { return _id; }
+    AwsClientStatus status() const { return _status; }
+    size_t queueLen() const { return _queue.size(); }
+    bool text(AsyncWebSocketSharedBuffer buffer) { return enqueue(buffer, false); }
+    bool binary(AsyncWebSocketSharedBuffer buffer) { return enqueue(buffer, true); }
+    void close(uint16_t = 0, const char * = nullptr)
+    {
+        _status = WS_DISCONNECTING;
+        closes++;
+    }
+
+    // 测试侧：链路送出队首最多 n 条
+    void host_drain(size_t n)
+    {
+        while (n-- && !_queue.empty())
+        {
+            delivered.push_back(_queue.front());
+            _queue.pop_front();
+        }
+    }
+
+    std::vector<host_msg> delivered; // 已送达的消息，按发送顺序
+    uint32_t closes = 0;
+
+private:
+    bool enqueue(const AsyncWebSocketSharedBuffer &buffer, bool bin)
+    {
+        if (_status != WS_CONNECTED || _queue.size() >= WS_MAX_QUEUED_MESSAGES)
+            return false;
+        _queue.push_back({buffer, bin});
+        return true;
+    }
+
+    uint32_t _id;
+    AwsClientStatus _status = WS_CONNECTED;
+    std::deque<host_msg> _queue;
+};
+
+class AsyncWebSocket
+{
+public:
+    explicit AsyncWebSocket(const char *) {}
+
+    AsyncWebSocketClient *client(uint32_t id)
+    {
+        for (AsyncWebSocketClient *c : host_clients)
+            if (c->id() == id)
+                return c;
+        return nullptr;
+    }
+    void cleanupClients() { cleanups++; }
+
+    std::vector<AsyncWebSocketClient *> host_clients; // 测试登记的在线客户端
+    uint32_t cleanups = 0;
+};
+
+struct AsyncWebSocketPoolStats
+{
+    size_t block;
+    uint16_t slots;
+    uint16_t used;
+    uint16_t highWater;
+    uint32_t fallback;
+    bool psram;
+};
+
+namespace AsyncWebSocketPool
+{
+    inline size_t classCount() { return 0; }
+    inline bool stats(size_t, AsyncWebSocketPoolStats *) { return false; }
+    inline uint32_t oversize() { return 0; }
+}
+
+struct async_tcp_queue_stats_t
+{
+    uint32_t depth;
+    uint32_t high_water;
+    uint32_t capacity;
+    uint32_t enqueued;
+    uint32_t poll_coalesced;
+    uint32_t poll_shed;
+    uint32_t recv_deferred;
+    uint32_t dropped;
+    uint32_t cancelled;
+    uint32_t wait_avg_us;
+    uint32_t wait_max_us;
+    uint32_t pool_size;
+    uint32_t pool_used;
+    uint32_t pool_high_water;
+};
+inline void asyncTcpQueueStats(async_tcp_queue_stats_t *stats) { *stats = {}; }
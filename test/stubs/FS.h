@@ -0,0 +1,2 @@
+#pragma once
+// 主机测试用的文件系统替身：网络模块头文件只引用，不访问文件
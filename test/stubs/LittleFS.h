@@ -0,0 +1,3 @@
+#pragma once
+// 主机测试用的 LittleFS 替身：网络模块头文件只引用，不访问文件
+#include "FS.h"
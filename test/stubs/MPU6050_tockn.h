@@ -0,0 +1,31 @@
+#pragma once
+// 主机测试用的 MPU6050 替身：update() 的成败与读数由测试设定，并记录读取次数
+#include <Arduino.h>
+#include <Wire.h>
+
+class MPU6050
+{
+public:
+    explicit MPU6050(TwoWire &w) : wire(&w) {}
+
+    void begin() {}
+    void calcGyroOffsets(bool = false, uint16_t = 1000, uint16_t = 3000) {}
+    bool update()
+    {
+        reads++;
+        return ok;
+    }
+
+    float getAngleX() { return angle[0]; }
+    float getAngleY() { return angle[1]; }
+    float getAngleZ() { return angle[2]; }
+    float getGyroX() { return gyro[0]; }
+    float getGyroY() { return gyro[1]; }
+    float getGyroZ() { return gyro[2]; }
+
+    TwoWire *wire;
+    bool ok = true;
+    uint32_t reads = 0;
+    float angle[3] = {};
+    float gyro[3] = {};
+};
@@ -0,0 +1,32 @@
+#pragma once
+// 主机测试用的 TwoWire 替身：只记录驱动的安装/卸载与配置
+#include <Arduino.h>
+
+class TwoWire
+{
+public:
+    explicit TwoWire(uint8_t num) : num(num) {}
+
+    bool begin(int sda_pin, int scl_pin, uint32_t freq)
+    {
+        sda = sda_pin;
+        scl = scl_pin;
+        frequency = freq;
+        begins++;
+        return true;
+    }
+    bool end()
+    {
+        ends++;
+        return true;
+    }
+    void setTimeOut(uint16_t ms) { timeout_ms = ms; }
+
+    uint8_t num;
+    int sda = -1;
+    int scl = -1;
+    uint32_t frequency = 0;
+    uint16_t timeout_ms = 0;
+    uint32_t begins = 0;
+    uint32_t ends = 0;
+};
@@ -0,0 +1,18 @@
+#pragma once
+// 主机测试用的 IDF I2C 驱动替身
+#include "esp_err.h"
+
+typedef int i2c_port_t;
+#define I2C_NUM_0 0
+#define I2C_NUM_1 1
+
+inline int *host_i2c_timeout()
+{
+    static int timeout[2] = {};
+    return timeout;
+}
+inline esp_err_t i2c_set_timeout(i2c_port_t port, int timeout)
+{
+    host_i2c_timeout()[port] = timeout;
+    return ESP_OK;
+}
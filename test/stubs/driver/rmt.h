@@ -0,0 +1,66 @@
+#pragma once
+// 主机测试用的 RMT 驱动替身：记录转换回调与最后一次发送的数据，发送是否完成由测试控制
+#include <stddef.h>
+#include <string.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int gpio_num_t;
+typedef int rmt_channel_t;
+#define RMT_CHANNEL_0 0
+
+typedef union
+{
+    struct
+    {
+        uint32_t duration0 : 15;
+        uint32_t level0 : 1;
+        uint32_t duration1 : 15;
+        uint32_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_item32_t;
+
+typedef void (*sample_to_rmt_t)(const void *src, rmt_item32_t *dest, size_t src_size,
+                                size_t wanted_num, size_t *translated_size, size_t *item_num);
+
+struct rmt_config_t
+{
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+};
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) {(channel_id), (gpio), 80}
+
+struct host_rmt_state
+{
+    sample_to_rmt_t translator;
+    bool busy;          // 上一帧仍在发送
+    uint32_t writes;    // rmt_write_sample 调用次数
+    uint8_t last[64];   // 最后一次发送的数据
+    size_t last_size;
+};
+inline host_rmt_state &host_rmt()
+{
+    static host_rmt_state s = {};
+    return s;
+}
+inline esp_err_t rmt_config(const rmt_config_t *) { return ESP_OK; }
+inline esp_err_t rmt_driver_install(rmt_channel_t, size_t, int) { return ESP_OK; }
+inline esp_err_t rmt_translator_init(rmt_channel_t, sample_to_rmt_t fn)
+{
+    host_rmt().translator = fn;
+    return ESP_OK;
+}
+inline esp_err_t rmt_wait_tx_done(rmt_channel_t, TickType_t)
+{
+    return host_rmt().busy ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+inline esp_err_t rmt_write_sample(rmt_channel_t, const uint8_t *src, size_t size, bool)
+{
+    host_rmt_state &s = host_rmt();
+    s.writes++;
+    s.last_size = size < sizeof(s.last) ? size : sizeof(s.last);
+    memcpy(s.last, src, s.last_size);
+    return ESP_OK;
+}
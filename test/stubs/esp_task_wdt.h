@@ -0,0 +1,31 @@
+#pragma once
+// 主机测试用的任务看门狗替身：只计数，供测试检查喂狗是否发生
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+struct host_wdt_state
+{
+    uint32_t inits;
+    uint32_t adds;
+    uint32_t resets;
+};
+inline host_wdt_state &host_wdt()
+{
+    static host_wdt_state s = {};
+    return s;
+}
+inline esp_err_t esp_task_wdt_init(uint32_t, bool)
+{
+    return host_wdt().inits++ ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+inline esp_err_t esp_task_wdt_add(TaskHandle_t)
+{
+    host_wdt().adds++;
+    return ESP_OK;
+}
+inline esp_err_t esp_task_wdt_reset()
+{
+    host_wdt().resets++;
+    return ESP_OK;
+}
@@ -0,0 +1,38 @@
+#pragma once
+// 主机测试用的信号量替身：测试单线程运行，互斥锁只记持有深度；
+// 非递归锁被重复获取即视为死锁并终止，用来暴露锁顺序错误
+#include <stdio.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+
+struct host_sem
+{
+    bool recursive;
+    int depth;
+    uint32_t takes;
+};
+typedef host_sem *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new host_sem{false, 0, 0}; }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new host_sem{true, 0, 0}; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t)
+{
+    if (s->depth > 0 && !s->recursive)
+    {
+        fprintf(stderr, "host semaphore: mutex taken twice (deadlock)\n");
+        abort();
+    }
+    s->depth++;
+    s->takes++;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    if (s->depth == 0)
+        return pdFALSE;
+    s->depth--;
+    return pdTRUE;
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t t) { return xSemaphoreTake(s, t); }
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) { return xSemaphoreGive(s); }
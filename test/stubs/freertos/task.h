@@ -0,0 +1,75 @@
+#pragma once
+// 主机测试用的任务接口替身：创建任务只登记入口，不真正运行。
+// 测试用 host_task_run() 在当前线程执行任务函数，直到它在没有待处理通知时阻塞。
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+struct host_task
+{
+    TaskFunction_t fn;
+    const char *name;
+    void *arg;
+    uint32_t notify; // 待处理的通知计数
+};
+typedef host_task *TaskHandle_t;
+
+inline host_task *host_tasks()
+{
+    static host_task tasks[8] = {};
+    return tasks;
+}
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t, void *arg,
+                                          UBaseType_t, TaskHandle_t *handle, BaseType_t)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        host_task &t = host_tasks()[i];
+        if (t.fn)
+            continue;
+        t = {fn, name, arg, 0};
+        if (handle)
+            *handle = &t;
+        return pdPASS;
+    }
+    return pdFAIL;
+}
+inline void xTaskNotifyGive(TaskHandle_t t)
+{
+    if (t)
+        t->notify++;
+}
+
+// host_task_run 正在执行的任务
+inline TaskHandle_t &host_task_current()
+{
+    static TaskHandle_t t = nullptr;
+    return t;
+}
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return host_task_current(); }
+
+struct host_task_blocked
+{
+};
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t)
+{
+    host_task *t = host_task_current();
+    if (!t || !t->notify)
+        throw host_task_blocked(); // 测试里没有别的线程能唤醒它：回到 host_task_run
+    const uint32_t n = t->notify;
+    t->notify = clear ? 0 : n - 1;
+    return n;
+}
+// 执行任务直到它阻塞在通知上
+inline void host_task_run(TaskHandle_t t)
+{
+    host_task_current() = t;
+    try
+    {
+        t->fn(t->arg);
+    }
+    catch (const host_task_blocked &)
+    {
+    }
+    host_task_current() = nullptr;
+}
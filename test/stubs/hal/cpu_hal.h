@@ -0,0 +1,5 @@
+#pragma once
+// 主机测试用的周期计数：按 240 MHz 由测试时钟换算
+#include <Arduino.h>
+
+inline uint32_t cpu_hal_get_cycle_count() { return micros() * 240u; }
@@ -0,0 +1,202 @@
+// CPU 占用滑动窗口：用模拟的单核调度记录（每毫秒各任务运行的微秒数）驱动 cpu_window，
+// 按 my_diag 的方式每个采样周期写入短窗口、每 DIAG_CPU_COARSE_EVERY 个周期写入长窗口
+#include <unity.h>
+#include "my_config.h"
+#include "my_cpu_load.h"
+
+namespace
+{
+    enum
+    {
+        CTRL = 0,
+        TELEM,
+        IDLE,
+        SPARE,
+        SLOTS
+    };
+
+    cpu_window<SLOTS, DIAG_CPU_FINE + 1> fine;
+    cpu_window<SLOTS, DIAG_CPU_COARSE + 1> coarse;
+
+    // 模拟调度：duty[i] 为任务 i 每毫秒运行的微秒数，IDLE 取剩余时间
+    struct sim_core
+    {
+        uint32_t duty[SLOTS];
+        uint32_t total; // 运行时间基准（us），与 FreeRTOS 计数器一样会回绕
+        uint32_t rt[SLOTS];
+        uint32_t samples;
+
+        void run_ms(uint32_t ms)
+        {
+            for (uint32_t t = 0; t < ms; ++t)
+            {
+                uint32_t busy = 0;
+                for (int i = 0; i < SLOTS; ++i)
+                {
+                    if (i == IDLE)
+                        continue;
+                    rt[i] += duty[i];
+                    busy += duty[i];
+                }
+                rt[IDLE] += 1000 - busy;
+                total += 1000;
+            }
+        }
+
+        // 跑一个采样周期并采样
+        void sample()
+        {
+            run_ms(DIAG_SAMPLE_MS);
+            fine.push(total, rt);
+            if (samples++ % DIAG_CPU_COARSE_EVERY == 0)
+                coarse.push(total, rt);
+        }
+
+        void sample(int n)
+        {
+            for (int i = 0; i < n; ++i)
+                sample();
+        }
+    };
+
+    sim_core core;
+
+    void start(uint32_t base)
+    {
+        fine = {};
+        coarse = {};
+        core = {};
+        core.total = base;
+        for (uint32_t &r : core.rt)
+            r = base;
+        // 控制任务 2 ms 跑 300 us，遥测 16 ms 跑 2 ms
+        core.duty[CTRL] = 150;
+        core.duty[TELEM] = 125;
+    }
+}
+
+void setUp()
+{
+    start(0);
+}
+
+void tearDown() {}
+
+void test_no_interval_reads_zero()
+{
+    TEST_ASSERT_EQUAL_UINT16(0, fine.load(CTRL, 1));
+    core.sample();
+    TEST_ASSERT_EQUAL_UINT16(0, fine.load(CTRL, 1)); // 一个采样点还没有区间
+    TEST_ASSERT_EQUAL_UINT32(0, fine.span_total(1));
+    core.sample();
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, 1));
+}
+
+void test_steady_load()
+{
+    core.sample(DIAG_CPU_FINE + 1);
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, 1));
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT16(125, fine.load(TELEM, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT16(725, fine.load(IDLE, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT16(0, fine.load(SPARE, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT32(DIAG_CPU_FINE * DIAG_SAMPLE_MS * 1000, fine.span_total(DIAG_CPU_FINE));
+}
+
+void test_short_history_uses_what_is_there()
+{
+    core.sample(3);
+    core.duty[CTRL] = 450;
+    core.sample();
+    // 只有 3 个区间：(150 + 150 + 450) / 3
+    TEST_ASSERT_EQUAL_UINT16(250, fine.load(CTRL, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT32(3 * DIAG_SAMPLE_MS * 1000, fine.span_total(DIAG_CPU_FINE));
+}
+
+void test_burst_shows_in_short_window_only()
+{
+    const int coarse_samples = DIAG_CPU_COARSE * DIAG_CPU_COARSE_EVERY + 1;
+    core.sample(coarse_samples);
+    core.duty[TELEM] = 600; // 一个采样周期的突发
+    core.sample();
+    core.duty[TELEM] = 125;
+
+    TEST_ASSERT_EQUAL_UINT16(600, fine.load(TELEM, 1));
+    TEST_ASSERT_EQUAL_UINT16((9 * 125 + 600) / 10, fine.load(TELEM, DIAG_CPU_FINE));
+    // 长窗口的最新一格还停在突发之前
+    TEST_ASSERT_EQUAL_UINT16(125, coarse.load(TELEM, DIAG_CPU_COARSE));
+
+    // 推到下一格长窗口：突发被 60 个采样周期摊薄
+    core.sample(DIAG_CPU_COARSE_EVERY);
+    const uint16_t expect = (125 * (DIAG_CPU_COARSE * DIAG_CPU_COARSE_EVERY - 1) + 600) / (DIAG_CPU_COARSE * DIAG_CPU_COARSE_EVERY);
+    TEST_ASSERT_UINT32_WITHIN(1, expect, coarse.load(TELEM, DIAG_CPU_COARSE));
+    TEST_ASSERT_EQUAL_UINT16(125, fine.load(TELEM, DIAG_CPU_FINE)); // 已滑出短窗口
+}
+
+void test_slots_add_up_to_whole_core()
+{
+    core.duty[SPARE] = 333;
+    core.sample(DIAG_CPU_FINE + 1);
+    const uint8_t spans[] = {1, DIAG_CPU_FINE};
+    for (uint8_t span : spans)
+    {
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < SLOTS; ++i)
+            sum += fine.load(i, span);
+        TEST_ASSERT_UINT32_WITHIN(SLOTS, 1000, sum); // 每个槽位最多向下取整 1‰
+    }
+}
+
+void test_counter_wraparound()
+{
+    start(0xFFFFFFFFu - 3 * DIAG_SAMPLE_MS * 1000); // 几个采样周期后计数器回绕
+    core.sample(DIAG_CPU_FINE + 1);
+    TEST_ASSERT_TRUE(core.total < 0x80000000u);
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, 1));
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT16(725, fine.load(IDLE, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT32(DIAG_CPU_FINE * DIAG_SAMPLE_MS * 1000, fine.span_total(DIAG_CPU_FINE));
+}
+
+void test_reused_slot_drops_old_history()
+{
+    core.duty[SPARE] = 900;
+    core.sample(DIAG_CPU_FINE + 1);
+    TEST_ASSERT_EQUAL_UINT16(900, fine.load(SPARE, DIAG_CPU_FINE));
+
+    // 旧任务退出，新任务接管该槽位，累计运行时间从 0 开始
+    core.duty[SPARE] = 100;
+    core.rt[SPARE] = 0;
+    fine.reset_slot(SPARE);
+    core.sample();
+    TEST_ASSERT_EQUAL_UINT16(0, fine.load(SPARE, DIAG_CPU_FINE)); // 新任务还没有区间
+    core.sample();
+    TEST_ASSERT_EQUAL_UINT16(100, fine.load(SPARE, DIAG_CPU_FINE));
+    core.sample(3);
+    TEST_ASSERT_EQUAL_UINT16(100, fine.load(SPARE, DIAG_CPU_FINE));
+    TEST_ASSERT_EQUAL_UINT16(150, fine.load(CTRL, DIAG_CPU_FINE)); // 其他槽位不受影响
+}
+
+void test_out_of_range_and_clamp()
+{
+    core.sample(2);
+    TEST_ASSERT_EQUAL_UINT16(0, fine.load(SLOTS, 1));
+    // 计数不一致（运行时间增量大于时间基准增量）时封顶
+    core.rt[CTRL] += 5 * DIAG_SAMPLE_MS * 1000;
+    core.sample();
+    TEST_ASSERT_EQUAL_UINT16(1000, fine.load(CTRL, 1));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_interval_reads_zero);
+    RUN_TEST(test_steady_load);
+    RUN_TEST(test_short_history_uses_what_is_there);
+    RUN_TEST(test_burst_shows_in_short_window_only);
+    RUN_TEST(test_slots_add_up_to_whole_core);
+    RUN_TEST(test_counter_wraparound);
+    RUN_TEST(test_reused_slot_drops_old_history);
+    RUN_TEST(test_out_of_range_and_clamp);
+    return UNITY_END();
+}
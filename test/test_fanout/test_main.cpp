@@ -0,0 +1,215 @@
+// WS 分发层：模拟快/慢/卡死的客户端链路，检查慢客户端不拖累其他客户端、只收到最新遥测，可靠消息按序送达
+#include <unity.h>
+#include "my_net_lib/my_web_fanout.cpp"
+
+robot_state robot = {};
+AsyncWebSocket ws("/ws");
+
+namespace
+{
+    AsyncWebSocketClient fast(1), slow(2), stuck(3);
+    uint32_t seq = 0;
+
+    AsyncWebSocketSharedBuffer frame(uint32_t n)
+    {
+        auto buf = std::make_shared<AsyncWebSocketBufferVector>(sizeof(n));
+        memcpy(buf->data(), &n, sizeof(n));
+        return buf;
+    }
+
+    uint32_t seq_of(const AsyncWebSocketClient::host_msg &m)
+    {
+        uint32_t n = 0;
+        memcpy(&n, m.buf->data(), sizeof(n));
+        return n;
+    }
+
+    // 一个遥测节拍：投递一帧遥测并分发，然后各链路按自己的速度送出
+    void tick(int n = 1, uint32_t slow_every = 4)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            wsPostAll(frame(++seq), WS_POLICY_COALESCE);
+            ws_fanout_pump();
+            fast.host_drain(WS_MAX_QUEUED_MESSAGES);
+            if (seq % slow_every == 0)
+                slow.host_drain(1);
+            host_advance_ms(TELEM_TICK_MS);
+        }
+    }
+
+    ws_peer &peer(uint32_t id)
+    {
+        return *find(id);
+    }
+}
+
+void setUp()
+{
+    for (ws_peer &p : peers)
+        p = {};
+    fast = AsyncWebSocketClient(1);
+    slow = AsyncWebSocketClient(2);
+    stuck = AsyncWebSocketClient(3);
+    ws.host_clients = {&fast, &slow, &stuck};
+    for (AsyncWebSocketClient *c : ws.host_clients)
+        ws_fanout_add(c->id());
+    seq = 0;
+}
+
+void tearDown() {}
+
+void test_stuck_client_does_not_delay_others()
+{
+    tick(500);
+    // 快客户端每帧都收到，且没有被合并
+    TEST_ASSERT_EQUAL_UINT32(500, fast.delivered.size());
+    TEST_ASSERT_EQUAL_UINT32(0, peer(1).coalesced);
+    for (size_t i = 0; i < fast.delivered.size(); ++i)
+        TEST_ASSERT_EQUAL_UINT32(i + 1, seq_of(fast.delivered[i]));
+
+    // 卡死的客户端队列停在合并深度，其余帧被覆盖而不是堆积
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH, stuck.queueLen());
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH, peer(3).queue_max);
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH, peer(3).sent);
+    TEST_ASSERT_EQUAL_UINT32(500 - WS_COALESCE_DEPTH - 1, peer(3).coalesced);
+}
+
+void test_slow_client_gets_newest_frames()
+{
+    tick(400);
+    TEST_ASSERT_UINT32_WITHIN(2, 100, slow.delivered.size()); // 链路每 4 个节拍送出一帧
+    for (size_t i = 1; i < slow.delivered.size(); ++i)
+        TEST_ASSERT_TRUE(seq_of(slow.delivered[i]) > seq_of(slow.delivered[i - 1]));
+    TEST_ASSERT_TRUE(slow.queueLen() <= WS_COALESCE_DEPTH);
+    // 送达的帧落后最新帧不超过队列深度对应的节拍数
+    const uint32_t last = seq_of(slow.delivered.back());
+    TEST_ASSERT_TRUE(seq - last <= (WS_COALESCE_DEPTH + 1) * 4);
+    TEST_ASSERT_TRUE(peer(2).lag_max_ms <= 4 * TELEM_TICK_MS);
+
+    // 停止产生新帧后排空：最后收到的一定是最新一帧
+    for (int i = 0; i < 10; ++i)
+    {
+        ws_fanout_pump();
+        slow.host_drain(1);
+    }
+    TEST_ASSERT_EQUAL_UINT32(seq, seq_of(slow.delivered.back()));
+}
+
+void test_reliable_messages_survive_congestion_in_order()
+{
+    tick(10);
+    for (uint32_t i = 0; i < 5; ++i)
+        wsPost(3, frame(1000 + i), WS_POLICY_RELIABLE);
+    tick(50);
+    // 拥塞时可靠消息照样入队，遥测仍停在合并深度以内
+    TEST_ASSERT_EQUAL_UINT32(0, peer(3).count);
+    TEST_ASSERT_EQUAL_UINT32(5, peer(3).acks);
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH + 5, stuck.queueLen());
+
+    stuck.host_drain(WS_MAX_QUEUED_MESSAGES);
+    uint32_t expect = 1000;
+    for (const AsyncWebSocketClient::host_msg &m : stuck.delivered)
+        if (seq_of(m) >= 1000)
+            TEST_ASSERT_EQUAL_UINT32(expect++, seq_of(m));
+    TEST_ASSERT_EQUAL_UINT32(1005, expect);
+}
+
+void test_reliable_leaves_room_for_telemetry()
+{
+    for (uint32_t i = 0; i < WS_RELIABLE_MAX; ++i)
+        wsPost(3, frame(1000 + i), WS_POLICY_RELIABLE);
+    for (int i = 0; i < 10; ++i)
+    {
+        ws_fanout_pump();
+        for (uint32_t k = 0; k < WS_RELIABLE_MAX && peer(3).count < WS_RELIABLE_MAX; ++k)
+            wsPost(3, frame(2000), WS_POLICY_RELIABLE);
+    }
+    // 库内队列留一个空位，不被可靠消息占满
+    TEST_ASSERT_EQUAL_UINT32(WS_MAX_QUEUED_MESSAGES - 1, stuck.queueLen());
+    TEST_ASSERT_TRUE(peer(3).deferred > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, stuck.closes);
+}
+
+void test_reliable_overflow_closes_only_that_client()
+{
+    for (uint32_t i = 0; i < WS_RELIABLE_MAX + 1; ++i)
+        wsPost(3, frame(1000 + i), WS_POLICY_RELIABLE);
+    TEST_ASSERT_TRUE(peer(3).overflow);
+    tick();
+    TEST_ASSERT_EQUAL_UINT32(1, stuck.closes);
+    TEST_ASSERT_EQUAL_UINT32(1, closed_overflow);
+    TEST_ASSERT_EQUAL_UINT32(0, fast.closes);
+    TEST_ASSERT_EQUAL_UINT32(1, fast.delivered.size());
+
+    // 已断开的客户端不再分发，直到被清理移除
+    tick(5);
+    TEST_ASSERT_EQUAL_UINT32(1, stuck.closes);
+    TEST_ASSERT_EQUAL_UINT32(0, stuck.queueLen());
+    ws_fanout_remove(3);
+    TEST_ASSERT_TRUE(find(3) == nullptr);
+}
+
+void test_stream_keeps_latest_and_reports_drop()
+{
+    TEST_ASSERT_TRUE(wsPost(1, frame(7), WS_POLICY_STREAM));
+    TEST_ASSERT_FALSE(wsPost(1, frame(8), WS_POLICY_STREAM)); // 覆盖未发出的帧，编码端要知道
+    TEST_ASSERT_EQUAL_UINT32(1, peer(1).stream_dropped);
+    tick();
+    bool got = false;
+    for (const AsyncWebSocketClient::host_msg &m : fast.delivered)
+        if (m.binary)
+        {
+            TEST_ASSERT_EQUAL_UINT32(8, seq_of(m));
+            got = true;
+        }
+    TEST_ASSERT_TRUE(got);
+    TEST_ASSERT_EQUAL_UINT32(1, peer(1).stream_sent);
+
+    // 流帧比遥测多一个位置：卡死的客户端仍能在合并深度处收到流帧
+    tick(5);
+    TEST_ASSERT_TRUE(wsPost(3, frame(9), WS_POLICY_STREAM));
+    ws_fanout_pump();
+    TEST_ASSERT_EQUAL_UINT32(1, peer(3).stream_sent);
+    TEST_ASSERT_TRUE(wsPost(3, frame(10), WS_POLICY_STREAM));
+    ws_fanout_pump();
+    TEST_ASSERT_EQUAL_UINT32(1, peer(3).stream_sent); // 队列已超过深度，留在槽里等下一拍
+    TEST_ASSERT_FALSE(wsPost(3, frame(11), WS_POLICY_STREAM));
+}
+
+void test_lag_measures_time_waiting_for_queue()
+{
+    tick(5); // 卡死的客户端队列已满到合并深度
+    wsPost(3, frame(500), WS_POLICY_COALESCE);
+    host_advance_ms(100);
+    ws_fanout_pump();
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH, stuck.queueLen());
+    stuck.host_drain(1);
+    ws_fanout_pump();
+    TEST_ASSERT_EQUAL_UINT32(100, peer(3).lag_ms);
+}
+
+void test_state_lists_each_client()
+{
+    tick(20);
+    JsonDocument doc;
+    ws_fanout_write(doc.to<JsonArray>());
+    TEST_ASSERT_EQUAL_UINT32(3, doc.size());
+    TEST_ASSERT_EQUAL_UINT32(20, doc[0]["sent"].as<uint32_t>());
+    TEST_ASSERT_EQUAL_UINT32(WS_COALESCE_DEPTH, doc[2]["q_max"].as<uint32_t>());
+}
+
+int main()
+{
+    ws_fanout_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_stuck_client_does_not_delay_others);
+    RUN_TEST(test_slow_client_gets_newest_frames);
+    RUN_TEST(test_reliable_messages_survive_congestion_in_order);
+    RUN_TEST(test_reliable_leaves_room_for_telemetry);
+    RUN_TEST(test_reliable_overflow_closes_only_that_client);
+    RUN_TEST(test_stream_keeps_latest_and_reports_drop);
+    RUN_TEST(test_lag_measures_time_waiting_for_queue);
+    RUN_TEST(test_state_lists_each_client);
+    return UNITY_END();
+}
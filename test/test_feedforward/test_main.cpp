@@ -0,0 +1,153 @@
+// 前馈：按控制周期喂速度指令或脚本加速度，检查稳态下倾角项 atan(a/g)、力矩项 k_tor*a、限幅，以及关闭时不输出
+#include <unity.h>
+#include "my_pid.cpp"
+#include "my_tool_lib/my_tool.cpp"
+#include "my_motion_lib/my_feedforward.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    constexpr int DT_MS = 2;
+    constexpr float DT = DT_MS * 0.001f;
+    float dir = 1.0f;
+
+    // 跑够若干个低通时间常数，让指令加速度收敛
+    void settle_profile(float a)
+    {
+        robot.profile.active = true;
+        robot.profile.a = a;
+        for (int i = 0; i < 500; ++i)
+            feedforward_update(0.0f);
+    }
+
+    float lean_deg(float a)
+    {
+        return atanf(a / GRAVITY_MPS2) * RAD_TO_DEG_F;
+    }
+}
+
+float profile_dir()
+{
+    return dir;
+}
+
+void setUp()
+{
+    robot = {};
+    robot.dt_ms = DT_MS;
+    robot.ff.enable = true;
+    robot.ff.k_ang = 1.0f;
+    robot.ff.k_tor = 0.5f;
+    dir = 1.0f;
+    feedforward_reset();
+}
+
+void tearDown() {}
+
+void test_lean_and_torque_from_profile_acc()
+{
+    settle_profile(1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, robot.ff.acc);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, lean_deg(1.0f), robot.ff.ang); // 约 5.82 度
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f, robot.ff.tor);
+
+    // 增益线性作用在各自的项上
+    robot.ff.k_ang = 0.5f;
+    robot.ff.k_tor = 2.0f;
+    feedforward_update(0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 0.5f * lean_deg(1.0f), robot.ff.ang);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 2.0f, robot.ff.tor);
+}
+
+void test_profile_direction_sets_sign()
+{
+    dir = -1.0f;
+    settle_profile(1.5f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -1.5f, robot.ff.acc);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, -lean_deg(1.5f), robot.ff.ang);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -0.75f, robot.ff.tor);
+}
+
+void test_acc_from_speed_command_ramp()
+{
+    // 速度指令按 1.5 m/s^2 线加速度爬升（轮子 rad/s）
+    const float a = 1.5f;
+    float spd = 0.0f;
+    for (int i = 0; i < 500; ++i)
+    {
+        spd += a / ODOM_WHEEL_RADIUS_M * DT;
+        feedforward_update(spd);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, a, robot.ff.acc);
+    TEST_ASSERT_FLOAT_WITHIN(5e-2f, lean_deg(a), robot.ff.ang);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, robot.ff.k_tor * a, robot.ff.tor);
+
+    // 速度指令不变：加速度衰减到 0
+    for (int i = 0; i < 500; ++i)
+        feedforward_update(spd);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, robot.ff.acc);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 0.0f, robot.ff.ang);
+}
+
+void test_first_cycle_has_no_derivative_kick()
+{
+    feedforward_update(100.0f); // 复位后第一拍没有上一拍指令，不求导
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.acc);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.tor);
+}
+
+void test_limits()
+{
+    robot.ff.k_ang = 3.0f;
+    robot.ff.k_tor = 5.0f;
+    settle_profile(10.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, FF_ACC_LIMIT, robot.ff.acc);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, PITCH_ANGLE_OFFSET_LIMIT, robot.ff.ang); // 3 x 17 度被限到上限
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, FF_TOR_LIMIT, robot.ff.tor);
+}
+
+void test_disabled_contributes_nothing()
+{
+    robot.ff.enable = false;
+    settle_profile(1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, robot.ff.acc); // 加速度照常计算，便于遥测对比
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.ang);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.tor);
+
+    // 运行中关闭：下一拍即清零
+    robot.ff.enable = true;
+    feedforward_update(0.0f);
+    TEST_ASSERT_TRUE(robot.ff.tor > 0.0f);
+    robot.ff.enable = false;
+    feedforward_update(0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.ang);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.tor);
+}
+
+void test_reset_and_bad_dt()
+{
+    settle_profile(1.0f);
+    feedforward_reset();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.acc);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.ang);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.ff.tor);
+
+    robot.dt_ms = 0; // 周期未知：不更新
+    robot.ff.tor = 0.25f;
+    feedforward_update(50.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, robot.ff.tor);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lean_and_torque_from_profile_acc);
+    RUN_TEST(test_profile_direction_sets_sign);
+    RUN_TEST(test_acc_from_speed_command_ramp);
+    RUN_TEST(test_first_cycle_has_no_derivative_kick);
+    RUN_TEST(test_limits);
+    RUN_TEST(test_disabled_contributes_nothing);
+    RUN_TEST(test_reset_and_bad_dt);
+    return UNITY_END();
+}
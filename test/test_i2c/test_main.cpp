@@ -0,0 +1,166 @@
+// I2C 总线：引脚读回钩子模拟被从机拉住的 SDA，检查恢复脉冲、耗时直方图和异步恢复请求
+#include <unity.h>
+#include "my_hardware_lib/my_I2C.cpp"
+
+TwoWire Wire = TwoWire(0);
+
+namespace
+{
+    int stuck_pulses = 0; // 从机在收到这么多个 SCL 脉冲后放开 SDA；<0 表示永不放开
+    int stuck_sda = I2C0_SDA;
+    int stuck_scl = I2C0_SCL;
+
+    int bus_read(int pin)
+    {
+        if (pin == stuck_sda)
+        {
+            const int pulses = static_cast<int>(host_pins().writes[stuck_scl] / 2);
+            if (stuck_pulses < 0 || pulses < stuck_pulses)
+                return LOW;
+        }
+        return host_pins().level[pin];
+    }
+
+    void hold_bus(int sda, int scl, int pulses)
+    {
+        stuck_sda = sda;
+        stuck_scl = scl;
+        stuck_pulses = pulses;
+    }
+}
+
+void setUp()
+{
+    if (!recover_handle)
+        my_i2c_init();
+    memset(stats, 0, sizeof(stats));
+    recover_pending = 0;
+    recover_handle->notify = 0;
+    host_pins() = {};
+    host_pins().read_hook = bus_read;
+    hold_bus(I2C0_SDA, I2C0_SCL, 0);
+    Wire.begins = Wire.ends = 0;
+    ScreenWire.begins = ScreenWire.ends = 0;
+}
+
+void tearDown() {}
+
+void test_init_configures_both_buses()
+{
+    TEST_ASSERT_EQUAL_INT(I2C0_SDA, Wire.sda);
+    TEST_ASSERT_EQUAL_INT(SCREEN_SCL_PIN, ScreenWire.scl);
+    TEST_ASSERT_EQUAL_UINT16(I2C_IMU_TIMEOUT_MS, Wire.timeout_ms);
+    TEST_ASSERT_EQUAL_UINT16(I2C_SCREEN_TIMEOUT_MS, ScreenWire.timeout_ms);
+    TEST_ASSERT_EQUAL_INT(I2C_SCL_TIMEOUT_EXP, host_i2c_timeout()[I2C_NUM_0]);
+    TEST_ASSERT_EQUAL_STRING("i2c_recover", recover_handle->name);
+}
+
+void test_idle_bus_needs_no_pulses()
+{
+    TEST_ASSERT_TRUE(my_i2c_recover(0));
+    TEST_ASSERT_EQUAL_UINT32(1, host_pins().writes[I2C0_SCL]); // 只有 STOP 的那次拉高
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.ends);
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.begins);
+    TEST_ASSERT_EQUAL_UINT32(1, stats[0].recoveries);
+}
+
+void test_stuck_slave_is_clocked_free()
+{
+    hold_bus(I2C0_SDA, I2C0_SCL, 3);
+    TEST_ASSERT_TRUE(my_i2c_recover(0));
+    TEST_ASSERT_EQUAL_UINT32(3 * 2 + 1, host_pins().writes[I2C0_SCL]);
+    // 结束于 STOP：SCL、SDA 都为高
+    TEST_ASSERT_EQUAL_INT(HIGH, host_pins().level[I2C0_SCL]);
+    TEST_ASSERT_EQUAL_INT(HIGH, host_pins().level[I2C0_SDA]);
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.begins);
+}
+
+void test_dead_bus_gives_up_after_nine_pulses()
+{
+    hold_bus(SCREEN_SDA_PIN, SCREEN_SCL_PIN, -1);
+    TEST_ASSERT_FALSE(my_i2c_recover(1));
+    TEST_ASSERT_EQUAL_UINT32(9 * 2 + 1, host_pins().writes[SCREEN_SCL_PIN]);
+    TEST_ASSERT_EQUAL_UINT32(1, ScreenWire.begins); // 放不开也要把驱动装回去
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.ends);
+    TEST_ASSERT_EQUAL_UINT32(1, stats[1].recoveries);
+    TEST_ASSERT_FALSE(my_i2c_recover(I2C_BUS_COUNT));
+}
+
+void test_histogram_bins()
+{
+    my_i2c_record(0, 100, true);
+    my_i2c_record(0, I2C_HIST_EDGES_US[0] - 1, true);
+    my_i2c_record(0, I2C_HIST_EDGES_US[0], true); // 上界归入下一格
+    my_i2c_record(0, 1500, false);
+    my_i2c_record(0, 60000, false);
+    my_i2c_record(0, 300, true);
+    my_i2c_record(I2C_BUS_COUNT, 300, true); // 越界忽略
+
+    TEST_ASSERT_EQUAL_UINT32(4, stats[0].ok);
+    TEST_ASSERT_EQUAL_UINT32(2, stats[0].err);
+    TEST_ASSERT_EQUAL_UINT32(300, stats[0].last_us);
+    TEST_ASSERT_EQUAL_UINT32(60000, stats[0].max_us);
+    const uint32_t expect[I2C_HIST_BINS] = {2, 2, 0, 1, 0, 0, 0, 1};
+    TEST_ASSERT_EQUAL_MEMORY(expect, stats[0].hist, sizeof(expect));
+    TEST_ASSERT_EQUAL_UINT32(0, stats[1].ok);
+
+    JsonDocument doc;
+    i2c_write_stats(doc.to<JsonObject>());
+    TEST_ASSERT_EQUAL_UINT32(I2C_HIST_BINS, doc["imu"]["hist"].size());
+    TEST_ASSERT_EQUAL_UINT32(1, doc["imu"]["hist"][I2C_HIST_BINS - 1].as<uint32_t>());
+}
+
+void test_async_recovery_runs_in_recover_task()
+{
+    hold_bus(I2C0_SDA, I2C0_SCL, 2);
+    my_i2c_recover_async(0);
+    // 请求方不阻塞，也不碰总线
+    TEST_ASSERT_TRUE(my_i2c_recovering(0));
+    TEST_ASSERT_FALSE(my_i2c_recovering(1));
+    TEST_ASSERT_EQUAL_UINT32(0, Wire.ends);
+    TEST_ASSERT_EQUAL_UINT32(0, host_pins().writes[I2C0_SCL]);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_handle->notify);
+
+    // 重复请求不重复排队
+    my_i2c_recover_async(0);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_handle->notify);
+
+    host_task_run(recover_handle);
+    TEST_ASSERT_FALSE(my_i2c_recovering(0));
+    TEST_ASSERT_EQUAL_UINT32(1, stats[0].recoveries);
+    TEST_ASSERT_EQUAL_UINT32(2 * 2 + 1, host_pins().writes[I2C0_SCL]);
+    TEST_ASSERT_EQUAL_UINT32(1, Wire.begins);
+}
+
+void test_async_requests_for_both_buses_share_one_wakeup()
+{
+    my_i2c_recover_async(0);
+    my_i2c_recover_async(1);
+    my_i2c_recover_async(I2C_BUS_COUNT); // 越界忽略
+    TEST_ASSERT_EQUAL_UINT32(2, recover_handle->notify);
+
+    host_task_run(recover_handle);
+    TEST_ASSERT_FALSE(my_i2c_recovering(0));
+    TEST_ASSERT_FALSE(my_i2c_recovering(1));
+    TEST_ASSERT_EQUAL_UINT32(1, stats[0].recoveries);
+    TEST_ASSERT_EQUAL_UINT32(1, stats[1].recoveries);
+
+    // 处理完后可以再次请求
+    my_i2c_recover_async(0);
+    TEST_ASSERT_TRUE(my_i2c_recovering(0));
+    host_task_run(recover_handle);
+    TEST_ASSERT_EQUAL_UINT32(2, stats[0].recoveries);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_init_configures_both_buses);
+    RUN_TEST(test_idle_bus_needs_no_pulses);
+    RUN_TEST(test_stuck_slave_is_clocked_free);
+    RUN_TEST(test_dead_bus_gives_up_after_nine_pulses);
+    RUN_TEST(test_histogram_bins);
+    RUN_TEST(test_async_recovery_runs_in_recover_task);
+    RUN_TEST(test_async_requests_for_both_buses_share_one_wakeup);
+    return UNITY_END();
+}
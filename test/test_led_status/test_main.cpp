@@ -0,0 +1,212 @@
+// 状态灯：led_status_compose 只由快照和时间决定，检查整帧覆盖层的优先级（切断 > IMU 故障 > 起身/倒地 > 编队超时）、
+// 各层闪烁/呼吸随时间的相位，以及首末灯提示层不碰中间的装饰灯；再检查 capture 对控制超时的保持时长
+#include <unity.h>
+#include "my_hardware_lib/my_led_status.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    bool tripped = false;
+    uint32_t missed = 0;
+    bool imu_ok = true;
+
+    constexpr uint16_t N = RGB_LED_COUNT;
+    constexpr rgb_px DECOR = {1, 2, 3};
+    constexpr rgb_px OFF = {0, 0, 0};
+    rgb_px px[N];
+
+    void compose(const led_status_snapshot &s, uint32_t now_ms)
+    {
+        for (rgb_px &p : px)
+            p = DECOR;
+        led_status_compose(s, now_ms, px, N);
+    }
+
+    bool eq(rgb_px a, rgb_px b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b;
+    }
+
+    bool all(rgb_px c)
+    {
+        for (const rgb_px &p : px)
+            if (!eq(p, c))
+                return false;
+        return true;
+    }
+
+    led_status_snapshot everything()
+    {
+        led_status_snapshot s;
+        memset(&s, 1, sizeof(s));
+        return s;
+    }
+}
+
+bool safety_tripped()
+{
+    return tripped;
+}
+uint32_t safety_ctrl_missed()
+{
+    return missed;
+}
+bool my_mpu6050_ok()
+{
+    return imu_ok;
+}
+
+void setUp()
+{
+    robot = {};
+    tripped = false;
+    imu_ok = true;
+}
+
+void tearDown() {}
+
+void test_idle_keeps_decoration()
+{
+    compose({}, 1234);
+    TEST_ASSERT_TRUE(all(DECOR));
+    led_status_compose(everything(), 0, px, 0); // 没有灯：什么都不做
+}
+
+void test_overlay_priority()
+{
+    led_status_snapshot s = everything();
+    compose(s, 0);
+    TEST_ASSERT_TRUE(all(RED)); // 切断压过一切
+
+    s.tripped = false;
+    compose(s, 0);
+    TEST_ASSERT_TRUE(all(MAGENTA)); // 其次 IMU 故障
+
+    s.imu_fault = false;
+    compose(s, 0);
+    TEST_ASSERT_TRUE(eq(px[0], ORANGE)); // 起身的追逐亮点
+    TEST_ASSERT_TRUE(eq(px[1], scale(ORANGE, 32)));
+
+    s.recovering = false;
+    compose(s, 600);
+    TEST_ASSERT_TRUE(all(RED)); // 倒地呼吸到峰值
+
+    s.fallen = false;
+    compose(s, 0);
+    TEST_ASSERT_TRUE(all(AMBER)); // 编队超时
+
+    // 整帧覆盖层之下才是单灯提示
+    s.failsafe = false;
+    compose(s, 0);
+    TEST_ASSERT_TRUE(eq(px[0], WHITE));
+    TEST_ASSERT_TRUE(eq(px[N - 1], RED)); // 掉电风险压过低电量
+    for (uint16_t i = 1; i < N - 1; ++i)
+        TEST_ASSERT_TRUE(eq(px[i], DECOR));
+
+    s.brownout = false;
+    compose(s, 0);
+    TEST_ASSERT_TRUE(eq(px[N - 1], ORANGE));
+}
+
+void test_blink_phases()
+{
+    led_status_snapshot s = {};
+    s.tripped = true; // 200 ms 周期
+    compose(s, 0);
+    TEST_ASSERT_TRUE(all(RED));
+    compose(s, 99);
+    TEST_ASSERT_TRUE(all(RED));
+    compose(s, 100);
+    TEST_ASSERT_TRUE(all(OFF));
+    compose(s, 200);
+    TEST_ASSERT_TRUE(all(RED));
+
+    s = {};
+    s.imu_fault = true; // 500 ms
+    compose(s, 249);
+    TEST_ASSERT_TRUE(all(MAGENTA));
+    compose(s, 250);
+    TEST_ASSERT_TRUE(all(OFF));
+
+    s = {};
+    s.failsafe = true; // 600 ms
+    compose(s, 299);
+    TEST_ASSERT_TRUE(all(AMBER));
+    compose(s, 300);
+    TEST_ASSERT_TRUE(all(OFF));
+    compose(s, 600);
+    TEST_ASSERT_TRUE(all(AMBER));
+
+    s = {};
+    s.overrun = true; // 首灯 160 ms
+    s.brownout = true; // 末灯 300 ms
+    compose(s, 80);
+    TEST_ASSERT_TRUE(eq(px[0], OFF));
+    TEST_ASSERT_TRUE(eq(px[N - 1], RED));
+    compose(s, 150);
+    TEST_ASSERT_TRUE(eq(px[0], OFF));
+    TEST_ASSERT_TRUE(eq(px[N - 1], OFF));
+    compose(s, 160);
+    TEST_ASSERT_TRUE(eq(px[0], WHITE));
+}
+
+void test_fallen_breathes_and_recovery_chases()
+{
+    led_status_snapshot s = {};
+    s.fallen = true; // 1200 ms 三角波
+    uint8_t prev = 0;
+    for (uint32_t t = 0; t <= 600; t += 50)
+    {
+        compose(s, t);
+        TEST_ASSERT_TRUE(px[0].r >= prev);
+        prev = px[0].r;
+    }
+    TEST_ASSERT_EQUAL_UINT8(255, prev);
+    compose(s, 1200);
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].r);
+    compose(s, 900);
+    TEST_ASSERT_TRUE(px[0].r > 100 && px[0].r < 155);
+
+    s = {};
+    s.recovering = true; // 亮点每 120 ms 前进一格，绕一圈回到起点
+    for (uint32_t k = 0; k <= N; ++k)
+    {
+        compose(s, k * 120 + 10);
+        for (uint16_t i = 0; i < N; ++i)
+            TEST_ASSERT_TRUE(eq(px[i], i == k % N ? ORANGE : scale(ORANGE, 32)));
+    }
+}
+
+void test_capture_holds_overrun()
+{
+    missed = 0;
+    TEST_ASSERT_FALSE(led_status_capture(1000).overrun);
+    missed = 3;
+    TEST_ASSERT_TRUE(led_status_capture(2000).overrun);
+    TEST_ASSERT_TRUE(led_status_capture(2000 + RGB_OVERRUN_HOLD_MS - 1).overrun);
+    TEST_ASSERT_FALSE(led_status_capture(2000 + RGB_OVERRUN_HOLD_MS).overrun);
+
+    tripped = true;
+    imu_ok = false;
+    robot.fallen.phase = balance_phase::falling;
+    robot.bat.low = true;
+    const led_status_snapshot s = led_status_capture(5000);
+    TEST_ASSERT_TRUE(s.tripped);
+    TEST_ASSERT_TRUE(s.imu_fault);
+    TEST_ASSERT_TRUE(s.fallen);
+    TEST_ASSERT_FALSE(s.recovering);
+    TEST_ASSERT_TRUE(s.bat_low);
+    TEST_ASSERT_FALSE(s.failsafe); // 未启用编队时不算超时
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_keeps_decoration);
+    RUN_TEST(test_overlay_priority);
+    RUN_TEST(test_blink_phases);
+    RUN_TEST(test_fallen_breathes_and_recovery_chases);
+    RUN_TEST(test_capture_holds_overrun);
+    return UNITY_END();
+}
@@ -0,0 +1,127 @@
+// IMU 读取：模拟连续读取失败，检查外推上限与总线恢复请求的节奏（失败再多也只每 IMU_RECOVER_FAILS 次请求一次）
+#include <unity.h>
+#include "my_hardware_lib/my_mpu6050.cpp"
+
+robot_state robot = {};
+TwoWire Wire = TwoWire(0);
+
+namespace
+{
+    bool recovering = false;
+    uint32_t recover_requests = 0;
+}
+
+void my_i2c_record(uint8_t, uint32_t, bool) {}
+void my_i2c_recover_async(uint8_t bus)
+{
+    if (bus == 0)
+        recover_requests++;
+}
+bool my_i2c_recovering(uint8_t bus)
+{
+    return bus == 0 && recovering;
+}
+
+namespace
+{
+    void read(int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            host_advance_ms(2);
+            my_mpu6050_update();
+        }
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    mpu6050.ok = true;
+    mpu6050.reads = 0;
+    recovering = false;
+    read(1); // 清掉上一个用例的失败计数
+    recover_requests = 0;
+}
+
+void tearDown() {}
+
+void test_recovery_requested_every_n_failures()
+{
+    mpu6050.ok = false;
+    read(IMU_RECOVER_FAILS - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, recover_requests);
+    read(1);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_requests);
+    read(IMU_RECOVER_FAILS);
+    TEST_ASSERT_EQUAL_UINT32(2, recover_requests);
+}
+
+void test_saturated_fail_count_keeps_cadence()
+{
+    // 连续失败超过 255 次后 read_fails 封顶，恢复请求仍保持原来的节奏
+    mpu6050.ok = false;
+    const int n = 300 * IMU_RECOVER_FAILS;
+    read(n);
+    TEST_ASSERT_EQUAL_UINT8(255, read_fails);
+    TEST_ASSERT_EQUAL_UINT32(300, recover_requests);
+    TEST_ASSERT_FALSE(my_mpu6050_ok());
+}
+
+void test_no_bus_access_while_recovering()
+{
+    mpu6050.ok = false;
+    read(IMU_RECOVER_FAILS);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_requests);
+
+    recovering = true;
+    const uint32_t reads = mpu6050.reads;
+    read(50);
+    TEST_ASSERT_EQUAL_UINT32(reads, mpu6050.reads);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_requests); // 恢复期间的失败不算数
+
+    // 恢复完成仍读不到：重新累计 IMU_RECOVER_FAILS 次再请求
+    recovering = false;
+    read(IMU_RECOVER_FAILS - 1);
+    TEST_ASSERT_EQUAL_UINT32(1, recover_requests);
+    read(1);
+    TEST_ASSERT_EQUAL_UINT32(2, recover_requests);
+}
+
+void test_success_resets_counts()
+{
+    mpu6050.ok = false;
+    read(IMU_RECOVER_FAILS - 1);
+    mpu6050.ok = true;
+    read(1);
+    TEST_ASSERT_TRUE(my_mpu6050_ok());
+    mpu6050.ok = false;
+    read(IMU_RECOVER_FAILS - 1);
+    TEST_ASSERT_EQUAL_UINT32(0, recover_requests);
+}
+
+void test_prediction_stops_after_limit()
+{
+    mpu6050.gyro[1] = 100.0f;
+    mpu6050.angle[1] = 5.0f;
+    read(1);
+    mpu6050.ok = false;
+    read(IMU_PREDICT_MAX);
+    TEST_ASSERT_TRUE(my_mpu6050_ok());
+    TEST_ASSERT_TRUE(robot.imu.angley > 5.0f); // 按上一帧角速度外推
+    const float held = robot.imu.angley;
+    read(1);
+    TEST_ASSERT_FALSE(my_mpu6050_ok());
+    TEST_ASSERT_EQUAL_FLOAT(held, robot.imu.angley); // 超过外推上限后不再外推
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_recovery_requested_every_n_failures);
+    RUN_TEST(test_saturated_fail_count_keeps_cadence);
+    RUN_TEST(test_no_bus_access_while_recovering);
+    RUN_TEST(test_success_resets_counts);
+    RUN_TEST(test_prediction_stops_after_limit);
+    return UNITY_END();
+}
@@ -0,0 +1,181 @@
+// 里程计：按脚本驱动左右轮和陀螺仪，检查积分出的位姿与协方差
+#include <unity.h>
+#include "my_motion_lib/my_odom.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    constexpr int DT_MS = 2;
+
+    float gyro_dps_for(float dl, float dr)
+    {
+        return (dr - dl) / ODOM_TRACK_WIDTH_M / (DT_MS * 0.001f) * RAD_TO_DEG_F;
+    }
+
+    // 每周期左右轮前进 dl/dr 米，陀螺仪读数 gyro_dps；前进时编码器转角为负
+    void drive(float dl, float dr, float gyro_dps, int ticks)
+    {
+        for (int i = 0; i < ticks; ++i)
+        {
+            robot.wel.pos1 -= dl / ODOM_WHEEL_RADIUS_M;
+            robot.wel.pos2 -= dr / ODOM_WHEEL_RADIUS_M;
+            robot.imu.gyroz = gyro_dps;
+            my_odom_update();
+        }
+    }
+
+    // 轮子与陀螺仪读数一致的运动
+    void drive_consistent(float dl, float dr, int ticks)
+    {
+        drive(dl, dr, gyro_dps_for(dl, dr), ticks);
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    robot.dt_ms = DT_MS;
+    my_odom_init();
+}
+
+void tearDown() {}
+
+void test_straight_line()
+{
+    drive_consistent(0.001f, 0.001f, 1000); // 1 m
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1.0f, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, robot.odom.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, robot.odom.theta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f, robot.odom.v); // 1 mm / 2 ms
+}
+
+void test_reverse_line()
+{
+    drive_consistent(-0.001f, -0.001f, 500);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -0.5f, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -0.5f, robot.odom.v);
+}
+
+void test_spin_in_place()
+{
+    // 每周期左右轮反向各走 d，500 个周期转 90°
+    const float d = 0.25f * PI / 500 * ODOM_TRACK_WIDTH_M;
+    drive_consistent(-d, d, 500);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * PI, robot.odom.theta);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, robot.odom.y);
+}
+
+void test_quarter_arc()
+{
+    // 半径 0.5 m 左转 90°：终点 (r, r)，航向 π/2
+    const float r = 0.5f;
+    const int ticks = 2000;
+    const float dtheta = 0.5f * PI / ticks;
+    const float dl = dtheta * (r - 0.5f * ODOM_TRACK_WIDTH_M);
+    const float dr = dtheta * (r + 0.5f * ODOM_TRACK_WIDTH_M);
+    drive_consistent(dl, dr, ticks);
+    TEST_ASSERT_FLOAT_WITHIN(2e-3f, r, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(2e-3f, r, robot.odom.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f * PI, robot.odom.theta);
+}
+
+void test_heading_wraps_to_pi()
+{
+    const float d = 0.75f * PI / 500 * ODOM_TRACK_WIDTH_M;
+    drive_consistent(-d, d, 500); // 左转 270°
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -0.5f * PI, robot.odom.theta);
+}
+
+void test_wheel_slip_trusts_gyro()
+{
+    // 轮子原地打滑报告转向，陀螺仪没有转动：航向只取轮速的那部分权重
+    const float d = 0.0005f;
+    drive(-d, d, 0.0f, 100);
+    const float enc = 100 * 2.0f * d / ODOM_TRACK_WIDTH_M;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, (1.0f - ODOM_GYRO_WEIGHT) * enc, robot.odom.theta);
+}
+
+void test_gyro_bias_ignored_at_rest()
+{
+    // 停在原地，陀螺仪有 0.5 deg/s 零偏：10 s 后航向不变
+    drive(0.0f, 0.0f, 0.5f, 5000);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, robot.odom.theta);
+
+    // 行驶时照常融合：零偏按陀螺仪权重积分
+    drive(0.001f, 0.001f, 0.5f, 500);
+    const float bias = 0.5f / RAD_TO_DEG_F * 500 * DT_MS * 0.001f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, ODOM_GYRO_WEIGHT * bias, robot.odom.theta);
+}
+
+void test_covariance_grows_and_resets()
+{
+    drive_consistent(0.001f, 0.001f, 100);
+    const float pxx = robot.odom.cov[0];
+    const float ptt = robot.odom.cov[5];
+    TEST_ASSERT_TRUE(pxx > 0.0f);
+    TEST_ASSERT_TRUE(ptt > 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9f, 0.0f, robot.odom.cov[3]); // 沿 x 行驶，y 方向不增加距离噪声
+
+    drive_consistent(0.001f, 0.001f, 100);
+    TEST_ASSERT_TRUE(robot.odom.cov[0] > pxx);
+    TEST_ASSERT_TRUE(robot.odom.cov[5] > ptt);
+    TEST_ASSERT_TRUE(robot.odom.cov[3] > 0.0f); // 航向不确定性传到横向
+
+    my_odom_reset(1.0f, 2.0f, 3.0f * PI);
+    drive(0.0f, 0.0f, 0.0f, 1); // 控制周期开头应用
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, robot.odom.y);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, PI, fabsf(robot.odom.theta));
+    for (float c : robot.odom.cov)
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, c); // 只剩本周期的时间漂移项
+}
+
+void test_reset_is_applied_by_control_cycle()
+{
+    drive_consistent(0.001f, 0.001f, 100);
+    const float x = robot.odom.x;
+    my_odom_reset(5.0f, 0.0f, 0.0f);
+    // 请求方（网页任务）不直接改位姿
+    TEST_ASSERT_EQUAL_FLOAT(x, robot.odom.x);
+    TEST_ASSERT_TRUE(robot.odom.cov[0] > 0.0f);
+
+    // 同一周期里轮子转过的部分不计入新原点
+    drive_consistent(0.001f, 0.001f, 1);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 5.0f, robot.odom.x);
+    drive_consistent(0.001f, 0.001f, 10);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.01f, robot.odom.x);
+
+    // 连续两次请求只生效最后一次
+    my_odom_reset(1.0f, 0.0f, 0.0f);
+    my_odom_reset(2.0f, 3.0f, 0.0f);
+    drive_consistent(0.0f, 0.0f, 1);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, robot.odom.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.0f, robot.odom.y);
+}
+
+void test_reset_keeps_encoder_reference()
+{
+    robot.wel.pos1 = -10.0f;
+    robot.wel.pos2 = -10.0f;
+    my_odom_reset();
+    drive_consistent(0.0f, 0.0f, 10); // 请求前的累计转角不能算作位移
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, robot.odom.x);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_straight_line);
+    RUN_TEST(test_reverse_line);
+    RUN_TEST(test_spin_in_place);
+    RUN_TEST(test_quarter_arc);
+    RUN_TEST(test_heading_wraps_to_pi);
+    RUN_TEST(test_wheel_slip_trusts_gyro);
+    RUN_TEST(test_gyro_bias_ignored_at_rest);
+    RUN_TEST(test_covariance_grows_and_resets);
+    RUN_TEST(test_reset_keeps_encoder_reference);
+    RUN_TEST(test_reset_is_applied_by_control_cycle);
+    return UNITY_END();
+}
@@ -0,0 +1,241 @@
+// 动作脚本：按控制周期推进，检查速度/加速度/加加速度约束、终点和中止路径
+#include <unity.h>
+#include "my_tool_lib/my_tool.cpp"
+#include "my_motion_lib/my_profile.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    constexpr int DT_MS = 2;
+    constexpr float DT = DT_MS * 0.001f;
+
+    struct run_stats
+    {
+        int ticks;
+        float v_max;
+        float a_max;  // |a| 最大值
+        float da_max; // 相邻周期 |Δa| 最大值
+        float spd_min;
+        float spd_max;
+    };
+
+    profile_segment line(float d, float v, float a, profile_shape shape, float j = PROFILE_J_MAX)
+    {
+        profile_segment s = {};
+        s.d = d;
+        s.v = v;
+        s.a = a;
+        s.j = j;
+        s.shape = shape;
+        return s;
+    }
+
+    // 推进到脚本结束（或达到周期上限），统计过程量
+    run_stats run(int max_ticks = 20000)
+    {
+        run_stats st = {};
+        float last_a = 0.0f;
+        do
+        {
+            profile_tick();
+            st.ticks++;
+            st.v_max = std::max(st.v_max, robot.profile.v);
+            st.a_max = std::max(st.a_max, fabsf(robot.profile.a));
+            // 段末把加速度直接清零的那一步不计入
+            if (robot.profile.active && robot.profile.index == 0)
+                st.da_max = std::max(st.da_max, fabsf(robot.profile.a - last_a));
+            st.spd_min = std::min(st.spd_min, robot.profile.spd_tar);
+            st.spd_max = std::max(st.spd_max, robot.profile.spd_tar);
+            last_a = robot.profile.a;
+        } while (robot.profile.active && st.ticks < max_ticks);
+        return st;
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    robot.dt_ms = DT_MS;
+    robot.run = true;
+    my_profile_init();
+}
+
+void tearDown() {}
+
+void test_trapezoid_reaches_endpoint()
+{
+    TEST_ASSERT_TRUE(profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::trapezoid)));
+    profile_start();
+    const run_stats st = run();
+
+    TEST_ASSERT_FALSE(robot.profile.active);
+    TEST_ASSERT_EQUAL_INT(1, robot.profile.index);
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_ABORT_NONE, robot.profile.abort_reason);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / ODOM_WHEEL_RADIUS_M, robot.profile.pos_tar);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, st.v_max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, st.a_max);
+    // 梯形：d / v + v / a = 2.5 s
+    TEST_ASSERT_INT_WITHIN(25, 1250, st.ticks);
+}
+
+void test_scurve_limits_jerk()
+{
+    const float J = 10.0f;
+    TEST_ASSERT_TRUE(profile_push(line(0.8f, 0.6f, 1.5f, profile_shape::scurve, J)));
+    profile_start();
+    const run_stats st = run();
+
+    TEST_ASSERT_FALSE(robot.profile.active);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.8f / ODOM_WHEEL_RADIUS_M, robot.profile.pos_tar);
+    TEST_ASSERT_TRUE(st.v_max <= 0.6f + 1e-4f);
+    TEST_ASSERT_TRUE(st.a_max <= 1.5f + 1e-4f);
+    TEST_ASSERT_TRUE(st.da_max <= J * DT + 1e-4f); // 每周期加速度变化不超过 J * dt
+}
+
+void test_scurve_is_smoother_than_trapezoid()
+{
+    profile_push(line(0.5f, 0.5f, 2.0f, profile_shape::trapezoid));
+    profile_start();
+    const run_stats trap = run();
+
+    my_profile_init();
+    profile_push(line(0.5f, 0.5f, 2.0f, profile_shape::scurve, 10.0f));
+    profile_start();
+    const run_stats scurve = run();
+
+    TEST_ASSERT_TRUE(trap.da_max > scurve.da_max * 5.0f);
+    TEST_ASSERT_GREATER_THAN(trap.ticks, scurve.ticks); // 平滑的代价是更长的时间
+}
+
+void test_reverse_segment()
+{
+    profile_push(line(-0.3f, 0.4f, 1.0f, profile_shape::scurve));
+    profile_start();
+    profile_tick();
+    // 段首周期速度还是 0，方向已经确定
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, profile_dir());
+    const run_stats st = run();
+    TEST_ASSERT_TRUE(st.spd_max <= 0.0f);
+    TEST_ASSERT_TRUE(st.spd_min < 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.3f / ODOM_WHEEL_RADIUS_M, robot.profile.pos_tar);
+}
+
+void test_segments_chain_from_previous_endpoint()
+{
+    profile_push(line(0.2f, 0.5f, 2.0f, profile_shape::trapezoid));
+    profile_push(line(-0.5f, 0.5f, 2.0f, profile_shape::trapezoid));
+    profile_start();
+    run();
+    TEST_ASSERT_EQUAL_INT(2, robot.profile.index);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.3f / ODOM_WHEEL_RADIUS_M, robot.profile.pos_tar);
+}
+
+void test_timed_turn_ramps_yaw()
+{
+    profile_segment s = {};
+    s.w = 90.0f;
+    s.t_ms = 500;
+    profile_push(s);
+    profile_start();
+    int ticks = 0;
+    float yaw_max = 0.0f;
+    float yaw_step_max = 0.0f;
+    float last = 0.0f;
+    do
+    {
+        profile_tick();
+        ticks++;
+        yaw_max = std::max(yaw_max, robot.profile.yaw_rate);
+        if (robot.profile.active) // 脚本结束时直接清零，不属于斜坡
+            yaw_step_max = std::max(yaw_step_max, fabsf(robot.profile.yaw_rate - last));
+        last = robot.profile.yaw_rate;
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.profile.spd_tar);
+    } while (robot.profile.active && ticks < 1000);
+    TEST_ASSERT_INT_WITHIN(2, 500 / DT_MS, ticks);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 90.0f, yaw_max);
+    TEST_ASSERT_TRUE(yaw_step_max <= PROFILE_YAW_ACC * DT + 1e-3f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.profile.yaw_rate);
+}
+
+void test_queue_is_bounded()
+{
+    for (int i = 0; i < PROFILE_QUEUE_LEN; ++i)
+        TEST_ASSERT_TRUE(profile_push(line(0.1f, 0.5f, 1.0f, profile_shape::trapezoid)));
+    TEST_ASSERT_FALSE(profile_push(line(0.1f, 0.5f, 1.0f, profile_shape::trapezoid)));
+}
+
+void test_limits_are_sanitized()
+{
+    profile_push(line(2.0f, 10.0f, 100.0f, profile_shape::trapezoid));
+    profile_start();
+    const run_stats st = run();
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, PROFILE_V_MAX, st.v_max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, PROFILE_A_MAX, st.a_max);
+}
+
+void test_joystick_aborts_and_holds_position()
+{
+    profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::scurve));
+    profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::scurve));
+    profile_start();
+    for (int i = 0; i < 200; ++i)
+        profile_tick();
+    TEST_ASSERT_TRUE(robot.profile.active);
+
+    robot.pos.now = 3.0f;
+    robot.joy.y = 0.5f;
+    profile_tick();
+    TEST_ASSERT_FALSE(robot.profile.active);
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_ABORT_JOY, robot.profile.abort_reason);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.profile.spd_tar);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, robot.pos.tar);
+
+    // 队列已清空：重新启动不会执行剩下的段
+    robot.joy.y = 0.0f;
+    profile_start();
+    profile_tick();
+    TEST_ASSERT_FALSE(robot.profile.active);
+    TEST_ASSERT_EQUAL_INT(0, robot.profile.index);
+}
+
+void test_stop_and_safety_reasons()
+{
+    profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::scurve));
+    profile_start();
+    profile_tick();
+    profile_stop();
+    profile_tick();
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_ABORT_USER, robot.profile.abort_reason);
+
+    profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::scurve));
+    profile_start();
+    profile_tick();
+    robot.ang.err = PROFILE_ABORT_PITCH + 1.0f;
+    profile_tick();
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_ABORT_PITCH, robot.profile.abort_reason);
+
+    robot.ang.err = 0.0f;
+    profile_push(line(1.0f, 0.5f, 1.0f, profile_shape::scurve));
+    profile_start();
+    profile_tick();
+    robot.run = false;
+    profile_tick();
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_ABORT_RUN, robot.profile.abort_reason);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_trapezoid_reaches_endpoint);
+    RUN_TEST(test_scurve_limits_jerk);
+    RUN_TEST(test_scurve_is_smoother_than_trapezoid);
+    RUN_TEST(test_reverse_segment);
+    RUN_TEST(test_segments_chain_from_previous_endpoint);
+    RUN_TEST(test_timed_turn_ramps_yaw);
+    RUN_TEST(test_queue_is_bounded);
+    RUN_TEST(test_limits_are_sanitized);
+    RUN_TEST(test_joystick_aborts_and_holds_position);
+    RUN_TEST(test_stop_and_safety_reasons);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+// 灯效：rgb_render 只由模式和时间决定，检查各灯效的周期、包络和流星头部位置；再检查 RMT 输出只发变化的帧
+#include <unity.h>
+#include "my_hardware_lib/my_rgb.cpp"
+
+robot_state robot = {};
+
+led_status_snapshot led_status_capture(uint32_t)
+{
+    return {};
+}
+void led_status_compose(const led_status_snapshot &, uint32_t, rgb_px *, uint16_t) {}
+
+namespace
+{
+    constexpr uint16_t N = RGB_LED_COUNT;
+
+    bool same(const rgb_px *a, const rgb_px *b, uint16_t count)
+    {
+        return memcmp(a, b, sizeof(rgb_px) * count) == 0;
+    }
+
+    int brightest(const rgb_px *px, uint16_t count)
+    {
+        int best = 0;
+        for (int i = 1; i < count; i++)
+            if (px[i].r + px[i].g + px[i].b > px[best].r + px[best].g + px[best].b)
+                best = i;
+        return best;
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    host_rmt() = {};
+    tx_valid = false;
+}
+
+void tearDown() {}
+
+void test_render_depends_only_on_mode_and_time()
+{
+    for (int mode = RGB_MODE_NEON; mode <= RGB_MODE_HEARTBEAT; mode++)
+    {
+        rgb_px a[N], b[N], other[N];
+        rgb_render(mode, 12345, a, N);
+        rgb_render(mode, 777, other, N); // 中间插一帧别的时间，不应影响结果
+        rgb_render(mode, 12345, b, N);
+        TEST_ASSERT_TRUE(same(a, b, N));
+    }
+}
+
+void test_render_touches_only_count_pixels()
+{
+    rgb_px px[N + 1];
+    memset(px, 0xAB, sizeof(px));
+    rgb_render(RGB_MODE_NEON, 100, px, N);
+    TEST_ASSERT_EQUAL_UINT8(0xAB, px[N].r);
+
+    memset(px, 0xAB, sizeof(px));
+    rgb_render(RGB_MODE_NEON, 100, px, 0);
+    TEST_ASSERT_EQUAL_UINT8(0xAB, px[0].r);
+}
+
+void test_unknown_mode_is_dark()
+{
+    rgb_px px[N];
+    memset(px, 0xAB, sizeof(px));
+    rgb_render(99, 100, px, N);
+    for (const rgb_px &p : px)
+        TEST_ASSERT_EQUAL_UINT32(0, p.r + p.g + p.b);
+}
+
+void test_neon_cycles_every_256_steps()
+{
+    rgb_px a[N], b[N], c[N];
+    rgb_render(RGB_MODE_NEON, 1000, a, N);
+    rgb_render(RGB_MODE_NEON, 1000 + 256 * 20, b, N);
+    rgb_render(RGB_MODE_NEON, 1000 + 20, c, N);
+    TEST_ASSERT_TRUE(same(a, b, N));
+    TEST_ASSERT_FALSE(same(a, c, N));
+    TEST_ASSERT_FALSE(same(&a[0], &a[1], 1)); // 沿灯带分布不同颜色
+}
+
+void test_breath_envelope()
+{
+    rgb_px px[N];
+    rgb_render(RGB_MODE_BREATH, 0, px, N);
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].g);
+    rgb_render(RGB_MODE_BREATH, 255 * 8, px, N);
+    TEST_ASSERT_EQUAL_UINT8(255, px[0].g);
+    TEST_ASSERT_TRUE(px[0].b > px[0].r);
+    rgb_render(RGB_MODE_BREATH, 511 * 8, px, N);
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].g);
+    TEST_ASSERT_TRUE(same(&px[0], &px[N - 1], 1)); // 整条同色
+}
+
+void test_heartbeat_double_pulse()
+{
+    rgb_px px[N];
+    uint32_t period = 0;
+    for (const beat_stage_cfg &s : HEART_STAGES)
+        period += s.duration_ms;
+
+    rgb_render(RGB_MODE_HEARTBEAT, 0, px, N);
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].r);
+    rgb_render(RGB_MODE_HEARTBEAT, 70, px, N); // 第一下峰值
+    TEST_ASSERT_EQUAL_UINT8(255, px[0].r);
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].g);
+    rgb_render(RGB_MODE_HEARTBEAT, 70 + 120 + 90 + 160, px, N); // 第二下峰值
+    TEST_ASSERT_EQUAL_UINT8(200, px[0].r);
+    rgb_render(RGB_MODE_HEARTBEAT, period - 100, px, N); // 长间隔
+    TEST_ASSERT_EQUAL_UINT8(0, px[0].r);
+    rgb_render(RGB_MODE_HEARTBEAT, period + 70, px, N);
+    TEST_ASSERT_EQUAL_UINT8(255, px[0].r);
+}
+
+void test_meteor_head_moves_with_time()
+{
+    rgb_px px[N];
+    // 6 像素/秒：每 1000/6 ms 前进一格
+    for (int k = 0; k < N; k++)
+    {
+        rgb_render(RGB_MODE_METEOR, k * 1000 / 6 + 10, px, N);
+        TEST_ASSERT_EQUAL_INT(k, brightest(px, N));
+    }
+    // 绕一圈回到起点
+    rgb_render(RGB_MODE_METEOR, N * 1000 / 6 + 10, px, N);
+    TEST_ASSERT_EQUAL_INT(0, brightest(px, N));
+
+    // 尾迹在头部后方逐格变暗
+    rgb_render(RGB_MODE_METEOR, 3 * 1000 / 6 + 10, px, N);
+    TEST_ASSERT_TRUE(px[3].r > px[2].r);
+    TEST_ASSERT_TRUE(px[2].r > px[1].r);
+    TEST_ASSERT_TRUE(px[1].r > px[0].r);
+}
+
+void test_output_sends_only_changed_frames()
+{
+    robot.rgb.mode = RGB_MODE_BREATH;
+    robot.rgb.rgb_count = N;
+    my_rgb_init();
+    TEST_ASSERT_EQUAL_UINT32(1, host_rmt().writes); // 启动时清灯
+    TEST_ASSERT_EQUAL_UINT32(N * 3, host_rmt().last_size);
+
+    host_advance_ms(1000);
+    my_rgb_update();
+    TEST_ASSERT_EQUAL_UINT32(2, host_rmt().writes);
+    my_rgb_update(); // 同一时刻画面不变，不重发
+    TEST_ASSERT_EQUAL_UINT32(2, host_rmt().writes);
+
+    // 上一帧未发完：跳过，发送缓冲保持不变
+    host_rmt().busy = true;
+    uint8_t sent[N * 3];
+    memcpy(sent, tx_buf, sizeof(sent));
+    host_advance_ms(100);
+    my_rgb_update();
+    TEST_ASSERT_EQUAL_UINT32(2, host_rmt().writes);
+    TEST_ASSERT_EQUAL_MEMORY(sent, tx_buf, sizeof(sent));
+
+    host_rmt().busy = false;
+    my_rgb_update();
+    TEST_ASSERT_EQUAL_UINT32(3, host_rmt().writes);
+    // GRB 线序并按全局亮度缩放
+    rgb_px px[N];
+    rgb_render(RGB_MODE_BREATH, millis(), px, N);
+    TEST_ASSERT_EQUAL_UINT8((px[0].g * (RGB_BRIGHTNESS + 1)) >> 8, host_rmt().last[0]);
+    TEST_ASSERT_EQUAL_UINT8((px[0].r * (RGB_BRIGHTNESS + 1)) >> 8, host_rmt().last[1]);
+}
+
+void test_translator_encodes_msb_first()
+{
+    TEST_ASSERT_TRUE(host_rmt().translator == nullptr); // setUp 清过，重新安装
+    my_rgb_init();
+    const uint8_t src[2] = {0x81, 0xFF};
+    rmt_item32_t items[16];
+    size_t used = 0, num = 0;
+    host_rmt().translator(src, items, sizeof(src), 12, &used, &num); // 只够放一个字节
+    TEST_ASSERT_EQUAL_UINT32(1, used);
+    TEST_ASSERT_EQUAL_UINT32(8, num);
+    TEST_ASSERT_EQUAL_UINT32(32, items[0].duration0); // 1 码
+    TEST_ASSERT_EQUAL_UINT32(16, items[1].duration0); // 0 码
+    TEST_ASSERT_EQUAL_UINT32(32, items[7].duration0);
+    TEST_ASSERT_EQUAL_UINT32(1, items[0].level0);
+    TEST_ASSERT_EQUAL_UINT32(0, items[0].level1);
+}
+
+int main()
+{
+    rgb_lut_init();
+    UNITY_BEGIN();
+    RUN_TEST(test_render_depends_only_on_mode_and_time);
+    RUN_TEST(test_render_touches_only_count_pixels);
+    RUN_TEST(test_unknown_mode_is_dark);
+    RUN_TEST(test_neon_cycles_every_256_steps);
+    RUN_TEST(test_breath_envelope);
+    RUN_TEST(test_heartbeat_double_pulse);
+    RUN_TEST(test_meteor_head_moves_with_time);
+    RUN_TEST(test_output_sends_only_changed_frames);
+    RUN_TEST(test_translator_encodes_msb_first);
+    return UNITY_END();
+}
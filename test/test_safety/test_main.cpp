@@ -0,0 +1,201 @@
+// 安全监控：按定时器周期推进，模拟控制任务停跳，检查中断切断、恢复后的解除运行与日志，以及故障注入上限
+#include <unity.h>
+#define MY_SAFETY_INJECT 1
+#include "my_hardware_lib/my_safety.cpp"
+
+robot_state robot = {};
+
+static int kills_isr = 0;
+static int kills = 0;
+void my_motor_kill_isr()
+{
+    kills_isr++;
+}
+void my_motor_kill()
+{
+    kills++;
+}
+
+namespace
+{
+    // 推进一个监控周期：各任务先按需跳动，再执行定时器中断
+    void tick(bool ctrl_beat = true)
+    {
+        if (ctrl_beat)
+            safety_beat(SAFETY_TASK_CTRL);
+        safety_beat(SAFETY_TASK_TELEM);
+        safety_beat(SAFETY_TASK_SCREEN);
+        safety_beat(SAFETY_TASK_RGB);
+        host_timer_fire();
+    }
+
+    void ticks(int n, bool ctrl_beat = true)
+    {
+        for (int i = 0; i < n; ++i)
+            tick(ctrl_beat);
+    }
+
+    // 控制任务在 stall_ticks 个周期内停跳后恢复
+    void stall_ctrl(int stall_ticks)
+    {
+        ticks(stall_ticks, false);
+        tick();
+    }
+}
+
+void setUp()
+{
+    for (task_monitor &m : monitors)
+    {
+        m.beats = m.seen_beats = 0;
+        m.idle_ticks = m.stalls = m.max_idle = 0;
+    }
+    tripped = false;
+    trip_count = missed_ticks = 0;
+    inject_until_ms = 0;
+    trip_pending_log = false;
+    kills_isr = kills = 0;
+    robot = {};
+    robot.run = true;
+    my_safety_init();
+    host_wdt() = {};
+    Serial.lines = 0;
+}
+
+void tearDown() {}
+
+void test_timer_runs_at_control_period()
+{
+    TEST_ASSERT_TRUE(host_timer().enabled);
+    TEST_ASSERT_TRUE(host_timer().isr == &on_safety_tick);
+    TEST_ASSERT_EQUAL_UINT32(SAFETY_TICK_US, (uint32_t)host_timer().alarm_us);
+}
+
+void test_healthy_tasks_never_trip()
+{
+    ticks(5000);
+    TEST_ASSERT_FALSE(safety_tripped());
+    TEST_ASSERT_EQUAL_INT(0, kills_isr);
+    TEST_ASSERT_EQUAL_UINT32(0, safety_ctrl_missed());
+    TEST_ASSERT_EQUAL_UINT32(5000, host_wdt().resets);
+}
+
+void test_short_stall_is_counted_not_tripped()
+{
+    ticks(10);
+    stall_ctrl(SAFETY_CTRL_MISS_MAX - 1);
+    TEST_ASSERT_FALSE(safety_tripped());
+    TEST_ASSERT_EQUAL_INT(0, kills_isr);
+    // 第一个空周期只是相位抖动，之后每个周期计一次错过
+    TEST_ASSERT_EQUAL_UINT32(SAFETY_CTRL_MISS_MAX - 2, safety_ctrl_missed());
+    TEST_ASSERT_EQUAL_UINT32(SAFETY_CTRL_MISS_MAX - 1, monitors[SAFETY_TASK_CTRL].max_idle);
+    TEST_ASSERT_TRUE(robot.run);
+}
+
+void test_stall_kills_motor_in_isr()
+{
+    ticks(10);
+    ticks(SAFETY_CTRL_MISS_MAX - 1, false);
+    TEST_ASSERT_FALSE(safety_tripped());
+    tick(false);
+    TEST_ASSERT_TRUE(safety_tripped());
+    TEST_ASSERT_EQUAL_INT(1, kills_isr);
+    TEST_ASSERT_EQUAL_INT(0, kills); // 中断里只走寄存器路径
+
+    // 持续停摆不重复切断
+    ticks(100, false);
+    TEST_ASSERT_EQUAL_INT(1, kills_isr);
+    TEST_ASSERT_EQUAL_UINT32(1, trip_count);
+    TEST_ASSERT_EQUAL_UINT32(1, monitors[SAFETY_TASK_CTRL].stalls);
+}
+
+void test_recovery_disarms_and_logs_off_the_control_path()
+{
+    ticks(10);
+    stall_ctrl(SAFETY_CTRL_MISS_MAX + 5);
+    const uint32_t trip_ms = millis() - SAFETY_TICK_US / 1000; // 恢复跳动发生在最后一次中断之前
+    TEST_ASSERT_FALSE(safety_tripped());
+    TEST_ASSERT_FALSE(robot.run); // 需人工重新启用
+    TEST_ASSERT_EQUAL_INT(1, kills);
+    TEST_ASSERT_EQUAL_UINT32(0, Serial.lines); // safety_beat 在控制任务里，不打印
+
+    safety_log_poll();
+    TEST_ASSERT_EQUAL_UINT32(1, Serial.lines);
+    TEST_ASSERT_TRUE(strstr(Serial.last, "[SAFETY]") != nullptr);
+    TEST_ASSERT_EQUAL_UINT32(trip_ms, last_trip_ms);
+    safety_log_poll();
+    TEST_ASSERT_EQUAL_UINT32(1, Serial.lines);
+
+    // 恢复后再次停摆会再次切断
+    robot.run = true;
+    stall_ctrl(SAFETY_CTRL_MISS_MAX);
+    TEST_ASSERT_EQUAL_INT(2, kills_isr);
+    TEST_ASSERT_EQUAL_UINT32(2, trip_count);
+}
+
+void test_slow_task_stall_does_not_kill_motor()
+{
+    for (uint32_t i = 0; i < monitors[SAFETY_TASK_TELEM].timeout_ticks + 10; ++i)
+    {
+        safety_beat(SAFETY_TASK_CTRL);
+        host_timer_fire();
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, monitors[SAFETY_TASK_TELEM].stalls);
+    TEST_ASSERT_EQUAL_UINT32(1, monitors[SAFETY_TASK_RGB].stalls);
+    TEST_ASSERT_FALSE(safety_tripped());
+    TEST_ASSERT_EQUAL_INT(0, kills_isr);
+}
+
+void test_injected_stall_trips_and_recovers()
+{
+    ticks(10);
+    const uint32_t resets = host_wdt().resets;
+    safety_inject_stall(100);
+    ticks(100 * 1000 / SAFETY_TICK_US - 1);
+    TEST_ASSERT_TRUE(safety_tripped());
+    TEST_ASSERT_EQUAL_UINT32(resets, host_wdt().resets); // 注入期间不喂狗
+    ticks(5);
+    TEST_ASSERT_FALSE(safety_tripped());
+    TEST_ASSERT_FALSE(robot.run);
+}
+
+void test_injection_is_clamped_below_watchdog()
+{
+    ticks(10);
+    safety_inject_stall(60000);
+    const uint32_t t0 = millis();
+    uint32_t resets = host_wdt().resets;
+    while (host_wdt().resets == resets && millis() - t0 < 60000)
+        tick();
+    const uint32_t stalled_ms = millis() - t0;
+    TEST_ASSERT_UINT32_WITHIN(2 * SAFETY_TICK_US / 1000, SAFETY_INJECT_MAX_MS, stalled_ms);
+    TEST_ASSERT_TRUE(stalled_ms < SAFETY_TWDT_TIMEOUT_S * 1000UL);
+}
+
+void test_state_reports_stalls()
+{
+    ticks(10);
+    stall_ctrl(SAFETY_CTRL_MISS_MAX);
+    JsonDocument doc;
+    safety_write_state(doc.to<JsonObject>());
+    TEST_ASSERT_EQUAL_UINT32(1, doc["trips"].as<uint32_t>());
+    TEST_ASSERT_FALSE(doc["tripped"].as<bool>());
+    TEST_ASSERT_EQUAL_UINT32(1, doc["tasks"]["ctrl"]["stalls"].as<uint32_t>());
+    TEST_ASSERT_EQUAL_UINT32(SAFETY_CTRL_MISS_MAX * SAFETY_TICK_US / 1000,
+                             doc["tasks"]["ctrl"]["max_idle_ms"].as<uint32_t>());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_timer_runs_at_control_period);
+    RUN_TEST(test_healthy_tasks_never_trip);
+    RUN_TEST(test_short_stall_is_counted_not_tripped);
+    RUN_TEST(test_stall_kills_motor_in_isr);
+    RUN_TEST(test_recovery_disarms_and_logs_off_the_control_path);
+    RUN_TEST(test_slow_task_stall_does_not_kill_motor);
+    RUN_TEST(test_injected_stall_trips_and_recovers);
+    RUN_TEST(test_injection_is_clamped_below_watchdog);
+    RUN_TEST(test_state_reports_stalls);
+    return UNITY_END();
+}
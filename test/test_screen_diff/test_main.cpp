@@ -0,0 +1,121 @@
+// 屏幕差分刷新：screen_diff_page 对一页帧缓冲给出需要重发的列区间，检查无变化、页边缘单字节、
+// 多段分散变化（合并为一个覆盖区间）和整页变化；再按 my_screen 的方式逐页应用，影子缓冲与新帧一致
+#include <unity.h>
+#include "my_config.h"
+#include "my_screen.h"
+
+namespace
+{
+    constexpr int W = SCREEN_WIDTH;
+    constexpr int PAGES = SCREEN_HEIGHT / 8;
+    uint8_t cur[W * PAGES];
+    uint8_t prev[W * PAGES];
+
+    bool diff(int page, int &first, int &last)
+    {
+        return screen_diff_page(cur + page * W, prev + page * W, W, first, last);
+    }
+}
+
+void setUp()
+{
+    for (int i = 0; i < W * PAGES; ++i)
+        cur[i] = prev[i] = static_cast<uint8_t>(i * 7);
+}
+
+void tearDown() {}
+
+void test_no_change()
+{
+    int first = -1, last = -1;
+    for (int page = 0; page < PAGES; ++page)
+        TEST_ASSERT_FALSE(diff(page, first, last));
+}
+
+void test_single_byte_at_page_edges()
+{
+    int first, last;
+    cur[0] ^= 0x01; // 第 0 页第一列
+    TEST_ASSERT_TRUE(diff(0, first, last));
+    TEST_ASSERT_EQUAL_INT(0, first);
+    TEST_ASSERT_EQUAL_INT(0, last);
+    TEST_ASSERT_FALSE(diff(1, first, last)); // 不影响相邻页
+
+    setUp();
+    cur[W - 1] ^= 0x80; // 第 0 页最后一列
+    TEST_ASSERT_TRUE(diff(0, first, last));
+    TEST_ASSERT_EQUAL_INT(W - 1, first);
+    TEST_ASSERT_EQUAL_INT(W - 1, last);
+    TEST_ASSERT_FALSE(diff(1, first, last));
+
+    setUp();
+    cur[(PAGES - 1) * W + W - 1] ^= 0xFF; // 最后一页最后一列
+    TEST_ASSERT_FALSE(diff(PAGES - 2, first, last));
+    TEST_ASSERT_TRUE(diff(PAGES - 1, first, last));
+    TEST_ASSERT_EQUAL_INT(W - 1, first);
+    TEST_ASSERT_EQUAL_INT(W - 1, last);
+}
+
+void test_disjoint_spans_cover_all_changes()
+{
+    int first, last;
+    const int cols[] = {5, 6, 40, 90, 91, 92};
+    for (int c : cols)
+        cur[W + c] ^= 0x10;
+    TEST_ASSERT_FALSE(diff(0, first, last));
+    TEST_ASSERT_TRUE(diff(1, first, last));
+    // 一页只发一个区间：从第一处变化到最后一处变化
+    TEST_ASSERT_EQUAL_INT(5, first);
+    TEST_ASSERT_EQUAL_INT(92, last);
+}
+
+void test_full_page_change()
+{
+    int first, last;
+    for (int i = 0; i < W; ++i)
+        cur[2 * W + i] = static_cast<uint8_t>(~prev[2 * W + i]);
+    TEST_ASSERT_TRUE(diff(2, first, last));
+    TEST_ASSERT_EQUAL_INT(0, first);
+    TEST_ASSERT_EQUAL_INT(W - 1, last);
+}
+
+void test_applying_spans_syncs_shadow()
+{
+    uint32_t seed = 7;
+    for (int frame = 0; frame < 200; ++frame)
+    {
+        // 随机改几个字节，按 my_screen 的 flush_dirty 逐页只拷贝区间
+        for (int n = frame % 5; n > 0; --n)
+        {
+            seed = seed * 1103515245u + 12345u;
+            cur[(seed >> 8) % (W * PAGES)] ^= static_cast<uint8_t>(seed >> 24) | 1;
+        }
+        uint32_t bytes = 0;
+        for (int page = 0; page < PAGES; ++page)
+        {
+            int first, last;
+            if (!diff(page, first, last))
+                continue;
+            TEST_ASSERT_TRUE(first <= last);
+            TEST_ASSERT_TRUE(cur[page * W + first] != prev[page * W + first]);
+            TEST_ASSERT_TRUE(cur[page * W + last] != prev[page * W + last]);
+            memcpy(prev + page * W + first, cur + page * W + first, last - first + 1);
+            bytes += last - first + 1;
+        }
+        TEST_ASSERT_EQUAL_MEMORY(cur, prev, sizeof(cur));
+        TEST_ASSERT_TRUE(bytes <= sizeof(cur));
+        if (frame % 5 == 0)
+            TEST_ASSERT_EQUAL_UINT32(0, bytes); // 没改动的帧不发送
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_change);
+    RUN_TEST(test_single_byte_at_page_edges);
+    RUN_TEST(test_disjoint_spans_cover_all_changes);
+    RUN_TEST(test_full_page_change);
+    RUN_TEST(test_applying_spans_syncs_shadow);
+    return UNITY_END();
+}
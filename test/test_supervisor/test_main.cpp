@@ -0,0 +1,353 @@
+// 平衡监控状态机：脚本化的姿态序列 + 简化的倒地车体模型，检查状态切换、自恢复与日志；
+// 另用两个线程模拟控制任务写日志、WS 任务读日志，检查读到的条目不会是写了一半的
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "my_motion_lib/my_supervisor.cpp"
+
+robot_state robot = {};
+volatile float motor_left_u = 0.0f;
+volatile float motor_right_u = 0.0f;
+
+static int idle_resets = 0;
+void control_idle_reset()
+{
+    idle_resets++;
+}
+
+namespace
+{
+    constexpr uint32_t DT_MS = 2;
+    float kick_gain = 0.0f; // 车体模型：俯仰角速度 = kick_gain x 电机指令（deg/s），0 表示车体不动
+
+    // 推进 ms 毫秒；hold 为 true 时姿态由测试固定，否则按车体模型积分
+    void run_ms(uint32_t ms, bool hold = true)
+    {
+        for (uint32_t t = 0; t < ms; t += DT_MS)
+        {
+            host_advance_ms(DT_MS);
+            if (!hold)
+            {
+                robot.imu.gyroy = kick_gain * motor_left_u;
+                robot.imu.angley += robot.imu.gyroy * DT_MS * 0.001f;
+            }
+            supervisor_tick();
+        }
+    }
+
+    void pose(float pitch, float rate = 0.0f, float wheel = 0.0f)
+    {
+        robot.imu.angley = pitch;
+        robot.imu.gyroy = rate;
+        robot.spd.now = wheel;
+    }
+
+    balance_phase phase()
+    {
+        return robot.fallen.phase;
+    }
+
+    // 从 idle 起控到 balancing
+    void arm()
+    {
+        robot.run = true;
+        pose(0.0f);
+        run_ms(ARM_HOLD_MS + 20);
+        TEST_ASSERT_TRUE(phase() == balance_phase::balancing);
+    }
+
+    // 倾倒并落地静止
+    void fall_over()
+    {
+        pose(60.0f, 200.0f);
+        run_ms(COUNT_FALL_MAX * DT_MS);
+        TEST_ASSERT_TRUE(phase() == balance_phase::falling);
+        pose(80.0f);
+        run_ms(SETTLE_MS + 20);
+        TEST_ASSERT_TRUE(phase() == balance_phase::fallen);
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    robot.dt_ms = DT_MS;
+    robot.fallen.enable = true;
+    robot.fallen.recover = true;
+    motor_left_u = motor_right_u = 0.0f;
+    idle_resets = 0;
+    kick_gain = 0.0f;
+    host_advance_ms(10000);
+    supervisor_log_poll(); // 丢弃上一个用例留下的日志
+    Serial.lines = 0;
+}
+
+void tearDown() {}
+
+void test_monitor_disabled_follows_run_switch()
+{
+    robot.fallen.enable = false;
+    robot.run = true;
+    pose(60.0f); // 未启用监控时倾角不影响状态
+    run_ms(10);
+    TEST_ASSERT_TRUE(phase() == balance_phase::balancing);
+    TEST_ASSERT_FALSE(robot.fallen.is);
+    robot.run = false;
+    run_ms(10);
+    TEST_ASSERT_TRUE(phase() == balance_phase::idle);
+}
+
+void test_arming_waits_for_upright_hold()
+{
+    robot.run = true;
+    pose(20.0f); // 超出起控窗口
+    run_ms(1000);
+    TEST_ASSERT_TRUE(phase() == balance_phase::arming);
+
+    pose(2.0f, 50.0f); // 角度可以但晃得太快
+    run_ms(1000);
+    TEST_ASSERT_TRUE(phase() == balance_phase::arming);
+
+    pose(2.0f);
+    run_ms(ARM_HOLD_MS - 20);
+    TEST_ASSERT_TRUE(phase() == balance_phase::arming);
+    run_ms(40);
+    TEST_ASSERT_TRUE(phase() == balance_phase::balancing);
+}
+
+void test_fall_needs_consecutive_samples()
+{
+    arm();
+    pose(40.0f);
+    run_ms((COUNT_FALL_MAX - 1) * DT_MS);
+    pose(0.0f); // 单个尖峰不算倒地
+    run_ms(DT_MS);
+    TEST_ASSERT_TRUE(phase() == balance_phase::balancing);
+
+    // 倾角未超硬阈值，但仍在快速倾倒
+    pose(FALL_RATE_PITCH + 2.0f, FALL_RATE_MAX + 20.0f);
+    run_ms(COUNT_FALL_MAX * DT_MS);
+    TEST_ASSERT_TRUE(phase() == balance_phase::falling);
+    TEST_ASSERT_TRUE(robot.fallen.is);
+    TEST_ASSERT_GREATER_THAN(0, idle_resets);
+}
+
+void test_falling_cuts_joystick()
+{
+    arm();
+    robot.joy.y = 0.8f;
+    robot.group_cfg.target_linear = 0.5f;
+    pose(45.0f);
+    run_ms(COUNT_FALL_MAX * DT_MS);
+    TEST_ASSERT_TRUE(phase() == balance_phase::falling);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.joy.y);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, robot.group_cfg.target_linear);
+}
+
+void test_caught_while_falling_rearms()
+{
+    arm();
+    pose(45.0f);
+    run_ms(COUNT_FALL_MAX * DT_MS);
+    pose(1.0f); // 被人扶住
+    run_ms(DT_MS);
+    TEST_ASSERT_TRUE(phase() == balance_phase::arming);
+}
+
+void test_self_righting_recovers_balance()
+{
+    arm();
+    fall_over();
+    kick_gain = 400.0f; // 蓄势 +24°，冲击 -100°：从 80° 摆回直立附近
+    run_ms(RECOVER_WAIT_MS - 50);
+    TEST_ASSERT_TRUE(phase() == balance_phase::fallen);
+    run_ms(60);
+    TEST_ASSERT_TRUE(phase() == balance_phase::recovering);
+    TEST_ASSERT_EQUAL_UINT8(1, robot.fallen.attempts);
+
+    // 先反向蓄势（倾角为正时先正向出力），再朝倾倒方向冲击
+    run_ms(RECOVER_WIND_MS / 2, false);
+    TEST_ASSERT_TRUE(motor_left_u > 0.0f);
+    run_ms(RECOVER_WIND_MS / 2 + 20, false);
+    TEST_ASSERT_TRUE(motor_left_u < 0.0f);
+    run_ms(RECOVER_KICK_MS, false);
+    TEST_ASSERT_TRUE(phase() == balance_phase::balancing);
+    TEST_ASSERT_FALSE(robot.fallen.is);
+}
+
+void test_failed_recovery_gives_up_and_disarms()
+{
+    arm();
+    fall_over();
+    robot.imu.gyroy = 0.0f;
+    for (int i = 0; i < RECOVER_MAX_ATTEMPTS; ++i)
+    {
+        run_ms(RECOVER_WAIT_MS + 10);
+        TEST_ASSERT_TRUE(phase() == balance_phase::recovering);
+        run_ms(RECOVER_TIMEOUT_MS + 10); // 车体模型不动：每次都超时回到倒地
+        TEST_ASSERT_TRUE(phase() == balance_phase::fallen);
+    }
+    TEST_ASSERT_EQUAL_UINT8(RECOVER_MAX_ATTEMPTS, robot.fallen.attempts);
+    run_ms(RECOVER_WAIT_MS + 10);
+    TEST_ASSERT_FALSE(robot.run);
+    TEST_ASSERT_TRUE(phase() == balance_phase::fallen);
+}
+
+void test_recovery_disabled_disarms()
+{
+    robot.fallen.recover = false;
+    arm();
+    fall_over();
+    run_ms(DT_MS);
+    TEST_ASSERT_FALSE(robot.run);
+}
+
+void test_picked_up_from_fallen()
+{
+    robot.fallen.recover = false;
+    arm();
+    fall_over();
+    pose(0.0f);
+    run_ms(ARM_HOLD_MS + 20);
+    TEST_ASSERT_FALSE(robot.fallen.is);
+    TEST_ASSERT_TRUE(phase() == balance_phase::idle); // 运行开关已被解除
+}
+
+void test_transitions_are_logged_off_the_control_path()
+{
+    const uint32_t t0 = millis();
+    arm();
+    TEST_ASSERT_EQUAL_UINT32(0, Serial.lines); // supervisor_tick 自身不打印
+
+    JsonDocument doc;
+    JsonArray log = doc.to<JsonArray>();
+    supervisor_write_log(log);
+    JsonObject last = log[log.size() - 1];
+    TEST_ASSERT_EQUAL_STRING("arming", last["from"].as<const char *>());
+    TEST_ASSERT_EQUAL_STRING("balancing", last["to"].as<const char *>());
+    TEST_ASSERT_TRUE(last["ms"].as<uint32_t>() - t0 >= ARM_HOLD_MS);
+
+    supervisor_log_poll();
+    TEST_ASSERT_EQUAL_UINT32(2, Serial.lines); // idle->arming, arming->balancing
+    TEST_ASSERT_TRUE(strstr(Serial.last, "arming -> balancing") != nullptr);
+    supervisor_log_poll();
+    TEST_ASSERT_EQUAL_UINT32(2, Serial.lines); // 已打印的不重复
+}
+
+void test_log_overflow_is_reported()
+{
+    robot.fallen.enable = false;
+    for (int i = 0; i < SUPERVISOR_LOG_LEN + 4; ++i)
+    {
+        robot.run = !robot.run;
+        run_ms(DT_MS);
+    }
+    supervisor_log_poll();
+    TEST_ASSERT_EQUAL_UINT32(SUPERVISOR_LOG_LEN + 1, Serial.lines); // 一行丢失提示 + 环内全部条目
+
+    JsonDocument doc;
+    JsonArray log = doc.to<JsonArray>();
+    supervisor_write_log(log);
+    TEST_ASSERT_EQUAL_UINT32(SUPERVISOR_LOG_LEN, log.size());
+}
+
+// 读者取了条数快照后，控制任务又写了若干条：被绕回覆盖的最旧条目要丢掉，其余照常返回
+void test_log_copy_drops_entries_overwritten_after_snapshot()
+{
+    robot.fallen.enable = false;
+    for (int i = 0; i < SUPERVISOR_LOG_LEN; ++i)
+    {
+        robot.run = !robot.run;
+        run_ms(DT_MS);
+    }
+    const uint32_t total = log_count;
+    const uint32_t from = total - SUPERVISOR_LOG_LEN;
+    supervisor_event copy[SUPERVISOR_LOG_LEN];
+    TEST_ASSERT_EQUAL_UINT32(from, log_copy(from, total, copy)); // 没有新条目：一条不丢
+
+    const uint32_t more = LOG_SLOTS - SUPERVISOR_LOG_LEN + 3;
+    for (uint32_t i = 0; i < more; ++i)
+    {
+        robot.run = !robot.run;
+        run_ms(DT_MS);
+    }
+    // 快照之后又写了 more 条：最旧的 3 条已被覆盖，第 4 条所在的槽正是下一条的写入位置，也不可信
+    TEST_ASSERT_EQUAL_UINT32(from + 4, log_copy(from, total, copy));
+    // 写了一圈以上：全部作废
+    for (uint32_t i = 0; i < LOG_SLOTS; ++i)
+    {
+        robot.run = !robot.run;
+        run_ms(DT_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, log_copy(from, total, copy));
+}
+
+// 写线程按序号交替切换状态，条目的 ms 即序号，to 由序号奇偶决定；读线程读到的每条都必须自洽且序号连续
+void test_log_reader_never_sees_torn_entries()
+{
+    constexpr uint32_t WRITES = 200000;
+    auto write = [](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t n = log_count;
+            enter(n % 2 ? balance_phase::balancing : balance_phase::idle, n);
+        }
+    };
+    // 先把环写满一圈，挤掉前面用例留下的条目
+    robot.fallen.phase = log_count % 2 ? balance_phase::idle : balance_phase::balancing;
+    write(SUPERVISOR_LOG_LEN * 2);
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        write(WRITES);
+        done = true;
+    });
+
+    bool ok = true;
+    uint32_t reads = 0;
+    while (!done || reads == 0)
+    {
+        JsonDocument doc;
+        JsonArray log = doc.to<JsonArray>();
+        supervisor_write_log(log);
+        reads++;
+        if (log.size() > SUPERVISOR_LOG_LEN)
+            ok = false;
+        for (size_t k = 0; k < log.size(); ++k)
+        {
+            const uint32_t ms = log[k]["ms"].as<uint32_t>();
+            const char *to = ms % 2 ? "balancing" : "idle";
+            const char *from = ms % 2 ? "idle" : "balancing";
+            if (strcmp(to, log[k]["to"].as<const char *>()) != 0 || strcmp(from, log[k]["from"].as<const char *>()) != 0)
+                ok = false;
+            if (k > 0 && ms != log[k - 1]["ms"].as<uint32_t>() + 1)
+                ok = false;
+        }
+    }
+    writer.join();
+    TEST_ASSERT_TRUE(ok);
+
+    JsonDocument doc;
+    JsonArray log = doc.to<JsonArray>();
+    supervisor_write_log(log);
+    TEST_ASSERT_EQUAL_UINT32(SUPERVISOR_LOG_LEN, log.size());
+    TEST_ASSERT_EQUAL_UINT32(log_count - 1, log[SUPERVISOR_LOG_LEN - 1]["ms"].as<uint32_t>());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_monitor_disabled_follows_run_switch);
+    RUN_TEST(test_arming_waits_for_upright_hold);
+    RUN_TEST(test_fall_needs_consecutive_samples);
+    RUN_TEST(test_falling_cuts_joystick);
+    RUN_TEST(test_caught_while_falling_rearms);
+    RUN_TEST(test_self_righting_recovers_balance);
+    RUN_TEST(test_failed_recovery_gives_up_and_disarms);
+    RUN_TEST(test_recovery_disabled_disarms);
+    RUN_TEST(test_picked_up_from_fallen);
+    RUN_TEST(test_transitions_are_logged_off_the_control_path);
+    RUN_TEST(test_log_overflow_is_reported);
+    RUN_TEST(test_log_copy_drops_entries_overwritten_after_snapshot);
+    RUN_TEST(test_log_reader_never_sees_torn_entries);
+    return UNITY_END();
+}
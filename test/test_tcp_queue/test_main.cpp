@@ -0,0 +1,235 @@
+// AsyncTCP 事件环：单线程检查 FIFO 与容量边界；多线程压测多生产者/单消费者的顺序、不丢不重，
+// 以及与 AsyncTCP 相同的用法（空闲包队列 + 事件环 + 扫描标记）下包不泄漏
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "AsyncTCPBoundedQueue.h"
+
+namespace
+{
+    constexpr int PRODUCERS = 4;
+    constexpr uint32_t PER_PRODUCER = 200000;
+
+    uint32_t tag(int producer, uint32_t n)
+    {
+        return (static_cast<uint32_t>(producer) << 24) | n;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_and_bounds()
+{
+    AsyncTCPBoundedQueue<uint32_t, 8> q;
+    uint32_t v = 0;
+    TEST_ASSERT_FALSE(q.pop(v));
+    TEST_ASSERT_TRUE(q.empty());
+
+    // 多绕几圈，覆盖序号回绕
+    uint32_t next_in = 0, next_out = 0;
+    for (int round = 0; round < 100; ++round)
+    {
+        while (q.push(next_in))
+            next_in++;
+        TEST_ASSERT_EQUAL_UINT32(8, q.size());
+        for (int i = 0; i < 5; ++i)
+        {
+            TEST_ASSERT_TRUE(q.pop(v));
+            TEST_ASSERT_EQUAL_UINT32(next_out++, v);
+        }
+        TEST_ASSERT_EQUAL_UINT32(3, q.size());
+    }
+    while (q.pop(v))
+        TEST_ASSERT_EQUAL_UINT32(next_out++, v);
+    TEST_ASSERT_EQUAL_UINT32(next_in, next_out);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_for_each_visits_pending_in_order()
+{
+    AsyncTCPBoundedQueue<uint32_t, 8> q;
+    for (uint32_t i = 0; i < 6; ++i)
+        q.push(i);
+    uint32_t v;
+    q.pop(v);
+    q.pop(v);
+    std::vector<uint32_t> seen;
+    q.for_each([&](uint32_t x) { seen.push_back(x); });
+    TEST_ASSERT_EQUAL_UINT32(4, seen.size());
+    for (size_t i = 0; i < seen.size(); ++i)
+        TEST_ASSERT_EQUAL_UINT32(i + 2, seen[i]);
+}
+
+void test_mpsc_keeps_per_producer_order()
+{
+    AsyncTCPBoundedQueue<uint32_t, 64> q;
+    std::atomic<int> done(0);
+    std::atomic<bool> scan_ok(true);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p)
+        producers.emplace_back([&, p] {
+            for (uint32_t i = 1; i <= PER_PRODUCER;)
+            {
+                if (q.push(tag(p, i)))
+                    i++;
+                else
+                    std::this_thread::yield(); // 满：与 LwIP 回调一样直接返回，稍后重试
+            }
+            done++;
+        });
+    // 并发扫描（_remove_events_for_client 的用法）：只能看到已发布、未出队的条目
+    std::thread scanner([&] {
+        while (done < PRODUCERS)
+        {
+            size_t n = 0;
+            q.for_each([&](uint32_t x) {
+                n++;
+                if ((x >> 24) >= PRODUCERS || (x & 0xffffff) == 0)
+                    scan_ok = false;
+            });
+            if (n > q.capacity())
+                scan_ok = false;
+            std::this_thread::yield();
+        }
+    });
+
+    uint32_t last[PRODUCERS] = {};
+    uint64_t got = 0;
+    bool order_ok = true;
+    uint32_t v;
+    while (done < PRODUCERS || !q.empty())
+    {
+        if (!q.pop(v))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const int p = v >> 24;
+        const uint32_t n = v & 0xffffff;
+        if (p >= PRODUCERS || n != last[p] + 1)
+            order_ok = false;
+        else
+            last[p] = n;
+        got++;
+    }
+    for (std::thread &t : producers)
+        t.join();
+    scanner.join();
+
+    TEST_ASSERT_TRUE(order_ok);
+    TEST_ASSERT_TRUE(scan_ok.load());
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * PER_PRODUCER, static_cast<uint32_t>(got));
+    for (uint32_t n : last)
+        TEST_ASSERT_EQUAL_UINT32(PER_PRODUCER, n);
+}
+
+// 与 AsyncTCP 相同的结构：固定包池经空闲队列借出，填好后进事件环，消费者处理完归还；
+// 客户端关闭时扫描事件环，按 (代数 << 8) | 状态 的标签用 CAS 取消，包被回收复用后旧标签的 CAS 必然失败
+void test_packet_pool_round_trip()
+{
+    constexpr size_t RING = 32;
+    constexpr uint32_t QUEUED = 1;
+    constexpr uint32_t CANCELLED = 2;
+    struct packet
+    {
+        std::atomic<uint32_t> tag;
+        std::atomic<int> owner;
+    };
+    static packet pool[RING * 2];
+    AsyncTCPBoundedQueue<packet *, RING * 2> free_list;
+    AsyncTCPBoundedQueue<packet *, RING> ring;
+    for (packet &p : pool)
+    {
+        p.tag = 0;
+        TEST_ASSERT_TRUE(free_list.push(&p));
+    }
+
+    std::atomic<int> done(0);
+    std::vector<std::thread> producers;
+    for (int id = 0; id < PRODUCERS; ++id)
+        producers.emplace_back([&, id] {
+            for (uint32_t i = 1; i <= PER_PRODUCER / 4; ++i)
+            {
+                packet *p;
+                while (!free_list.pop(p))
+                    std::this_thread::yield();
+                p->owner.store(id, std::memory_order_relaxed);
+                const uint32_t gen = (p->tag.load(std::memory_order_relaxed) >> 8) + 1;
+                p->tag.store((gen << 8) | QUEUED, std::memory_order_release);
+                while (!ring.push(p))
+                    std::this_thread::yield();
+            }
+            done++;
+        });
+    // 模拟 0 号客户端关闭：取消它排队中的包
+    std::atomic<uint32_t> flagged(0);
+    std::thread closer([&] {
+        while (done < PRODUCERS)
+        {
+            ring.for_each([&](packet *p) {
+                uint32_t t = p->tag.load(std::memory_order_acquire);
+                if ((t & 0xff) == QUEUED && p->owner.load(std::memory_order_relaxed) == 0 &&
+                    p->tag.compare_exchange_strong(t, (t & ~0xffu) | CANCELLED, std::memory_order_acq_rel))
+                    flagged++;
+            });
+            std::this_thread::yield();
+        }
+    });
+
+    uint64_t handled = 0, cancelled = 0;
+    bool ok = true;
+    packet *p;
+    while (done < PRODUCERS || !ring.empty())
+    {
+        if (!ring.pop(p))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (p < pool || p >= pool + RING * 2)
+            ok = false;
+        // 取消只落在 0 号的包上，即使扫描时该包已被回收复用
+        if ((p->tag.load(std::memory_order_acquire) & 0xff) == CANCELLED)
+        {
+            cancelled++;
+            if (p->owner.load(std::memory_order_relaxed) != 0)
+                ok = false;
+        }
+        else
+        {
+            handled++;
+        }
+        if (!free_list.push(p))
+            ok = false; // 池容量等于空闲队列容量，归还永远不会失败
+    }
+    for (std::thread &t : producers)
+        t.join();
+    closer.join();
+
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_UINT32(PRODUCERS * (PER_PRODUCER / 4), static_cast<uint32_t>(handled + cancelled));
+    TEST_ASSERT_EQUAL_UINT32(flagged.load(), static_cast<uint32_t>(cancelled));
+    // 所有包都回到空闲队列，且各出现一次
+    std::vector<bool> back(RING * 2, false);
+    size_t count = 0;
+    while (free_list.pop(p))
+    {
+        const size_t idx = static_cast<size_t>(p - pool);
+        TEST_ASSERT_FALSE(back[idx]);
+        back[idx] = true;
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(RING * 2, count);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_and_bounds);
+    RUN_TEST(test_for_each_visits_pending_in_order);
+    RUN_TEST(test_mpsc_keeps_per_producer_order);
+    RUN_TEST(test_packet_pool_round_trip);
+    return UNITY_END();
+}
@@ -0,0 +1,308 @@
+// 曲线二进制编码：用照搬 data/js/services/telem_codec.js 的解码器逐帧解回，检查往返误差、
+// zig-zag、Q_MAX 封顶、无效值沿用上一帧、丢帧后等关键帧重新同步，并打印合成波形下的每帧字节数
+#include <unity.h>
+#include <vector>
+#include "my_net_lib/my_telem_codec.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    // ---- decodeFrame 的 C++ 版本，结构与 JS 一一对应 ----
+    struct js_ref
+    {
+        bool valid;
+        uint8_t seq;
+        std::vector<uint8_t> split;
+        std::vector<uint8_t> fields;
+        std::vector<double> q;
+    };
+    js_ref ref = {};
+
+    // readVarint：同样用乘法累加，不依赖 32 位位运算
+    bool read_varint(const uint8_t *bytes, size_t len, size_t &at, double &out)
+    {
+        double z = 0;
+        double scale = 1;
+        for (;;)
+        {
+            if (at >= len)
+                return false; // truncated frame
+            const uint8_t b = bytes[at++];
+            z += (b & 0x7f) * scale;
+            if (b < 0x80)
+                break;
+            scale *= 128;
+        }
+        out = fmod(z, 2) ? -(z + 1) / 2 : z / 2;
+        return true;
+    }
+
+    // 返回 false 对应 JS 返回 null
+    bool decode_frame(const uint8_t *bytes, size_t len, std::vector<std::vector<double>> &rows)
+    {
+        rows.clear();
+        if (len < TELEM_FRAME_HEAD)
+            return false;
+        const uint8_t type = bytes[0];
+        const uint8_t seq = bytes[1];
+        const uint8_t n = bytes[2];
+        const uint8_t k = bytes[3];
+        size_t at = TELEM_FRAME_HEAD;
+        if (type == TELEM_FRAME_KEY)
+        {
+            ref.split.assign(bytes + at, bytes + at + TELEM_PLOT_CHARTS);
+            at += TELEM_PLOT_CHARTS;
+            ref.fields.assign(bytes + at, bytes + at + n);
+            at += n;
+            ref.q.assign(n, 0);
+            ref.seq = seq;
+            ref.valid = true;
+        }
+        else if (type == TELEM_FRAME_DELTA)
+        {
+            if (!ref.valid || seq != static_cast<uint8_t>(ref.seq + 1) || n != ref.q.size())
+            {
+                ref.valid = false;
+                return false;
+            }
+            ref.seq = seq;
+        }
+        else
+        {
+            return false;
+        }
+        for (uint8_t j = 0; j < k; ++j)
+        {
+            std::vector<double> row(n);
+            for (uint8_t i = 0; i < n; ++i)
+            {
+                double d;
+                if (!read_varint(bytes, len, at, d))
+                {
+                    ref.valid = false;
+                    return false;
+                }
+                ref.q[i] += d;
+                row[i] = ref.q[i] * TELEM_FIELDS[ref.fields[i]].res;
+            }
+            rows.push_back(row);
+        }
+        return true;
+    }
+
+    telem_codec enc = {};
+    uint8_t frame[TELEM_FRAME_MAX];
+    float rows[TELEM_BATCH_MAX][TELEM_PLOT_MAX];
+    std::vector<std::vector<double>> out;
+
+    telem_plot plot(uint8_t n)
+    {
+        telem_plot p = {};
+        p.n = n;
+        p.split[0] = n;
+        for (uint8_t i = 0; i < n; ++i)
+            p.field[i] = i; // 前几个字段的 res 为 0.01 / 0.001
+        return p;
+    }
+
+    size_t encode(const telem_plot &p, uint8_t k)
+    {
+        return telem_codec_encode(enc, p, rows, k, 2, frame);
+    }
+
+    void assert_rows_match(const telem_plot &p, uint8_t k)
+    {
+        TEST_ASSERT_EQUAL_UINT32(k, out.size());
+        for (uint8_t j = 0; j < k; ++j)
+            for (uint8_t i = 0; i < p.n; ++i)
+            {
+                const float res = TELEM_FIELDS[p.field[i]].res;
+                TEST_ASSERT_FLOAT_WITHIN(res * 0.51f, rows[j][i], static_cast<float>(out[j][i]));
+            }
+    }
+}
+
+void setUp()
+{
+    enc = {};
+    ref = {};
+    memset(rows, 0, sizeof(rows));
+}
+
+void tearDown() {}
+
+// 固定字节：字段 0（ang.now，res 0.01）与字段 2（ang.err，res 0.01），两个样本
+void test_fixed_key_frame_bytes()
+{
+    telem_plot p = {};
+    p.n = 2;
+    p.split[0] = 2;
+    p.field[0] = 0;
+    p.field[1] = 2;
+    rows[0][0] = 0.05f;
+    rows[0][1] = -0.03f;
+    rows[1][0] = 0.04f;
+    rows[1][1] = -0.03f;
+    const size_t len = encode(p, 2);
+    // 5 -> zz 10，-3 -> zz 5，-1 -> zz 1，0 -> 0
+    const uint8_t expect[] = {TELEM_FRAME_KEY, 0, 2, 2, 2, 2, 0, 0, 0, 2, 0x0A, 0x05, 0x01, 0x00};
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expect), len);
+    TEST_ASSERT_EQUAL_MEMORY(expect, frame, sizeof(expect));
+
+    TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+    assert_rows_match(p, 2);
+}
+
+void test_negative_deltas_zigzag()
+{
+    const telem_plot p = plot(1);
+    // 相对前一个样本的差：-1、-64（zz 127 一字节）、-65（zz 129 两字节）、-1000000
+    const float v[] = {0.0f, -0.01f, -0.65f, -1.30f, -10001.30f};
+    for (uint8_t j = 0; j < 5; ++j)
+        rows[j][0] = v[j];
+    const size_t len = encode(p, 5);
+    const uint8_t *s = frame + TELEM_FRAME_HEAD + TELEM_PLOT_CHARTS + 1;
+    TEST_ASSERT_EQUAL_UINT8(0x00, s[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, s[1]);
+    TEST_ASSERT_EQUAL_UINT8(0x7F, s[2]);
+    TEST_ASSERT_EQUAL_UINT8(0x81, s[3]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, s[4]);
+    TEST_ASSERT_EQUAL_UINT32(s + 5 + 3 - frame, len); // 最后一个差值 zz 1999999 占 3 字节
+
+    TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+    TEST_ASSERT_FLOAT_WITHIN(0.005, -0.65, out[2][0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, -10001.30, out[4][0]);
+}
+
+void test_clamp_at_q_max()
+{
+    const telem_plot p = plot(1);
+    rows[0][0] = 1e12f;
+    rows[1][0] = -1e12f; // 差值 -2 * Q_MAX 仍在 int32 内
+    rows[2][0] = 1e12f;
+    const size_t len = encode(p, 3);
+    TEST_ASSERT_EQUAL_INT32(Q_MAX, enc.q[0]);
+    TEST_ASSERT_TRUE(len <= TELEM_FRAME_MAX);
+    TEST_ASSERT_EQUAL_UINT32(TELEM_FRAME_HEAD + TELEM_PLOT_CHARTS + 1 + 5 + 5 + 5, len);
+
+    TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+    const double top = Q_MAX * static_cast<double>(TELEM_FIELDS[0].res);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, top, out[0][0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, -top, out[1][0]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, top, out[2][0]);
+}
+
+void test_non_finite_reuses_previous_q()
+{
+    const telem_plot p = plot(2);
+    rows[0][0] = 1.23f;
+    rows[0][1] = 0.5f;
+    rows[1][0] = NAN;
+    rows[1][1] = INFINITY;
+    rows[2][0] = 1.24f;
+    rows[2][1] = -INFINITY;
+    const size_t len = encode(p, 3);
+    const uint8_t *s = frame + TELEM_FRAME_HEAD + TELEM_PLOT_CHARTS + 2;
+    // 第一个样本两个值各 2 字节（zz 246、zz 1000），之后无效值的差值为 0
+    TEST_ASSERT_EQUAL_UINT8(0x00, s[4]);
+    TEST_ASSERT_EQUAL_UINT8(0x00, s[5]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, s[6]); // 1.23 -> 1.24
+    TEST_ASSERT_EQUAL_UINT8(0x00, s[7]);
+    TEST_ASSERT_EQUAL_UINT32(s + 8 - frame, len);
+
+    TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 1.23, out[1][0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, 0.5, out[1][1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 1.24, out[2][0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.0005, 0.5, out[2][1]);
+}
+
+void test_seq_gap_waits_for_key_frame()
+{
+    const telem_plot p = plot(3);
+    uint8_t lost_frame = 0;
+    int nulls = 0;
+    int resync = 0;
+    for (int f = 0; f < TELEM_KEY_FRAMES * 2; ++f)
+    {
+        for (uint8_t i = 0; i < p.n; ++i)
+            rows[0][i] = f * 0.1f + i;
+        const size_t len = encode(p, 1);
+        if (f == 3)
+        {
+            lost_frame = frame[1]; // 这一帧在链路上丢了
+            continue;
+        }
+        if (!decode_frame(frame, len, out))
+        {
+            TEST_ASSERT_EQUAL_UINT8(TELEM_FRAME_DELTA, frame[0]);
+            nulls++;
+            continue;
+        }
+        assert_rows_match(p, 1);
+        if (f > 3)
+        {
+            TEST_ASSERT_EQUAL_UINT8(TELEM_FRAME_KEY, frame[0]);
+            resync = f;
+            break;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8(3, lost_frame);
+    // 丢帧后的差分帧都被丢弃，直到下一个周期关键帧
+    TEST_ASSERT_EQUAL_INT(TELEM_KEY_FRAMES, resync);
+    TEST_ASSERT_EQUAL_INT(TELEM_KEY_FRAMES - 4, nulls);
+
+    // 发送端已知丢帧时作废状态，下一帧立即是关键帧
+    ref = {};
+    enc.valid = false;
+    rows[0][0] = 42.0f;
+    const size_t len = encode(p, 1);
+    TEST_ASSERT_EQUAL_UINT8(TELEM_FRAME_KEY, frame[0]);
+    TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+    assert_rows_match(p, 1);
+}
+
+void test_round_trip_and_bytes_per_frame()
+{
+    // 默认图表的 9 条曲线：慢变正弦 + 小噪声，每帧 8 个样本（500 Hz 控制、16 ms 推送）
+    const telem_plot p = plot(9);
+    const uint8_t k = 8;
+    const int frames = 300;
+    uint32_t bytes = 0, keys = 0;
+    uint32_t noise = 12345;
+    for (int f = 0; f < frames; ++f)
+    {
+        for (uint8_t j = 0; j < k; ++j)
+        {
+            const float t = (f * k + j) * 0.002f;
+            for (uint8_t i = 0; i < p.n; ++i)
+            {
+                noise = noise * 1103515245u + 12345u;
+                rows[j][i] = (i + 1) * sinf(t * (i + 1)) + ((noise >> 16) % 100) * 0.0005f;
+            }
+        }
+        const size_t len = encode(p, k);
+        keys += frame[0] == TELEM_FRAME_KEY;
+        bytes += len;
+        TEST_ASSERT_TRUE(decode_frame(frame, len, out));
+        assert_rows_match(p, k);
+    }
+    const uint32_t raw = frames * (TELEM_FRAME_HEAD + k * p.n * sizeof(float));
+    TEST_ASSERT_EQUAL_UINT32(frames / TELEM_KEY_FRAMES, keys);
+    TEST_ASSERT_TRUE(bytes * 2 < raw); // 至少比 f32 直发省一半
+    printf("telem codec: %.1f bytes/frame (%u curves x %u samples), f32 would be %.1f\n",
+           static_cast<double>(bytes) / frames, p.n, k, static_cast<double>(raw) / frames);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_key_frame_bytes);
+    RUN_TEST(test_negative_deltas_zigzag);
+    RUN_TEST(test_clamp_at_q_max);
+    RUN_TEST(test_non_finite_reuses_previous_q);
+    RUN_TEST(test_seq_gap_waits_for_key_frame);
+    RUN_TEST(test_round_trip_and_bytes_per_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+// 控制环样本环：每个样本的值即其序号，循环 push/take 检查游标落后/超前、写指针回绕、
+// 按字节预算加大抽样间隔、单帧不超过 TELEM_BATCH_MAX，以及复制期间被覆盖的样本被丢弃
+#include <unity.h>
+#include "my_net_lib/my_telem_ring.cpp"
+
+robot_state robot = {};
+
+namespace
+{
+    uint32_t next = 0; // 下一个样本的序号
+    telem_batch batch = {};
+    telem_plot plot = {};
+    float rows[TELEM_BATCH_MAX][TELEM_PLOT_MAX];
+    uint8_t step_ms = 0;
+
+    // 样本值只保留低 20 位，保证 float 精确
+    float value_of(uint32_t idx)
+    {
+        return static_cast<float>(idx & 0xFFFFF);
+    }
+
+    void start_at(uint32_t h)
+    {
+        head = h;
+        next = h;
+        batch = {};
+        batch.cursor = h;
+    }
+
+    void push(uint32_t n)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            robot.ang.now = value_of(next);
+            robot.ang.duty = -value_of(next);
+            next++;
+            telem_ring_push();
+        }
+    }
+
+    uint8_t take()
+    {
+        return telem_ring_take(batch, plot, rows, step_ms);
+    }
+
+    // rows 从 first 起按 stride 连续，两列一致
+    void assert_rows(uint32_t first, uint32_t stride, uint8_t k)
+    {
+        for (uint8_t j = 0; j < k; ++j)
+        {
+            TEST_ASSERT_EQUAL_FLOAT(value_of(first + j * stride), rows[j][0]);
+            TEST_ASSERT_EQUAL_FLOAT(-rows[j][0], rows[j][1]);
+        }
+    }
+}
+
+void setUp()
+{
+    robot = {};
+    robot.dt_ms = 2;
+    plot = {};
+    plot.n = 2;
+    plot.split[0] = 2;
+    plot.field[0] = 0; // ang.now
+    plot.field[1] = 1; // ang.duty
+    telem_ring_enable(true);
+    start_at(0);
+}
+
+void tearDown() {}
+
+void test_takes_new_samples_in_order()
+{
+    TEST_ASSERT_EQUAL_UINT8(0, take()); // 没有新样本
+    push(10);
+    TEST_ASSERT_EQUAL_UINT8(10, take());
+    assert_rows(0, 1, 10);
+    TEST_ASSERT_EQUAL_UINT32(10, batch.cursor);
+    TEST_ASSERT_EQUAL_UINT8(1, batch.stride);
+    TEST_ASSERT_EQUAL_UINT8(2, step_ms);
+    TEST_ASSERT_EQUAL_UINT8(0, take());
+
+    telem_ring_enable(false); // 关闭采样后 push 不写入
+    push(5);
+    TEST_ASSERT_EQUAL_UINT8(0, take());
+}
+
+void test_cursor_far_behind_starts_at_oldest()
+{
+    push(1000);
+    const uint8_t k = take();
+    // 只剩最近一环（下一个写入位置除外）；一帧装不下 127 个，按 4 抽 1
+    TEST_ASSERT_EQUAL_UINT8(4, batch.stride);
+    TEST_ASSERT_EQUAL_UINT8(TELEM_BATCH_MAX, k);
+    assert_rows(1000 - TELEM_RING_SAMPLES + 1, 4, k);
+    TEST_ASSERT_EQUAL_UINT32(1001, batch.cursor); // 按 stride 取过了写指针，下一帧从 1001 开始
+    TEST_ASSERT_EQUAL_UINT8(8, step_ms);
+}
+
+void test_cursor_across_head_wrap()
+{
+    start_at(0xFFFFFFF0u);
+    push(8);
+    TEST_ASSERT_EQUAL_UINT8(8, take());
+    push(24); // 写指针回绕到 0x10
+    TEST_ASSERT_EQUAL_UINT32(0x10, head);
+    TEST_ASSERT_EQUAL_UINT8(24, take());
+    assert_rows(0xFFFFFFF8u, 1, 24);
+    TEST_ASSERT_EQUAL_UINT32(0x10, batch.cursor);
+
+    // 回绕前留下、落后一整环以上的游标：跨过回绕点照样按落后处理，从最旧的样本开始
+    push(TELEM_RING_SAMPLES);
+    batch.cursor = 0xFFFFFF00u;
+    TEST_ASSERT_TRUE(take() > 0);
+    assert_rows(head - TELEM_RING_SAMPLES + 1, batch.stride, 1);
+
+    // 超前写指针一整环以上的旧游标：重置到写指针，从下一个样本开始取
+    const uint32_t h = head;
+    batch.cursor = h + 1000;
+    TEST_ASSERT_EQUAL_UINT8(0, take());
+    TEST_ASSERT_EQUAL_UINT32(h, batch.cursor);
+    push(3);
+    TEST_ASSERT_EQUAL_UINT8(3, take());
+    assert_rows(h, 1, 3);
+
+    // 只超前不足一环（上一帧按 stride 取到了写指针之后）：保持游标，等写指针追上
+    batch.cursor = head + 5;
+    TEST_ASSERT_EQUAL_UINT8(0, take());
+    TEST_ASSERT_EQUAL_UINT32(head + 5, batch.cursor);
+    push(6);
+    TEST_ASSERT_EQUAL_UINT8(1, take());
+    assert_rows(head - 1, 1, 1);
+}
+
+void test_stride_grows_under_budget()
+{
+    // 每样本字节数越大，抽样间隔越大，估算的字节率不超过预算
+    uint8_t last_stride = 1;
+    for (uint32_t per_sample = 2; per_sample <= 256; per_sample *= 2)
+    {
+        batch.est_x16 = per_sample * 16;
+        push(TELEM_RING_SAMPLES);
+        const uint8_t k = take();
+        TEST_ASSERT_TRUE(k > 0);
+        TEST_ASSERT_TRUE(batch.stride >= last_stride);
+        const uint32_t rate = 1000 / (batch.stride * robot.dt_ms) * per_sample;
+        TEST_ASSERT_TRUE(rate <= TELEM_STREAM_BUDGET);
+        TEST_ASSERT_EQUAL_UINT8(batch.stride * robot.dt_ms, step_ms);
+        last_stride = batch.stride;
+    }
+    TEST_ASSERT_EQUAL_UINT8(16, last_stride); // 256 B/样本 x 500 Hz / 8000 B/s
+
+    // 记账：一帧 k 个样本编码成 frame_len 字节，估计值逐步逼近
+    batch.est_x16 = 0;
+    telem_batch_account(batch, 320, 10);
+    TEST_ASSERT_EQUAL_UINT16(32 * 16, batch.est_x16);
+    telem_batch_account(batch, 0, 0); // 空帧不计
+    TEST_ASSERT_EQUAL_UINT16(32 * 16, batch.est_x16);
+    push(TELEM_BATCH_MAX * 2);
+    take();
+    TEST_ASSERT_EQUAL_UINT8(2, batch.stride); // 32 B x 500 Hz = 16000 B/s，需 2 抽 1
+}
+
+void test_batch_never_exceeds_max()
+{
+    uint32_t seed = 1;
+    uint32_t expect = 0; // 下一个应取到的序号（未被抽样跳过、未落后于环时）
+    for (int round = 0; round < 2000; ++round)
+    {
+        seed = seed * 1103515245u + 12345u;
+        push((seed >> 16) % 300);
+        const uint32_t before = batch.cursor;
+        const uint8_t k = take();
+        TEST_ASSERT_TRUE(k <= TELEM_BATCH_MAX);
+        if (k == 0)
+            continue;
+        // 第一个样本：没落后一环时接着上一帧取，否则从最旧的样本开始
+        const uint32_t first = next - before >= TELEM_RING_SAMPLES ? next - TELEM_RING_SAMPLES + 1 : expect;
+        assert_rows(first, batch.stride, k);
+        // 按 stride 取到最新样本之后，游标最多超前写指针 stride - 1
+        TEST_ASSERT_TRUE(static_cast<int32_t>(batch.cursor - next) < batch.stride);
+        expect = batch.cursor;
+    }
+}
+
+void test_rows_overwritten_during_copy_are_dropped()
+{
+    // 从 100 起按 2 抽取 10 个；复制期间写指针推进到 100 + 环长 + 3，最旧的 2 个已被覆盖
+    for (uint8_t j = 0; j < 10; ++j)
+    {
+        rows[j][0] = value_of(100 + j * 2);
+        rows[j][1] = -rows[j][0];
+    }
+    TEST_ASSERT_EQUAL_UINT8(8, drop_overwritten(100 + TELEM_RING_SAMPLES + 3, 100, 2, rows, 10));
+    assert_rows(104, 2, 8);
+
+    // 没有被覆盖：原样保留
+    TEST_ASSERT_EQUAL_UINT8(8, drop_overwritten(104 + TELEM_RING_SAMPLES - 1, 104, 2, rows, 8));
+    assert_rows(104, 2, 8);
+
+    // 写指针已经超出整批：全部丢弃
+    TEST_ASSERT_EQUAL_UINT8(0, drop_overwritten(200 + TELEM_RING_SAMPLES, 104, 2, rows, 8));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_takes_new_samples_in_order);
+    RUN_TEST(test_cursor_far_behind_starts_at_oldest);
+    RUN_TEST(test_cursor_across_head_wrap);
+    RUN_TEST(test_stride_grows_under_budget);
+    RUN_TEST(test_batch_never_exceeds_max);
+    RUN_TEST(test_rows_overwritten_during_copy_are_dropped);
+    return UNITY_END();
+}
@@ -0,0 +1,158 @@
+"""网页静态资源预处理（PlatformIO pre 脚本，也可单独运行）
+
+data/ 下的每个文件：
+  - gzip 压缩（固定 mtime，保证可复现）
+  - 以字节数组写入 src/my_net_lib/my_assets_data.cpp，链接进固件，直接从映射的 Flash 发送
+  - 生成 src/my_net_lib/my_assets_manifest.h：url -> (数据, MIME, ETag, 长度)
+固件据此做 ETag/304 校验，运行时不访问文件系统。
+
+LittleFS 只用于覆盖：data_override/ 下的文件（可选，不入库）原样打包进
+.pio/assets/fs，启动时检测一次，同路径的请求优先走 LittleFS，便于调试前端而不必重新烧录固件。
+
+单独运行：python tools/build_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import shutil
+
+try:
+    Import("env")  # noqa: F821  PlatformIO 注入（SCons 下没有 __file__）
+    ROOT = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    env = None
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+SRC_DIR = os.path.join(ROOT, "data")
+OVERRIDE_DIR = os.path.join(ROOT, "data_override")
+OUT_DIR = os.path.join(ROOT, ".pio", "assets", "fs")
+MANIFEST = os.path.join(ROOT, "src", "my_net_lib", "my_assets_manifest.h")
+BLOBS = os.path.join(ROOT, "src", "my_net_lib", "my_assets_data.cpp")
+
+SKIP = {".DS_Store", "README.md"}
+
+MIME = {
+    ".html": "text/html; charset=utf-8",
+    ".htm": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "application/javascript; charset=utf-8",
+    ".json": "application/json; charset=utf-8",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".gif": "image/gif",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".txt": "text/plain; charset=utf-8",
+}
+
+
+def mime_of(path):
+    return MIME.get(os.path.splitext(path)[1].lower(), "application/octet-stream")
+
+
+def collect(src_dir):
+    """返回 [(url, 原始内容)]，按 url 排序，固件侧用二分查找"""
+    items = []
+    for base, dirs, files in os.walk(src_dir):
+        dirs.sort()
+        for name in sorted(files):
+            if name in SKIP:
+                continue
+            full = os.path.join(base, name)
+            url = "/" + os.path.relpath(full, src_dir).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                items.append((url, f.read()))
+    items.sort(key=lambda it: it[0].encode())
+    return items
+
+
+def build(src_dir=SRC_DIR, override_dir=OVERRIDE_DIR, out_dir=OUT_DIR, manifest=MANIFEST, blobs=BLOBS):
+    assets = []
+    for i, (url, raw) in enumerate(collect(src_dir)):
+        digest = hashlib.sha256(raw).hexdigest()[:16]
+        assets.append({
+            "url": url,
+            "sym": "asset_%d" % i,
+            "mime": mime_of(url),
+            "etag": '"%s"' % digest,
+            "raw": raw,
+            "gz": gzip.compress(raw, compresslevel=9, mtime=0),
+        })
+
+    # 文件系统镜像只含覆盖文件
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    if os.path.isdir(override_dir):
+        shutil.copytree(override_dir, out_dir)
+    else:
+        os.makedirs(out_dir)
+
+    write_if_changed(manifest, render_manifest(assets))
+    write_if_changed(blobs, render_blobs(assets))
+    return assets
+
+
+def c_str(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def render_manifest(assets):
+    lines = [
+        "// 由 tools/build_assets.py 生成，请勿手动修改",
+        "#pragma once",
+        '#include "my_net_config.h"',
+        "",
+    ]
+    for a in assets:
+        lines.append("extern const uint8_t %s[];" % a["sym"])
+    lines += [
+        "",
+        "static constexpr asset_entry ASSETS[] = {",
+    ]
+    for a in assets:
+        lines.append("    {%s, %s, %s, %s, %d}," % (
+            c_str(a["url"]), a["sym"], c_str(a["mime"]), c_str(a["etag"]), len(a["gz"])))
+    lines += [
+        "};",
+        "static constexpr size_t ASSET_COUNT = sizeof(ASSETS) / sizeof(ASSETS[0]);",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def render_blobs(assets):
+    lines = [
+        "// 由 tools/build_assets.py 生成，请勿手动修改",
+        "#include <Arduino.h>",
+        "",
+    ]
+    for a in assets:
+        lines.append("// %s" % a["url"])
+        lines.append("extern const uint8_t %s[] PROGMEM = {" % a["sym"])
+        data = a["gz"]
+        for off in range(0, len(data), 20):
+            lines.append("    " + ",".join("0x%02x" % b for b in data[off:off + 20]) + ",")
+        lines.append("};")
+        lines.append("")
+    return "\n".join(lines)
+
+
+def write_if_changed(path, text):
+    # 内容不变时不改写，避免触发整项目重新编译
+    if os.path.exists(path):
+        with open(path, "r", encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def report(assets):
+    raw = sum(len(a["raw"]) for a in assets)
+    gz = sum(len(a["gz"]) for a in assets)
+    print("[assets] %d files, %d -> %d bytes (gzip)" % (len(assets), raw, gz))
+
+
+report(build())
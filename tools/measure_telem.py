@@ -0,0 +1,50 @@
+"""测量曲线二进制流的编码效果（字节/帧、样本/帧、压缩比、关键帧占比、编码耗时）
+
+用法：python tools/measure_telem.py <设备IP> [秒数]
+读取 /api/diag 中固件自己统计的 codec 计数，取两次之差。测量期间需有网页打开并开启图表，
+数据来自真实运行中的会话，曲线选择与刷新率以网页当前设置为准。
+"""
+
+import http.client
+import json
+import sys
+import time
+
+
+def codec(host):
+    conn = http.client.HTTPConnection(host, 80, timeout=10)
+    conn.request("GET", "/api/diag")
+    res = conn.getresponse()
+    body = res.read()
+    conn.close()
+    return json.loads(body)["codec"]
+
+
+def run(host, seconds):
+    a = codec(host)
+    t0 = time.perf_counter()
+    time.sleep(seconds)
+    b = codec(host)
+    dt = time.perf_counter() - t0
+
+    frames = b["frames"] - a["frames"]
+    if frames <= 0:
+        print("no frames encoded (is a page open with charts on?)")
+        return
+    keys = b["keys"] - a["keys"]
+    samples = b["samples"] - a["samples"]
+    nbytes = b["bytes"] - a["bytes"]
+    raw = b["raw"] - a["raw"]
+    print("frames     %8d  (%.1f /s)" % (frames, frames / dt))
+    print("keyframes  %8d  (%.1f %%)" % (keys, keys * 100.0 / frames))
+    print("samples    %8.2f /frame  (%.0f /s)" % (samples / frames, samples / dt))
+    print("bytes      %8.2f /frame  (%.0f B/s)" % (nbytes / frames, nbytes / dt))
+    print("f32 equiv  %8.2f /frame  (ratio %.2f)" % (raw / frames, raw / nbytes if nbytes else 0))
+    print("encode     %8.2f us avg, %.2f us max (since boot)" % (b["enc_avg_us"], b["enc_max_us"]))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    run(sys.argv[1], float(sys.argv[2]) if len(sys.argv) > 2 else 10)
@@ -0,0 +1,64 @@
+"""测量网页资源加载时间（首字节时间 / 总时间），用于对比静态资源方案改动前后
+
+用法：python tools/measure_web.py <设备IP> [轮数]
+冷加载：不带缓存校验头；热加载：带上一次返回的 ETag（期望 304）。
+"""
+
+import http.client
+import os
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC_DIR = os.path.join(ROOT, "data")
+SKIP = {".DS_Store", "README.md"}
+
+
+def urls():
+    out = ["/"]
+    for base, dirs, files in os.walk(SRC_DIR):
+        dirs.sort()
+        for name in sorted(files):
+            if name not in SKIP:
+                out.append("/" + os.path.relpath(os.path.join(base, name), SRC_DIR).replace(os.sep, "/"))
+    return out
+
+
+def fetch(host, url, etag=None):
+    conn = http.client.HTTPConnection(host, 80, timeout=10)
+    headers = {"Accept-Encoding": "gzip"}
+    if etag:
+        headers["If-None-Match"] = etag
+    t0 = time.perf_counter()
+    conn.request("GET", url, headers=headers)
+    res = conn.getresponse()
+    ttfb = time.perf_counter() - t0
+    body = res.read()
+    total = time.perf_counter() - t0
+    conn.close()
+    return res.status, res.getheader("ETag"), len(body), ttfb, total
+
+
+def run(host, rounds):
+    etags = {}
+    for label in ("cold", "warm"):
+        sum_ttfb = sum_total = 0.0
+        sum_bytes = 0
+        for _ in range(rounds):
+            for url in urls():
+                status, etag, n, ttfb, total = fetch(host, url, etags.get(url) if label == "warm" else None)
+                if etag:
+                    etags[url] = etag
+                sum_ttfb += ttfb
+                sum_total += total
+                sum_bytes += n
+                print("%-5s %3d %-28s ttfb %6.1f ms  total %7.1f ms  %7d B" % (label, status, url, ttfb * 1e3, total * 1e3, n))
+        print("== %s: ttfb %.1f ms, total %.1f ms, %d B per page load\n" % (
+            label, sum_ttfb * 1e3 / rounds, sum_total * 1e3 / rounds, sum_bytes // rounds))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    run(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else 1)
@@ -0,0 +1,160 @@
+"""tools/build_assets.py 的测试：在临时目录里搭一个 data/ 树，把脚本拷进去单独运行，
+检查生成的清单、gzip/ETag、C 符号，以及重复运行结果不变
+
+运行：python3 -m unittest tools/test_build_assets.py
+（不放在 test/ 下：那里的每个 test_* 目录都会被 PlatformIO 当作测试套件）
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+SCRIPT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "build_assets.py")
+
+FILES = {
+    "index.html": b"<!doctype html><title>t</title>\n",
+    "js/app.js": b"export const a = 1;\n" * 50,
+    "js/services/telem_codec.js": b"// codec\n",
+    "css/main.css": b"body{margin:0}\n",
+    "img/logo.png": bytes(range(256)),
+    "blob.bin": b"\x00\x01\x02",
+    "README.md": b"not shipped\n",
+    'quote"name.txt': b"escaped\n",
+}
+
+
+def parse_manifest(text):
+    """返回 [(url, sym, mime, etag, len)]"""
+    entry = re.compile(r'^\s*\{"((?:[^"\\]|\\.)*)", (\w+), "([^"]*)", "((?:[^"\\]|\\.)*)", (\d+)\},$')
+    out = []
+    for line in text.splitlines():
+        m = entry.match(line)
+        if m:
+            url = m.group(1).replace('\\"', '"').replace("\\\\", "\\")
+            etag = m.group(4).replace('\\"', '"')
+            out.append((url, m.group(2), m.group(3), etag, int(m.group(5))))
+    return out
+
+
+def parse_blobs(text):
+    """返回 {sym: bytes}"""
+    blobs = {}
+    sym = None
+    for line in text.splitlines():
+        m = re.match(r"^extern const uint8_t (\w+)\[\] PROGMEM = \{$", line)
+        if m:
+            sym = m.group(1)
+            blobs[sym] = bytearray()
+        elif line == "};":
+            sym = None
+        elif sym is not None:
+            blobs[sym] += bytes(int(b, 16) for b in line.strip().rstrip(",").split(",") if b)
+    return {k: bytes(v) for k, v in blobs.items()}
+
+
+class BuildAssetsTest(unittest.TestCase):
+    def setUp(self):
+        self.root = tempfile.mkdtemp(prefix="assets_")
+        os.makedirs(os.path.join(self.root, "tools"))
+        os.makedirs(os.path.join(self.root, "src", "my_net_lib"))
+        shutil.copy(SCRIPT, os.path.join(self.root, "tools", "build_assets.py"))
+        for rel, data in FILES.items():
+            path = os.path.join(self.root, "data", *rel.split("/"))
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            with open(path, "wb") as f:
+                f.write(data)
+        self.manifest = os.path.join(self.root, "src", "my_net_lib", "my_assets_manifest.h")
+        self.blobs = os.path.join(self.root, "src", "my_net_lib", "my_assets_data.cpp")
+
+    def tearDown(self):
+        shutil.rmtree(self.root)
+
+    def run_script(self):
+        out = subprocess.run([sys.executable, os.path.join(self.root, "tools", "build_assets.py")],
+                             check=True, capture_output=True, text=True)
+        return out.stdout
+
+    def read(self, path):
+        with open(path, "r", encoding="utf-8") as f:
+            return f.read()
+
+    def test_manifest_entries(self):
+        stdout = self.run_script()
+        shipped = {"/" + k: v for k, v in FILES.items() if k != "README.md"}
+        self.assertIn("[assets] %d files" % len(shipped), stdout)
+
+        entries = parse_manifest(self.read(self.manifest))
+        urls = [e[0] for e in entries]
+        self.assertEqual(sorted(shipped, key=str.encode), urls)  # 按字节序排列，固件二分查找
+        self.assertNotIn("/README.md", urls)
+
+        mimes = {e[0]: e[2] for e in entries}
+        self.assertEqual("text/html; charset=utf-8", mimes["/index.html"])
+        self.assertEqual("application/javascript; charset=utf-8", mimes["/js/app.js"])
+        self.assertEqual("image/png", mimes["/img/logo.png"])
+        self.assertEqual("application/octet-stream", mimes["/blob.bin"])
+        self.assertIn("static constexpr size_t ASSET_COUNT", self.read(self.manifest))
+
+    def test_gzip_and_etag(self):
+        self.run_script()
+        entries = parse_manifest(self.read(self.manifest))
+        blobs = parse_blobs(self.read(self.blobs))
+        for url, sym, _, etag, length in entries:
+            raw = FILES[url[1:]]
+            self.assertEqual('"%s"' % hashlib.sha256(raw).hexdigest()[:16], etag)
+            self.assertEqual(length, len(blobs[sym]))
+            self.assertEqual(raw, gzip.decompress(blobs[sym]))
+            self.assertEqual(b"\x00\x00\x00\x00", blobs[sym][4:8])  # mtime 固定为 0
+
+    def test_c_symbols(self):
+        self.run_script()
+        manifest = self.read(self.manifest)
+        entries = parse_manifest(manifest)
+        blobs = parse_blobs(self.read(self.blobs))
+        syms = [e[1] for e in entries]
+        self.assertEqual(["asset_%d" % i for i in range(len(entries))], syms)
+        self.assertEqual(set(syms), set(blobs))
+        for sym in syms:
+            self.assertIn("extern const uint8_t %s[];" % sym, manifest)
+        # 带引号的文件名要转义成合法的 C 字符串
+        self.assertIn(r'{"/quote\"name.txt", ', manifest)
+
+    def test_stable_across_runs(self):
+        self.run_script()
+        first = (self.read(self.manifest), self.read(self.blobs))
+        stamp = (os.stat(self.manifest).st_mtime_ns, os.stat(self.blobs).st_mtime_ns)
+        self.run_script()
+        self.assertEqual(first, (self.read(self.manifest), self.read(self.blobs)))
+        # 内容不变时不改写文件，避免触发重新编译
+        self.assertEqual(stamp, (os.stat(self.manifest).st_mtime_ns, os.stat(self.blobs).st_mtime_ns))
+
+        # 改一个文件：只有它的 ETag 和数据变化
+        with open(os.path.join(self.root, "data", "css", "main.css"), "wb") as f:
+            f.write(b"body{margin:1px}\n")
+        self.run_script()
+        before = {e[0]: e for e in parse_manifest(first[0])}
+        after = {e[0]: e for e in parse_manifest(self.read(self.manifest))}
+        changed = [url for url in after if after[url] != before[url]]
+        self.assertEqual(["/css/main.css"], changed)
+
+    def test_override_dir_becomes_fs_image(self):
+        fs = os.path.join(self.root, ".pio", "assets", "fs")
+        self.run_script()
+        self.assertEqual([], os.listdir(fs))  # 没有覆盖文件时镜像为空
+
+        os.makedirs(os.path.join(self.root, "data_override", "js"))
+        with open(os.path.join(self.root, "data_override", "js", "app.js"), "wb") as f:
+            f.write(b"// debug\n")
+        self.run_script()
+        with open(os.path.join(fs, "js", "app.js"), "rb") as f:
+            self.assertEqual(b"// debug\n", f.read())
+
+
+if __name__ == "__main__":
+    unittest.main()